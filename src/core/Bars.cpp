@@ -20,12 +20,20 @@
 #include "bars.h"
 #include "indicators.h"
 
+#include <numeric>
+
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
 //////////////////////////////////////////////////////////////////////
 
 extern SeriesCache* _cache;
 
+BarsHistory& BarsHistory::instance() {
+  // never destroyed, as bars can be released during the static destruction
+  static BarsHistory* history = new BarsHistory();
+  return *history;
+}
+
 const Series BarsImpl::TrueRange() const {
   return _cache->findAndAdd(MakeTrueRangeSeries(*this));
 }
@@ -316,6 +324,8 @@ class SynchronizerImpl : public Synchronizer {
     }
   }
 
+  const std::vector<int>& indexes() const override { return _syncVector; }
+
   // indicates whether a sync required modification
   // if not modified, then the 2 bars were the same in terms
   // of bar indexes and timestamps
@@ -323,73 +333,72 @@ class SynchronizerImpl : public Synchronizer {
 
   size_t size() const override { return _syncVector.size(); }
 
-  void insertData(size_t refIx, size_t syncedIx) {
-    assert(refIx < _syncVector.size());
-    assert(_syncVector[refIx] == -1);
-
-    //    COUT << "inserting: " << ( refIx + 1 ) << _T( " -> " ) << ( syncedIx +
-    //    1 )<< std::endl;
-
-    _syncVector[refIx] = syncedIx;
-  }
-
  public:
-  // synchronizes bars2 to bars1 (the base is bars1)
-  SynchronizerImpl(Bars ref, Bars synced)
-      : _syncVector(ref.size(), -1),
-        _refSymbol(ref.getSymbol()),
-        _ts(ref.timeSeries()),
+  /**
+   * Synchronizes the synced time stamps to the ref time stamps, in one merge
+   * pass over both: each ref bar is mapped to the synced bar with the same time
+   * stamp or, if there is none, to the last synced bar before it (or the first
+   * synced bar if there is none before it either)
+   *
+   * @param refSymbol  the symbol of the reference bars
+   * @param ts         the time series of the reference bars
+   * @param refSize    the number of reference bars
+   * @param synced     the time stamps of the bars being synchronized
+   * @param syncedSize the number of bars being synchronized
+   */
+  SynchronizerImpl(const std::string& refSymbol, TimeSeries ts, size_t refSize, const DateTime* synced, size_t syncedSize)
+      : _syncVector(refSize, -1),
+        _refSymbol(refSymbol),
+        _ts(ts),
         _modified(false) {
-    assert(synced.unsyncSize() > 0);
-    size_t lastSynced = 0;
+    assert(syncedSize > 0);
+    const DateTime* ref = _ts.data();
 
-    for (size_t indexSynced = 0, indexRef = 0; indexRef < ref.size();) {
-      std::string refDate = ref.time(indexRef).date().to_simple_string();
-      std::string syncedDate =
-          synced.time(indexSynced).date().to_simple_string();
+    if (refSize == syncedSize && std::equal(ref, ref + refSize, synced, [](const DateTime& a, const DateTime& b) { return a.ticks() == b.ticks(); })) {
+      // same calendar, each bar is synchronized to itself
+      std::iota(_syncVector.begin(), _syncVector.end(), 0);
+      return;
+    }
 
-      if (ref.time(indexRef) == synced.time(indexSynced)) {
-        // the 2 times are equal - insert the data
-        insertData(indexRef++, indexSynced);
-        // increment unsynced if not at the end already
+    const size_t lastIndex = syncedSize - 1;
+    size_t lastSynced = 0;
+    for (size_t indexSynced = 0, indexRef = 0; indexRef < refSize;) {
+      const __int64 refTicks = ref[indexRef].ticks();
+      const __int64 syncedTicks = synced[indexSynced].ticks();
+      if (refTicks == syncedTicks) {
+        _syncVector[indexRef++] = (int)indexSynced;
         lastSynced = indexSynced;
-        if (indexSynced < (synced.unsyncSize() - 1)) {
+        if (indexSynced < lastIndex) {
           indexSynced++;
         }
       }
-      else if (ref.time(indexRef) > synced.time(indexSynced)) {
-        // ref time > synced time
-
-        // only insert the index if it's the last synchronized bar - then we
-        // need to sync to it. otherwise, continue until the ref time is <
-        // synced time, then we use the last synced index
+      else if (refTicks > syncedTicks) {
+        // continue until the ref time is < synced time, then use the last
+        // synced index, unless this is the last synced bar
         lastSynced = indexSynced;
-        if (indexSynced < (synced.unsyncSize() - 1)) {
+        if (indexSynced < lastIndex) {
           indexSynced++;
         }
         else {
-          insertData(indexRef++, lastSynced);
+          _syncVector[indexRef++] = (int)lastSynced;
         }
         _modified = true;
       }
-      else if (ref.time(indexRef) < synced.time(indexSynced)) {
+      else {
         // if ref < synced, then we insert the last good synced index.
-        insertData(indexRef++, lastSynced);
+        _syncVector[indexRef++] = (int)lastSynced;
         _modified = true;
       }
     }
-
-      // the whole sync vector must be initialized
-      //    assert( std::find( _syncVector.begin(), _syncVector.end(), -1 ) ==
-      //    _syncVector.end() );
   }
 
   TimeSeries timeSeries() const override {
     return _ts;
   }
 
+  // series synchronized to bars with the same symbol are compatible
   bool operator==(const Synchronizer& synchronizer) const override {
-    return to_lower_case(synchronizer.refSymbol()) == to_lower_case(refSymbol());
+    return this == &synchronizer || _stricmp(synchronizer.refSymbol().c_str(), refSymbol().c_str()) == 0;
   }
 
   bool operator==(const Synchronizer* synchronizer) const override {
@@ -399,6 +408,43 @@ class SynchronizerImpl : public Synchronizer {
   const std::string& refSymbol() const override { return _refSymbol; }
 };
 
+// synchronizers are shared by all the bars synchronized to the same reference
+// bars, for example all the symbols of a run synchronized to an index
+SynchronizerCache* _synchronizerCache;
+
+class MakeSynchronizer : public CacheableBuilder<Synchronizer> {
+ private:
+  const BarsImpl& _ref;
+  const DateTime* _synced;
+  const size_t _syncedSize;
+  const Id _id;
+
+ public:
+  MakeSynchronizer(const BarsImpl& ref, const BarsImpl& synced, const DateTime* syncedTimes, size_t syncedSize)
+      : _ref(ref), _synced(syncedTimes), _syncedSize(syncedSize), _id(Id::make("sync", ref.getId(), synced.getId())) {}
+
+  std::shared_ptr<Cacheable<Synchronizer> > make() const override {
+    return std::make_shared<Cacheable<Synchronizer> >(
+        std::make_shared<SynchronizerImpl>(_ref.getSymbol(), _ref.timeSeries(), _ref.size(), _synced, _syncedSize), _id);
+  }
+
+  const Id& id() const override { return _id; }
+
+  // the ids hash all the bar values, so the same ids are always the same bars
+  bool isConsistent(const Cacheable<Synchronizer>& cacheable) const override { return true; }
+};
+
+Synchronizer::SynchronizerPtr BarsImpl::makeSynchronizer(Bars ref) const {
+  // synchronized reference bars have the time stamps of their own reference
+  // bars, which their id doesn't reflect
+  const BarsImpl* refBars = dynamic_cast<const BarsImpl*>(ref.getBarsAbstr());
+  if (refBars == 0 || refBars->isSynchronized() || _synchronizerCache == 0) {
+    return std::make_shared<SynchronizerImpl>(ref.getSymbol(), ref.timeSeries(), ref.size(), _timeSeries.data(), _timeSeries.size());
+  }
+  return _synchronizerCache->findAndAdd(MakeSynchronizer(*refBars, *this, _timeSeries.data(), _timeSeries.size()));
+}
+
 CORE_API Synchronizer::SynchronizerPtr Synchronizer::create(Bars ref, Bars syncd) {
-  return std::make_shared< SynchronizerImpl >(ref, syncd);
+  assert(!syncd.isSynchronized());
+  return std::make_shared<SynchronizerImpl>(ref.getSymbol(), ref.timeSeries(), ref.size(), syncd.timeSeries().data(), syncd.unsyncSize());
 }
@@ -53,9 +53,49 @@ class InvalidBars {
   }
 };
 
+/**
+ * What is known about the last bars loaded for each data source, symbol and
+ * range, used to recognize bars loaded again after bars were appended to the
+ * data, such as a daily file that gained one bar.
+ *
+ * The entries are set when the bars are released, as by then all the bars
+ * have been added
+ */
+class BarsHistory {
+ public:
+  enum { low, high, open, close, volume, openInterest, seriesCount };
+
+  class Entry {
+   public:
+    size_t size;
+    // the bars id, which hashes all the bar values
+    Id content;
+    // the ids of the low, high, open, close, volume and open interest series
+    std::array<Id, seriesCount> series;
+  };
+
+ private:
+  std::mutex _mutex;
+  std::unordered_map<Id, Entry> _entries;
+
+ public:
+  static BarsHistory& instance();
+
+  std::optional<Entry> find(const Id& source) {
+    std::scoped_lock lock(_mutex);
+    std::unordered_map<Id, Entry>::const_iterator i = _entries.find(source);
+    return i != _entries.end() ? std::optional<Entry>(i->second) : std::nullopt;
+  }
+
+  void set(const Id& source, const Entry& entry) {
+    std::scoped_lock lock(_mutex);
+    _entries[source] = entry;
+  }
+};
+
 // TODO: add iterators and other stuff so I can use algorithms on this
 
-class BarsImpl : public tradery::BarsAbstr, public BarsBase, public Ideable {
+class BarsImpl : public tradery::BarsAbstr, public BarsBase, public BarsAppender, public Ideable {
   OBJ_COUNTER(BarsImpl)
  private:
   // interval between bars in seconds. Usually it goes from 1 minute to 1 month
@@ -77,21 +117,133 @@ class BarsImpl : public tradery::BarsAbstr, public BarsBase, public Ideable {
 
   InvalidBars _invalidBars;
 
+  // identifies the data source, symbol and range, while the bars id also
+  // hashes the values of all the bars added, so indicators calculated on
+  // bars with different values never share the same id
+  const Id _source;
+  // the last bars loaded from the same source, until as many bars are added
+  std::optional<BarsHistory::Entry> _previous;
+
  public:
-  // TODO: the bars id is the symbol for now (for testing). Needs to have
-  // datasource, range, and other info that shows it's up to date
-  // and the various series are created attaching the name of the series
-  // will need to be changed to make them foolproof, unique numbers etc
   BarsImpl(const std::string& dataSourceName, const std::string& symbol, Type type, unsigned int resolution, DateTimeRangePtr range, ErrorHandlingMode errorHandlingMode)
       : _resolution(resolution),
-        _type(type), Ideable(dataSourceName + " - bars - " + symbol + (range == 0 ? "" : " - range: " + range->getId())),
-        BarsBase(symbol), _errorHandlingMode(errorHandlingMode) {}
+        _type(type), Ideable(Id::make("bars", dataSourceName, symbol, range == 0 ? std::string() : range->getId())),
+        BarsBase(symbol), _errorHandlingMode(errorHandlingMode), _source(getId()), _previous(BarsHistory::instance().find(_source)) {}
+
+  /**
+   * Bars with count bars of bars, starting at first, for example the bars in a
+   * range of the full history of a symbol. The values are copied from the
+   * series of bars instead of being loaded again from the data source
+   *
+   * If first is 0, the series extend the series of bars (see
+   * SeriesImpl::Prefix), so indicators already calculated on the full history
+   * are reused if the series cache is enabled
+   */
+  BarsImpl(const BarsImpl& bars, size_t first, size_t count, const std::string& dataSourceName, DateTimeRangePtr range)
+      : BarsImpl(dataSourceName, bars.getSymbol(), bars._type, bars._resolution, range, bars._errorHandlingMode) {
+    assert(first + count <= bars.unsyncSize());
+    setDataLocationInfo(bars.dataLocationInfo());
+    if (count == 0) {
+      return;
+    }
 
-  ~BarsImpl() override {}
+    const DateTime* time = bars._timeSeries.data() + first;
+    const double* open = impl(bars._openSeries).getArray() + first;
+    const double* high = impl(bars._highSeries).getArray() + first;
+    const double* low = impl(bars._lowSeries).getArray() + first;
+    const double* close = impl(bars._closeSeries).getArray() + first;
+    const double* volume = impl(bars._volumeSeries).getArray() + first;
+    for (size_t n = 0; n < count; ++n) {
+      check(time[n], open[n], high[n], low[n], close[n], (unsigned long)volume[n]);
+    }
+
+    impl(_lowSeries).append(low, count);
+    impl(_highSeries).append(high, count);
+    impl(_openSeries).append(open, count);
+    impl(_closeSeries).append(close, count);
+    impl(_volumeSeries).append(volume, count);
+    impl(_openInterest).append(impl(bars._openInterest).getArray() + first, count);
+    _timeSeries.append(time, count);
+    _extraInfoSeries.append(bars._extraInfoSeries, first, count);
+    added(0);
+
+    if (first == 0) {
+      const std::array<Id, BarsHistory::seriesCount> ids(bars.seriesIds());
+      impl(_lowSeries).setPrefix(ids[BarsHistory::low], count);
+      impl(_highSeries).setPrefix(ids[BarsHistory::high], count);
+      impl(_openSeries).setPrefix(ids[BarsHistory::open], count);
+      impl(_closeSeries).setPrefix(ids[BarsHistory::close], count);
+      impl(_volumeSeries).setPrefix(ids[BarsHistory::volume], count);
+      impl(_openInterest).setPrefix(ids[BarsHistory::openInterest], count);
+    }
+  }
+
+  /**
+   * A copy of bars, for one of the users of the bars in the data cache. Each
+   * user can synchronize and change its copy without affecting the cached bars
+   * and the other users.
+   *
+   * The series have the ids and prefixes of those of bars, so indicators
+   * calculated on the copies are shared in the series cache, by the copies
+   * that are not synchronized or are synchronized with the same synchronizer
+   * (see synchronizedId). The values are copied, while the time series,
+   * which a copy never appends to, is shared
+   */
+  BarsImpl(const BarsImpl& bars)
+      : BarsBase(bars),
+        Ideable(bars),
+        _resolution(bars._resolution),
+        _type(bars._type),
+        _lowSeries(impl(bars._lowSeries).copy()),
+        _highSeries(impl(bars._highSeries).copy()),
+        _openSeries(impl(bars._openSeries).copy()),
+        _closeSeries(impl(bars._closeSeries).copy()),
+        _volumeSeries(impl(bars._volumeSeries).copy()),
+        _openInterest(impl(bars._openInterest).copy()),
+        _timeSeries(bars._timeSeries),
+        _extraInfoSeries(bars._extraInfoSeries),
+        _errorHandlingMode(bars._errorHandlingMode),
+        _invalidBars(bars._invalidBars),
+        _source(bars._source) {
+    assert(!bars.isSynchronized());
+  }
+
+  ~BarsImpl() override {
+    if (_lowSeries.unsyncSize() > 0) {
+      BarsHistory::instance().set(_source, BarsHistory::Entry{_lowSeries.unsyncSize(), getId(), seriesIds()});
+    }
+  }
+
+ private:
+  static SeriesImpl& impl(const Series& series) {
+    // the series are created by the bars, and are always SeriesImpl
+    return const_cast<SeriesImpl&>(dynamic_cast<const SeriesImpl&>(series.getSeries()));
+  }
+
+  std::array<Id, BarsHistory::seriesCount> seriesIds() const {
+    return {impl(_lowSeries).getId(), impl(_highSeries).getId(), impl(_openSeries).getId(), impl(_closeSeries).getId(), impl(_volumeSeries).getId(), impl(_openInterest).getId()};
+  }
+
+  /**
+   * Called once the bars have as many bars as the last ones loaded from the
+   * same source. If all the values are the same, the series are marked as
+   * extending the previous ones, so indicators already calculated on those
+   * are extended instead of calculated again
+   */
+  void checkExtends(const BarsHistory::Entry& previous) {
+    if (getId() == previous.content) {
+      impl(_lowSeries).setPrefix(previous.series[BarsHistory::low], previous.size);
+      impl(_highSeries).setPrefix(previous.series[BarsHistory::high], previous.size);
+      impl(_openSeries).setPrefix(previous.series[BarsHistory::open], previous.size);
+      impl(_closeSeries).setPrefix(previous.series[BarsHistory::close], previous.size);
+      impl(_volumeSeries).setPrefix(previous.series[BarsHistory::volume], previous.size);
+      impl(_openInterest).setPrefix(previous.series[BarsHistory::openInterest], previous.size);
+    }
+  }
 
  public:
   void synchronize(Bars bars) override {
-    _synchronizer = Synchronizer::create(bars, Bars(this));
+    _synchronizer = makeSynchronizer(bars);
     _lowSeries.synchronize(_synchronizer);
     _highSeries.synchronize(_synchronizer);
     _openSeries.synchronize(_synchronizer);
@@ -126,6 +278,21 @@ class BarsImpl : public tradery::BarsAbstr, public BarsBase, public Ideable {
     return _timeSeries.unsyncStartEnd();
   }
 
+  /**
+   * Finds the bars in a range, ignoring synchronization. The bars are expected
+   * to be sorted by time, as the data sources stop loading at the first bar
+   * after the range
+   *
+   * @param range  the range
+   * @return the index of the first bar in the range and the index after the
+   *         last one
+   */
+  std::pair<size_t, size_t> find(const DateTimeRange& range) const {
+    const DateTime* begin = _timeSeries.data();
+    const DateTime* end = begin + _timeSeries.size();
+    return {std::lower_bound(begin, end, range.from()) - begin, std::upper_bound(begin, end, range.to()) - begin};
+  }
+
   const Bar getBar(size_t ix) const override {
     return get(ix);
   }
@@ -133,53 +300,148 @@ class BarsImpl : public tradery::BarsAbstr, public BarsBase, public Ideable {
   const std::string& getSymbol() const override { return BarsBase::getSymbol(); }
 
   const Bar get(size_t index) const override {
-    return Bar( time(index), open(index), high(index), low(index), close(index),
-        volume(index), openInterest(index), getBarExtraInfo(index) == 0 ? 0 : getBarExtraInfo(index)->clone());
+    const tradery::BarExtraInfoPtr extraInfo(getBarExtraInfo(index));
+    return Bar(time(index), open(index), high(index), low(index), close(index), volume(index), openInterest(index),
+               extraInfo ? extraInfo->clone() : tradery::BarExtraInfoPtr{});
   }
 
   unsigned long resolution() const override { return _resolution; }
 
-  size_t size() const {
-    if (_lowSeries.size() != _highSeries.size()) {
-      LOG(log_info, "symbol: ", getSymbol(), "low size: ", _lowSeries.size(), ", high size: ", _highSeries.size());
+  // this works for both sync and unsync bars - if it's synced, we already
+  // synced the low series too (see synchronize( .. ) )
+  size_t size() const { return _lowSeries.size(); }
+
+  // implemented from base class Addable
+  void add(const Bar& bar) {
+    add(bar.time(), bar.getOpen(), bar.getHigh(), bar.getLow(), bar.getClose(), bar.getVolume(), bar.getOpenInterest(), bar.getBarExtraInfo());
+  }
+
+  // implemented from BarsAppender
+  void add(const DateTime& time, double open, double high, double low, double close, unsigned long volume, unsigned long openInterest) override {
+    add(time, open, high, low, close, volume, openInterest, BarExtraInfoPtr{});
+  }
+
+  void add(size_t count, const __int64* time, const double* open, const double* high, const double* low, const double* close, const double* volume,
+           const double* openInterest) override {
+    // check all the bars first. If one is not valid and the mode is fatal, the
+    // bars before it are still added, as when the bars are added one by one
+    size_t valid = 0;
+    try {
+      for (; valid < count; ++valid) {
+        check(DateTime::fromTicks(time[valid]), open[valid], high[valid], low[valid], close[valid], (unsigned long)volume[valid]);
+      }
+    }
+    catch (const BarException&) {
+      append(valid, time, open, high, low, close, volume, openInterest);
+      throw;
+    }
+    append(count, time, open, high, low, close, volume, openInterest);
+  }
+
+  void reserve(size_t count) override {
+    impl(_lowSeries).reserve(count);
+    impl(_highSeries).reserve(count);
+    impl(_openSeries).reserve(count);
+    impl(_closeSeries).reserve(count);
+    impl(_volumeSeries).reserve(count);
+    impl(_openInterest).reserve(count);
+    _timeSeries.reserve(count);
+  }
+
+ private:
+  // appends count bars that have already been checked
+  void append(size_t count, const __int64* time, const double* open, const double* high, const double* low, const double* close, const double* volume,
+              const double* openInterest) {
+    if (count == 0) {
+      return;
     }
-    assert(_lowSeries.size() == _highSeries.size());
-    assert(_lowSeries.size() == _openSeries.size());
-    assert(_lowSeries.size() == _closeSeries.size());
-    assert(_lowSeries.size() == _volumeSeries.size());
-    // todo: handle the time series for synchronized series
+    const size_t size = _lowSeries.unsyncSize();
+    impl(_lowSeries).append(low, count);
+    impl(_highSeries).append(high, count);
+    impl(_openSeries).append(open, count);
+    impl(_closeSeries).append(close, count);
+    impl(_volumeSeries).append(volume, count);
+    impl(_openInterest).append(openInterest, count);
+    _timeSeries.append(time, count);
+    _extraInfoSeries.resize(size + count);
+    added(size);
+  }
+
+  /**
+   * Synchronizes these bars to ref, or returns the synchronizer already made for
+   * the same reference bars and the same bars
+   */
+  Synchronizer::SynchronizerPtr makeSynchronizer(Bars ref) const;
+
+  // all the series have the same number of values once the bars are added
+  void assertSizes() const {
+    assert(_lowSeries.unsyncSize() == _highSeries.unsyncSize());
+    assert(_lowSeries.unsyncSize() == _openSeries.unsyncSize());
+    assert(_lowSeries.unsyncSize() == _closeSeries.unsyncSize());
+    assert(_lowSeries.unsyncSize() == _volumeSeries.unsyncSize());
+    assert(_lowSeries.unsyncSize() == _openInterest.unsyncSize());
     assert(_lowSeries.unsyncSize() == _timeSeries.size());
-    assert(_lowSeries.size() == _openInterest.size());
-    // todo: handle extra info for synced series
     assert(_lowSeries.unsyncSize() == _extraInfoSeries.size());
-
-    // this works for both sync and unsync bars - if it's synced, we already
-    // synced the low series too (see synchronize( .. ) )
-    return _lowSeries.size();
   }
 
-  // implemented from base class Addable
-  void add(const Bar& bar) {
-    if (!bar.isValid()) {
+  void check(const DateTime& time, double open, double high, double low, double close, unsigned long volume) {
+    const Bar::BarStatus status = Bar::status(open, high, low, close, volume);
+    if (status != Bar::valid) {
       if (_errorHandlingMode == fatal) {
-        throw BarException(bar.getStatusAsString());
+        throw BarException(Bar::statusAsString(time, status));
       }
       else if (_errorHandlingMode == warning) {
         // if warning mode, add the index of the current bar (the one that's
         // being added)
-        _invalidBars.add(bar.getStatusAsString());
+        _invalidBars.add(Bar::statusAsString(time, status));
       }
     }
-    _lowSeries.push_back(bar.getLow());
-    _highSeries.push_back(bar.getHigh());
-    _openSeries.push_back(bar.getOpen());
-    _closeSeries.push_back(bar.getClose());
-    _volumeSeries.push_back(bar.getVolume());
-    _openInterest.push_back(bar.getOpenInterest());
-    _timeSeries.push_back(bar.time());
-    _extraInfoSeries.push_back(bar.getBarExtraInfo());
   }
 
+  // hashes the values of the bars added starting at index from into the bars
+  // id, the same way as adding them one by one does
+  void added(size_t from) {
+    assertSizes();
+    if (from >= _lowSeries.unsyncSize()) {
+      return;
+    }
+    const DateTime* time = _timeSeries.data();
+    const double* open = impl(_openSeries).getArray();
+    const double* high = impl(_highSeries).getArray();
+    const double* low = impl(_lowSeries).getArray();
+    const double* close = impl(_closeSeries).getArray();
+    const double* volume = impl(_volumeSeries).getArray();
+    const double* openInterest = impl(_openInterest).getArray();
+    for (size_t n = from; n < _lowSeries.unsyncSize(); ++n) {
+      setId(Id::make("bar", getId(), time[n].to_epoch_time(), open[n], high[n], low[n], close[n], (unsigned long)volume[n], (unsigned long)openInterest[n]));
+      if (_previous && n + 1 == _previous->size) {
+        checkExtends(*_previous);
+        _previous.reset();
+      }
+    }
+  }
+
+  void add(const DateTime& time, double open, double high, double low, double close, unsigned long volume, unsigned long openInterest, BarExtraInfoPtr extraInfo) {
+    check(time, open, high, low, close, volume);
+    _lowSeries.push_back(low);
+    _highSeries.push_back(high);
+    _openSeries.push_back(open);
+    _closeSeries.push_back(close);
+    _volumeSeries.push_back(volume);
+    _openInterest.push_back(openInterest);
+    _timeSeries.push_back(time);
+    _extraInfoSeries.push_back(extraInfo);
+    assertSizes();
+
+    setId(Id::make("bar", getId(), time.to_epoch_time(), open, high, low, close, volume, openInterest));
+    if (_previous && _lowSeries.unsyncSize() == _previous->size) {
+      checkExtends(*_previous);
+      _previous.reset();
+    }
+  }
+
+ public:
+
   void forEach(tradery::BarHandler& barHandler, size_t startBar = 0) const override {
     if (startBar >= size()) {
       throw BarIndexOutOfRangeException(size(), startBar, getSymbol());
@@ -275,17 +537,15 @@ class BarsImpl : public tradery::BarsAbstr, public BarsBase, public Ideable {
   }
 
   const tradery::BarExtraInfoPtr getBarExtraInfo(size_t barIndex) const {
-    try {
-      // todo: fix for synced series
-      return 0;
-      //      return _extraInfoSeries[ barIndex ] );
-    }
-    catch (const std::out_of_range&) {
+    if (barIndex >= size()) {
       throw BarIndexOutOfRangeException(size(), barIndex, BarsBase::getSymbol());
     }
-    catch (const SynchronizedSeriesIndexOutOfRangeException& e) {
-      throw BarIndexOutOfRangeException(e.getSize(), e.getIndex(), BarsBase::getSymbol());
+    if (isSynchronized()) {
+      // the synced bar, or none if there is no bar with the same time stamp
+      const int index = _synchronizer->index(barIndex);
+      return index < 0 ? tradery::BarExtraInfoPtr{} : _extraInfoSeries[index];
     }
+    return _extraInfoSeries[barIndex];
   }
 
   const Series openSeries() const { return _openSeries; }
@@ -298,6 +558,8 @@ class BarsImpl : public tradery::BarsAbstr, public BarsBase, public Ideable {
     return isSynchronized() ? _synchronizer->timeSeries() : _timeSeries;
   }
 
+  const tradery::TimeSeries& unsyncTimeSeries() const { return _timeSeries; }
+
   const tradery::ExtraInfoSeries& getExtraInfoSeries() const override {
     return _extraInfoSeries;
   }
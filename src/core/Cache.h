@@ -16,11 +16,165 @@
 
 #pragma once
 
-using Id = std::string;
+#include <array>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
 
 /**
- * Abstract based class for classes that can have an id. The id is currently
- * implemented as a string
+ * Structural cache key
+ *
+ * An Id is a 128 bit value calculated from an operation tag, the operation
+ * parameters and the ids of the objects the operation is applied to (its
+ * parents). Building the id of a derived object costs a few multiplications
+ * regardless of how deep the expression that created it is, and looking it up
+ * in the cache is a hash compare instead of a long string compare.
+ *
+ * Leaf objects (bars, user created series) get their id either from a string
+ * that uniquely describes them or from a process wide counter (see unique).
+ *
+ * The string form (toString) is only meant for diagnostics
+ */
+class Id {
+ private:
+  uint64_t _hi;
+  uint64_t _lo;
+
+ private:
+  static constexpr uint64_t K1 = 0x9e3779b97f4a7c15ULL;
+  static constexpr uint64_t K2 = 0xc2b2ae3d27d4eb4fULL;
+
+  // splitmix64 finalizer
+  static uint64_t fmix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+  Id(uint64_t hi, uint64_t lo) : _hi(hi), _lo(lo) {}
+
+  Id& mix(uint64_t v) {
+    _hi = fmix(_hi ^ (v + K1));
+    _lo = fmix(_lo + rotl(v, 31) * K2) ^ _hi;
+    return *this;
+  }
+
+  Id& mix(const char* str, size_t size) {
+    mix(size);
+    uint64_t v;
+    for (; size >= sizeof(v); str += sizeof(v), size -= sizeof(v)) {
+      std::memcpy(&v, str, sizeof(v));
+      mix(v);
+    }
+    if (size > 0) {
+      v = 0;
+      std::memcpy(&v, str, size);
+      mix(v);
+    }
+    return *this;
+  }
+
+  Id& mix(const Id& id) { return mix(id._hi).mix(id._lo); }
+  Id& mix(const std::string& str) { return mix(str.data(), str.size()); }
+  Id& mix(const char* str) { return mix(str, std::strlen(str)); }
+  Id& mix(double d) {
+    // +0.0 and -0.0 must result in the same key
+    if (d == 0) {
+      d = 0;
+    }
+    uint64_t v;
+    std::memcpy(&v, &d, sizeof(v));
+    return mix(v);
+  }
+
+  template <typename T>
+  std::enable_if_t<std::is_integral_v<T> || std::is_enum_v<T>, Id&> mix(T t) {
+    return mix((uint64_t)(int64_t)t);
+  }
+
+ public:
+  /**
+   * The null id - the id of objects that are not cached
+   */
+  Id() : _hi(0), _lo(0) {}
+
+  /**
+   * Leaf id, built from a string that uniquely describes the object
+   *
+   * @param str    the object description
+   */
+  explicit Id(const std::string& str) : _hi(K1), _lo(K2) { mix(str); }
+
+  /**
+   * Builds the id of an object calculated by the operation "tag" with the
+   * arguments args. Arguments can be other ids (the parents), strings,
+   * integral, enum or floating point values.
+   *
+   * The result depends on the order of the arguments
+   *
+   * @param tag    the operation tag, usually the indicator name
+   * @param args   the parent ids and operation parameters
+   * @return the new id
+   */
+  template <typename... Args>
+  static Id make(const char* tag, const Args&... args) {
+    Id id(K2, K1);
+    id.mix(tag);
+    (id.mix(args), ...);
+    return id;
+  }
+
+  /**
+   * Generates a new id, unique for the life of the process
+   *
+   * Used for series created by the user, which have no structural
+   * description. This insures that series calculated from them will have
+   * unique ids as well
+   */
+  static Id unique() {
+    static std::atomic<uint64_t> counter(0);
+    return make("unique", ++counter);
+  }
+
+  bool isNull() const { return _hi == 0 && _lo == 0; }
+
+  bool operator==(const Id& id) const { return _hi == id._hi && _lo == id._lo; }
+  bool operator!=(const Id& id) const { return !(*this == id); }
+  bool operator<(const Id& id) const {
+    return _hi < id._hi || (_hi == id._hi && _lo < id._lo);
+  }
+
+  size_t hash() const { return (size_t)(_hi ^ rotl(_lo, 17)); }
+
+  /**
+   * Hex representation of the id, for diagnostics only
+   */
+  std::string toString() const {
+    char buf[33];
+    sprintf_s(buf, sizeof(buf), "%016llx%016llx", (unsigned long long)_hi, (unsigned long long)_lo);
+    return buf;
+  }
+};
+
+namespace std {
+template <>
+struct hash<Id> {
+  size_t operator()(const Id& id) const { return id.hash(); }
+};
+}  // namespace std
+
+/**
+ * Abstract based class for classes that can have an id. The id is a
+ * structural key (see Id)
  *
  * The cache uses the id to identify the cached objects
  */
@@ -44,6 +198,9 @@ class Ideable {
    * @return the id
    */
   const Id& getId() const { return _id; }
+
+ protected:
+  void setId(const Id& id) { _id = id; }
 };
 
 template <class T>
@@ -54,6 +211,8 @@ class Cacheable : public std::shared_ptr<T> {
  public:
   Cacheable(T* t, const Id& id) : std::shared_ptr<T>(t), _id(id) {}
 
+  Cacheable(std::shared_ptr<T> t, const Id& id) : std::shared_ptr<T>(t), _id(id) {}
+
   Cacheable(const Id& id) : std::shared_ptr<T>(), _id(id) {}
 
   Cacheable(const Cacheable& cacheable)
@@ -114,6 +273,13 @@ inline void cache_thread_func(void* param) {
   p->run();
 }
 
+/**
+ * Estimated memory used by a cached object, used to enforce the cache budget.
+ * Specialized for each type of cached object
+ */
+template <class T>
+class CacheableBytes;
+
 /**
  * The way the cache works: each time a cache user needs data that may be in the
  * cache, it calls findAndAdd with an instance of a CacheableBuilder derived
@@ -138,20 +304,20 @@ inline void cache_thread_func(void* param) {
  * count is > 0. When they all go out of their respective scope, the count
  * decreases to 0. At this moment the cache knows that the object is no longer
  * in use and may choose to remove it, or keep it (this is still to be
- * determined). This is done in the background thread running in the Cache - it
- * keep looking for objects with reference 0, and it may choose to remove some
- * of them based on how long they have been there, how much memory is being used
- * and other criteria. The two extremes would be to either remove all objects
- * with reference count 0 immediately, or to keep everthing for the life time of
- * the cache object and only delete all of them in the destructor of the cache.
+ * determined). This is done in the background thread running in the Cache -
+ * when the memory used by the cached objects goes over the budget, it removes
+ * objects with reference 0, starting with the ones that are cheapest to make,
+ * largest and least recently or frequently used, until the cache is back
+ * within budget.
  *
  * Regarding the Id's, they are calculated by the cached objects themselves -
  * the only requirement is that they be unique for unique objects
  *
  * The currently cached classes, such as Series or DataCollection calculate the
  * id in a recursive fashion. A series can be created as a result of an
- * operation on other series, and all the information regarding its ancestors
- * and how it was calculated is stored in the id.
+ * operation on other series, and the id is a hash of the operation, its
+ * parameters and the ids of its ancestors (see Id::make), so it has the same
+ * fixed size no matter how deep the expression.
  *
  *
  * Empty Series, which are created by the user, are given an unique initial id,
@@ -172,81 +338,188 @@ inline void cache_thread_func(void* param) {
  * The cache is derived from CacheThread - its method run is the background
  * thread
  *
- * The cache is thread safe
+ * The cache is thread safe. The items are spread over a number of shards, each
+ * with its own lock, based on the id hash, so threads looking up different
+ * items rarely contend. Objects are never made while holding a lock: on a miss
+ * the first requester publishes an in-flight future for the id, makes the
+ * object and then fulfills the future. Other threads requesting the same id in
+ * the meantime wait on that future instead of making the object again
  */
 template <class T>
 class Cache : public CacheThread {
   using CacheableT = Cacheable<T>;
-  using ParkVector = std::vector<CacheableT>;
+  using CacheablePtr = std::shared_ptr<CacheableT>;
+  using CacheableFuture = std::shared_future<CacheablePtr>;
+
+  /**
+   * A cached item and the information used to decide when to evict it
+   *
+   * The priority is calculated GDSF style (Greedy Dual Size Frequency):
+   * inflation + frequency * cost / bytes, so items that are used often, were
+   * expensive to make and are small are kept the longest. The inflation value
+   * is raised to the priority of each evicted item, which ages the items that
+   * have not been accessed in a while
+   */
+  class Entry {
+   public:
+    CacheablePtr _item;
+    // the type of the builder that made the item, used for stats
+    const char* _type;
+    uint64_t _bytes;
+    double _cost;
+    uint64_t _frequency;
+    double _priority;
+
+   public:
+    Entry(CacheablePtr item, const char* type, uint64_t bytes, double cost, double inflation)
+        : _item(item), _type(type), _bytes(std::max<uint64_t>(bytes, 1)), _cost(cost), _frequency(1) {
+      touch(inflation);
+    }
 
-  using CacheableMap = ConstPtrMap<Id, CacheableT>;
+    void touch(double inflation) {
+      _priority = inflation + _frequency * _cost / _bytes;
+    }
+
+    void hit(double inflation) {
+      ++_frequency;
+      touch(inflation);
+    }
+
+    bool inUse() const { return _item->use_count() > 1; }
+  };
+
+  using CacheableMap = std::unordered_map<Id, Entry>;
+  using InFlightMap = std::unordered_map<Id, CacheableFuture>;
+  // stats by builder type name, as returned by typeid - the pointer is unique
+  // for each type
+  using TypeStatsMap = std::unordered_map<const char*, tradery::CacheTypeStats>;
+
+  static constexpr size_t SHARDS = 16;
+
+  class Shard {
+   public:
+    std::mutex _mutex;
+    CacheableMap _cache;
+    InFlightMap _inFlight;
+    TypeStatsMap _stats;
+
+    // must be called with the shard locked
+    void erase(typename CacheableMap::iterator i, std::atomic<uint64_t>& bytes) {
+      bytes -= i->second._bytes;
+      _stats[i->second._type].bytes -= i->second._bytes;
+      _cache.erase(i);
+    }
+  };
+
+  class Candidate {
+   public:
+    double _priority;
+    size_t _shard;
+    Id _id;
+
+    bool operator<(const Candidate& candidate) const { return _priority < candidate._priority; }
+  };
 
  private:
-  bool _enable;
-  mutable std::mutex _mutex;
-  CacheableMap _cache;
-  bool _run;
-  bool _running;
-  bool _first;
-  bool _doBackgroundProcessing;
-  unsigned int _size;
+  std::atomic<bool> _enable;
+  std::array<Shard, SHARDS> _shards;
+  std::once_flag _first;
+  std::atomic<bool> _run;
+  std::atomic<bool> _running;
+  // budget and resident size in bytes
+  std::atomic<uint64_t> _budget;
+  std::atomic<uint64_t> _bytes;
+  std::atomic<double> _inflation;
+
+  // the background thread waits on this until the cache goes over budget
+  std::mutex _backgroundMutex;
+  std::condition_variable _backgroundCondition;
+  bool _overBudget;
+
+ private:
+  Shard& shard(const Id& id) { return _shards[id.hash() % SHARDS]; }
+
+  static uint64_t microsecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  void signalBackground() {
+    {
+      std::scoped_lock lock(_backgroundMutex);
+      _overBudget = true;
+    }
+    _backgroundCondition.notify_one();
+  }
 
  public:
   /**
-   * Default constructor
+   * Constructor
    *
-   * Initializes the cache
-   *
-   * @param T
+   * @param budget the maximum number of bytes held by the cache. Items that
+   *               are still in use are never evicted, so the budget can be
+   *               temporarily exceeded
+   * @param enable if false, the cache will always make the requested objects
    */
-  Cache(unsigned int size, bool enable)
+  Cache(uint64_t budget, bool enable)
       : _enable(enable),
         _run(true),
         _running(false),
-        _first(true),
-        _size(size),
-        _doBackgroundProcessing(false) {}
+        _budget(budget),
+        _bytes(0),
+        _inflation(0),
+        _overBudget(false) {}
 
   virtual ~Cache() {
     // tell the background thread to stop
-    _run = false;
+    {
+      std::scoped_lock lock(_backgroundMutex);
+      _run = false;
+    }
+    _backgroundCondition.notify_one();
     // wait for the background thread to stop
     while (_running) ::Sleep(1);
   }
 
-  void startBackgroundThread() { _beginthread(cache_thread_func, 0, this); }
+  void startBackgroundThread() { _running = true; _beginthread(cache_thread_func, 0, this); }
 
+  /**
+   * Evicts items that are not in use, in increasing order of priority, until
+   * the cache is within budget or there is nothing left to evict
+   */
   void doBackgroundProcessing() {
-    // lock for background processing
-    //		XLock l( _bpmutex );
-    std::scoped_lock l(_mutex);
-    // signal that we have done the background processing
-    _doBackgroundProcessing = false;
-
-    // if cache size > _size (currently number of itmes)
-    // it will erase one random element
-    // TODO: implement some smart scheme, which looks at frequency of access as
-    // well as how recent an element has been accessed
-    static unsigned int crt = 0;
-    if (_cache.size() > _size) {
-      if (crt >= _cache.size()) {
-        crt = 0;
-      }
+    if (_bytes <= _budget) {
+      return;
+    }
 
-      int n = 0;
-      for (CacheableMap::iterator i = _cache.begin(); i != _cache.end(); i++, n++) {
-        if (n == crt) {
-          std::shared_ptr< const CacheableT > p = i->second;
-          if (p.use_count() == 1) {
-            _cache.erase(i);
-            break;
-          }
-         }
+    std::vector<Candidate> candidates;
+    for (size_t n = 0; n < SHARDS; n++) {
+      Shard& shard = _shards[n];
+      std::scoped_lock lock(shard._mutex);
+      for (const typename CacheableMap::value_type& i : shard._cache) {
+        if (!i.second.inUse()) {
+          candidates.push_back(Candidate{ i.second._priority, n, i.first });
         }
       }
-      crt++;
     }
 
+    std::sort(candidates.begin(), candidates.end());
+
+    for (const Candidate& candidate : candidates) {
+      if (_bytes <= _budget) {
+        break;
+      }
+      Shard& shard = _shards[candidate._shard];
+      std::scoped_lock lock(shard._mutex);
+      // the item may have been used or replaced since the candidates were
+      // collected
+      typename CacheableMap::iterator i = shard._cache.find(candidate._id);
+      if (i != shard._cache.end() && !i->second.inUse()) {
+        _inflation = std::max<double>(_inflation, i->second._priority);
+        shard._stats[i->second._type].evictions++;
+        shard.erase(i, _bytes);
+      }
+    }
+  }
 
   /**
    * called by Cache users to find a cache item.
@@ -260,60 +533,130 @@ class Cache : public CacheThread {
    * The CacheableBuilder has information about the object to be looked up - its
    * id, and if not found, how to create a new instance
    *
+   * The object is made outside of any lock, so make can itself look up other
+   * objects in the cache. If make throws, the exception is passed on to all
+   * the threads waiting for the same object, and nothing is added to the cache
+   *
    * @param T      The CacheableBuilder object
    * @param mc
-   * @param mc
    * @return A managed pointer to the retrieved or newly created object
    */
   std::shared_ptr<T> findAndAdd(const CacheableBuilder<T>& mc) {
-    std::scoped_lock lock(_mutex);
+    // start the background thread on the first access
+    // this thread does garbage collection and in general cache management
+    std::call_once(_first, [this]() { startBackgroundThread(); });
+
+    const Id& id = mc.id();
+    const char* type = typeid(mc).name();
+    Shard& shard = this->shard(id);
 
-    if (_first) {
-      // start the background thread on the first access
-      // this thread does garbage collection and in general cache management
-      startBackgroundThread();
-      _first = false;
+    if (!_enable) {
+      // if the cache is disabled, just return return a std::shared_ptr that will
+      // auto destroy the RefCounter and the payload when the reference count
+      // goes to 0 in this case, the ID doesn't count as nothing is stored in
+      // the cache, but calculated on the fly every time
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      CacheablePtr p = mc.make();
+      uint64_t time = microsecondsSince(start);
+      std::scoped_lock lock(shard._mutex);
+      tradery::CacheTypeStats& stats = shard._stats[type];
+      stats.misses++;
+      stats.makeTime += time;
+      return *p;
     }
 
-    if (_enable) {
-      // if enabled, do the find and add if not found
-      const Id& id = mc.id();
-      CacheableMap::iterator i = _cache.find(id);
-      if (i != _cache.end()) {
+    std::promise<CacheablePtr> promise;
+    {
+      std::unique_lock lock(shard._mutex);
+      tradery::CacheTypeStats& stats = shard._stats[type];
+      typename CacheableMap::iterator i = shard._cache.find(id);
+      if (i != shard._cache.end()) {
         // cache hit
         // check data consistency and if not, get the new data
-        if (mc.isConsistent(*i->second)) {
-          return *i->second;
-        }
-        else {
-          _cache.erase(i);
-          // recursively call findAndAdd to get the new element and add it to
-          // the cache
-          return findAndAdd(mc);
+        if (mc.isConsistent(*i->second._item)) {
+          stats.hits++;
+          i->second.hit(_inflation);
+          return *i->second._item;
         }
+        stats.inconsistent++;
+        shard.erase(i, _bytes);
       }
-      else {
-        // cache miss, create the requested item
-        // insert in the cache
-        std::pair<CacheableMap::iterator, bool> p = _cache.insert(CacheableMap::value_type(id, mc.make()));
-        // return a copy of the managed ptr in the cache (which increments the
-        // reference)
-        if (p.second) {
-          return *((*p.first).second);
-        }
-        else {
-          assert(false);
-          return nullptr;
-        }
+
+      typename InFlightMap::iterator f = shard._inFlight.find(id);
+      if (f != shard._inFlight.end()) {
+        // another thread is making this object, wait for it outside the lock
+        stats.hits++;
+        CacheableFuture future = f->second;
+        lock.unlock();
+        return *future.get();
       }
+
+      // cache miss, publish the future so others will wait for this thread
+      stats.misses++;
+      shard._inFlight.insert(typename InFlightMap::value_type(id, promise.get_future().share()));
     }
-    else {
-      // if the cache is disabled, just return return a std::shared_ptr that will
-      // auto destroy the RefCounter and the payload when the reference count
-      // goes to 0 in this case, the ID doesn't count as nothing is stored in
-      // the cache, but calculated on the fly every time
-      return *mc.make();
+
+    CacheablePtr p;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    try {
+      p = mc.make();
     }
+    catch (...) {
+      {
+        std::scoped_lock lock(shard._mutex);
+        shard._inFlight.erase(id);
+      }
+      promise.set_exception(std::current_exception());
+      throw;
+    }
+    // the cost of an item is the time it took to make it, in microseconds
+    uint64_t time = microsecondsSince(start);
+    uint64_t bytes = *p ? CacheableBytes<T>::bytes(**p) : 0;
+
+    {
+      std::scoped_lock lock(shard._mutex);
+      typename CacheableMap::iterator i = shard._cache.find(id);
+      if (i != shard._cache.end()) {
+        shard.erase(i, _bytes);
+      }
+      Entry entry(p, type, bytes, (double)time + 1, _inflation);
+      tradery::CacheTypeStats& stats = shard._stats[type];
+      stats.makeTime += time;
+      stats.bytes += entry._bytes;
+      _bytes += entry._bytes;
+      shard._cache.insert(typename CacheableMap::value_type(id, entry));
+      shard._inFlight.erase(id);
+    }
+    promise.set_value(p);
+
+    if (_bytes > _budget) {
+      signalBackground();
+    }
+    // return a copy of the managed ptr in the cache (which increments the
+    // reference)
+    return *p;
+  }
+
+  /**
+   * Looks up an item without making it if it is not found
+   *
+   * @param id     the id of the item
+   * @return the item, or an empty pointer if it is not in the cache
+   */
+  std::shared_ptr<T> find(const Id& id) {
+    if (!_enable) {
+      return std::shared_ptr<T>();
+    }
+
+    Shard& shard = this->shard(id);
+    std::scoped_lock lock(shard._mutex);
+    typename CacheableMap::iterator i = shard._cache.find(id);
+    if (i == shard._cache.end()) {
+      return std::shared_ptr<T>();
+    }
+    shard._stats[i->second._type].hits++;
+    i->second.hit(_inflation);
+    return *i->second._item;
   }
 
  public:
@@ -325,14 +668,37 @@ class Cache : public CacheThread {
    * @param enable enable if true, disable if false
    * @param enable
    */
-  void enable(bool enable) {
-    std::scoped_lock lock(_mutex);
-    _enable = enable;
+  void enable(bool enable) { _enable = enable; }
+
+  /**
+   * Sets the maximum number of bytes held by the cache
+   *
+   * @param budget the new budget, in bytes
+   */
+  void setBudget(uint64_t budget) {
+    _budget = budget;
+    if (_bytes > _budget) {
+      signalBackground();
+    }
   }
 
-  void setSize(unsigned int size) {
-    std::scoped_lock lock(_mutex);
-    _size = size;
+  uint64_t budget() const { return _budget; }
+  uint64_t bytes() const { return _bytes; }
+
+  /**
+   * Retrieves the usage counters, by type of the builder used to look up the
+   * objects
+   *
+   * @param stats  receives the counters
+   */
+  void getStats(tradery::CacheStats& stats) {
+    stats.clear();
+    for (Shard& shard : _shards) {
+      std::scoped_lock lock(shard._mutex);
+      for (const typename TypeStatsMap::value_type& i : shard._stats) {
+        stats[i.first] += i.second;
+      }
+    }
   }
 
   /**
@@ -340,17 +706,23 @@ class Cache : public CacheThread {
    *
    * Defined in the CacheThread abstract base class
    *
+   * It sleeps until an insertion takes the cache over budget, then evicts
+   * items until it is back within budget
+   *
    * @param T
    * @see CacheThread
    */
   void run() {
-    // signal it's running
-    _running = true;
     // run while allowed
-    while (_run) {
-      // every 10 seconds signal that background processing must be done
-      ::Sleep(10);
-      _doBackgroundProcessing = true;
+    while (true) {
+      {
+        std::unique_lock lock(_backgroundMutex);
+        _backgroundCondition.wait(lock, [this]() { return !_run || _overBudget; });
+        if (!_run) {
+          break;
+        }
+        _overBudget = false;
+      }
       doBackgroundProcessing();
     }
     // signal that it has stopped running
@@ -358,6 +730,46 @@ class Cache : public CacheThread {
   }
 };
 
+/**
+ * The unit of the cache sizes passed in by the application - 1 MB
+ */
+constexpr uint64_t CACHE_SIZE_UNIT = 1024 * 1024;
+
+template <>
+class CacheableBytes<SeriesAbstr> {
+ public:
+  static uint64_t bytes(const SeriesAbstr& series) {
+    return sizeof(series) + series.unsyncSize() * sizeof(double);
+  }
+};
+
+template <>
+class CacheableBytes<tradery::BarsBase> {
+ public:
+  // a bar has 6 double values, the time and a pointer to extra info
+  static constexpr size_t BAR_BYTES = 6 * sizeof(double) + sizeof(tradery::DateTime) + sizeof(void*);
+
+  static uint64_t bytes(const tradery::BarsBase& data) { return sizeof(data) + data.size() * BAR_BYTES; }
+};
+
+template <>
+class CacheableBytes<tradery::Synchronizer> {
+ public:
+  // a synchronizer keeps the time series of its reference bars alive, which
+  // is counted in full, although it is shared with the reference bars while
+  // they are still in use
+  static uint64_t bytes(const tradery::Synchronizer& synchronizer) {
+    return sizeof(synchronizer) + synchronizer.size() * sizeof(int) + synchronizer.timeSeries().size() * sizeof(tradery::DateTime);
+  }
+};
+
+// CacheableBytes<Panel> is in Panel.cpp, the only place panels are cached
+namespace tradery {
+class Panel;
+}
+
 // class SeriesAbstr;
-using DataCache = Cache<const tradery::DataCollection>;
+using DataCache = Cache<tradery::BarsBase>;
 using SeriesCache = Cache<SeriesAbstr>;
+using SynchronizerCache = Cache<tradery::Synchronizer>;
+using PanelCache = Cache<tradery::Panel>;
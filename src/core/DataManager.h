@@ -17,6 +17,7 @@
 #pragma once
 
 #include <mutex>
+#include "bars.h"
 
 template <class T>
 class DataCacheable : public Cacheable<T> {
@@ -24,7 +25,7 @@ class DataCacheable : public Cacheable<T> {
   const std::string _stamp;
 
  public:
-  DataCacheable(T* t, const Id& id, const std::string& stamp)
+  DataCacheable(std::shared_ptr<T> t, const Id& id, const std::string& stamp)
       : Cacheable<T>(t, id), _stamp(stamp) {}
 
   const std::string& stamp() const { return _stamp; }
@@ -71,7 +72,18 @@ class DataManager : public DataRequester {
    * @param enable enable caching if true, disable caching if false
    */
   virtual void enableCaching(bool enable) = 0;
+  /**
+   * Sets the data cache memory budget
+   *
+   * @param size the budget in MB
+   */
   virtual void setCacheSize(unsigned int size) = 0;
+  /**
+   * Retrieves the data cache usage counters
+   *
+   * @param stats  receives the counters
+   */
+  virtual void getCacheStats(tradery::CacheStats& stats) = 0;
 };
 
 /**
@@ -109,7 +121,7 @@ class DataManagerImpl : public DataManager {
 
  public:
   DataManagerImpl::DataManagerImpl(unsigned int cacheSize)
-      : _cache(cacheSize, true) {}
+      : _cache(cacheSize * CACHE_SIZE_UNIT, true) {}
 
   DataManagerImpl::~DataManagerImpl() override {
     // make sure we have unregistered as many as we have registered
@@ -177,9 +189,7 @@ class DataManagerImpl : public DataManager {
 
    private:
     static Id calculateId(const DataInfo* dataInfo, DateTimeRangePtr range) {
-      Id id = dataInfo->id();
-      if (range) id += range->getId();
-      return id;
+      return Id::make("data", dataInfo->dataSource()->id().str(), dataInfo->symbol().symbol(), range ? range->getId() : std::string());
     }
 
    public:
@@ -190,16 +200,8 @@ class DataManagerImpl : public DataManager {
           _id(calculateId(dataInfo, range)) {}
 
     std::shared_ptr<Cacheable<T> > make() const override {
-      // put this temporarily into a auto_ptr just in case there is an exception
       const DataSource::DataXPtr b(_dataSource->getData(_dataInfo, _range));
-      if (b->getSize() == 0) {
-        // TODO: add range to the exception
-        throw DataSourceException(DATA_ERROR, "No data available in the requested range for symbol: \""s +
-          _dataInfo->symbol().symbol() + "\"", _dataSource->name());
-      }
-      else {
-        return std::make_shared<DataCacheable<T>>(b->releaseDataCollection(), id(), b->getStamp());
-      }
+      return std::make_shared<DataCacheable<T>>(b->getDataCollection(), id(), b->getStamp());
     }
 
     const Id& id() const override { return _id; }
@@ -216,35 +218,135 @@ class DataManagerImpl : public DataManager {
     }
   };
 
-  using MakeData = MakeDataX<const DataCollection>;
-
-  // TODO: this is just a placeholder method - it returns a Bars object given
-  // some string (I don't know what the string is yet)
-  // change it so it returns a better type and it takes the right argument
-  DataManagedPtr getData(const DataInfo* di,
-                         DateTimeRangePtr range) {
-    /*    Lock lock( _mutex );
-
-        //TODO: the id is the symbol name for testing purposes, but should be a
-       unique string calculated from all the
-        // available data, including date and time etc
-
-        // bars are not in the cache
-        DSMap::iterator i = _dataSources.find( di ->dataSourceId() );
-        if ( i != _dataSources.end() )
-        {
-          const DataSource* ds = (*i).second->get();
-          return _cache.findAndAdd( MakeData( di, ds, range ) );
-        }
-        else
-        {
-          // data source was not registered
-          throw DataSourceException( DATA_SOURCE_NOT_REGISTERED_ERROR, "Data
-       source not registered: ", di->dataSourceId() );
-        }
-            */
-    return 0;
+  using MakeData = MakeDataX<BarsBase>;
+
+  /**
+   * A range of the full history of a symbol, and the full history bars it was
+   * made from
+   */
+  class RangeCacheable : public Cacheable<BarsBase> {
+   private:
+    const std::weak_ptr<BarsBase> _source;
+
+   public:
+    RangeCacheable(std::shared_ptr<BarsBase> bars, const Id& id, std::shared_ptr<BarsBase> source)
+        : Cacheable<BarsBase>(bars, id), _source(source) {}
+
+    bool madeFrom(std::shared_ptr<BarsBase> source) const { return _source.lock() == source; }
+  };
+
+  /**
+   * Makes the bars in a range from the full history of the symbol, already
+   * loaded, instead of loading them again from the data source
+   *
+   * If the range contains all the bars, the full history bars are returned as
+   * they are, and if it contains none, the bars are empty. The range is consistent as long as the full history it was made
+   * from is still the one in the cache
+   */
+  class MakeRangeData : public CacheableBuilder<BarsBase> {
+   private:
+    const DataInfo* _dataInfo;
+    std::shared_ptr<BarsBase> _bars;
+    DateTimeRangePtr _range;
+    const Id _id;
+
+   public:
+    MakeRangeData(const DataInfo* dataInfo, std::shared_ptr<BarsBase> bars, DateTimeRangePtr range)
+        : _dataInfo(dataInfo),
+          _bars(bars),
+          _range(range),
+          _id(Id::make("range", dataInfo->dataSource()->id().str(), dataInfo->symbol().symbol(), range->getId())) {
+      assert(range);
+    }
+
+    std::shared_ptr<Cacheable<BarsBase> > make() const override {
+      const BarsImpl& bars = dynamic_cast<const BarsImpl&>(*_bars);
+      const auto [first, last] = bars.find(*_range);
+      if (first == 0 && last == bars.unsyncSize()) {
+        return std::make_shared<RangeCacheable>(_bars, id(), _bars);
+      }
+      // a range with no bars makes empty bars, as loading the range from the
+      // data source does
+      const size_t count = first < last ? last - first : 0;
+      return std::make_shared<RangeCacheable>(std::make_shared<BarsImpl>(bars, first, count, _dataInfo->dataSource()->name(), _range), id(), _bars);
+    }
+
+    const Id& id() const override { return _id; }
+
+    bool isConsistent(const Cacheable<BarsBase>& cacheable) const override {
+      const RangeCacheable* range = dynamic_cast<const RangeCacheable*>(&cacheable);
+      return range != 0 && range->madeFrom(_bars);
+    }
+  };
+
+  /**
+   * Returns the data for dataInfo, loading it from its data source only if it
+   * is not already in the cache, or if the cached copy is no longer
+   * consistent with the source, as reported by DataSource::isConsistent
+   *
+   * The bars in a range are made from the full history of the symbol (see
+   * MakeRangeData) if it is already in the cache, or if the range has most of
+   * it (see DataSource::rangeFraction), so loading the same symbol for
+   * different ranges, for example with different lead-in periods, parses the
+   * data only once. A shorter range of a symbol not yet loaded is loaded on
+   * its own, which lets the data source read only that part of the data (for
+   * example with a BarsIndex)
+   *
+   * Concurrent requests for the same data load it only once (see
+   * Cache::findAndAdd), so the scheduler, the prefetcher and the session
+   * statistics share the same loaded bars. Each request returns its own copy
+   * of the cached bars, so synchronizing or changing them doesn't affect the
+   * other requesters
+   */
+  DataManagedPtr getData(const DataInfo* dataInfo, DateTimeRangePtr range) override {
+    assert(dataInfo != 0);
+    assert(dataInfo->dataSource() != 0);
+
+    if (range && !fromFullHistory(dataInfo, *range)) {
+      return copy(_cache.findAndAdd(MakeData(dataInfo, dataInfo->dataSource(), range)));
+    }
+
+    BarsPtr bars;
+    try {
+      bars = _cache.findAndAdd(MakeData(dataInfo, dataInfo->dataSource(), DateTimeRangePtr()));
+    }
+    catch (const BarException&) {
+      // with fatal error handling, an invalid bar outside of the range must
+      // not prevent loading the range
+      if (!range) {
+        throw;
+      }
+      return copy(_cache.findAndAdd(MakeData(dataInfo, dataInfo->dataSource(), range)));
+    }
+
+    return copy(range ? _cache.findAndAdd(MakeRangeData(dataInfo, bars, range)) : bars);
+  }
+
+ private:
+  // the part of the history of a symbol a range must have to be made from the
+  // full history when that is not already loaded
+  static constexpr double FULL_HISTORY_FRACTION = 0.5;
+
+  // whether to make the bars in a range from the full history of the symbol
+  // rather than loading only the range: the full history must be cached, or
+  // the range must have most of it, or the data source can't tell
+  bool fromFullHistory(const DataInfo* dataInfo, const DateTimeRange& range) {
+    if (_cache.find(MakeData(dataInfo, dataInfo->dataSource(), DateTimeRangePtr()).id())) {
+      return true;
+    }
+    const double fraction = dataInfo->dataSource()->rangeFraction(dataInfo, range);
+    return fraction < 0 || fraction >= FULL_HISTORY_FRACTION;
   }
 
-  void setCacheSize(unsigned int size) override { _cache.setSize(size); }
+  // each caller gets its own copy of the cached bars, which it can
+  // synchronize and change (see BarsImpl(const BarsImpl&))
+  static BarsPtr copy(BarsPtr bars) {
+    const BarsImpl* impl = dynamic_cast<const BarsImpl*>(bars.get());
+    return impl != 0 ? std::make_shared<BarsImpl>(*impl) : bars;
+  }
+
+ public:
+
+  void setCacheSize(unsigned int size) override { _cache.setBudget(size * CACHE_SIZE_UNIT); }
+  void getCacheStats(tradery::CacheStats& stats) override { _cache.getStats(stats); }
 };
\ No newline at end of file
@@ -0,0 +1,232 @@
+/*
+   Copyright (C) 2018-2020 Adrian Michel
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#pragma once
+
+#include "structuredexception.h"
+#include "WorkerPool.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+/** @file
+ *  \brief Background loading of the data for the next symbols of a run
+ */
+extern DataManager* _dataManager;
+
+/**
+ * The data for one symbol, loaded by a DataPrefetcher
+ *
+ * If loading the data failed, the exception is kept and rethrown by data(), so
+ * it is handled by the runnable thread exactly as if it had loaded the data
+ * itself
+ */
+class PrefetchedData {
+  friend class DataPrefetcher;
+
+ private:
+  DataInfoConstPtr _dataInfo;
+  BarsPtr _data;
+  std::exception_ptr _error;
+  double _duration;
+  bool _ready;
+
+ public:
+  PrefetchedData(DataInfoConstPtr dataInfo) : _dataInfo(dataInfo), _duration(0), _ready(false) {}
+
+  DataInfoConstPtr dataInfo() const { return _dataInfo; }
+
+  /**
+   * The data, or rethrows the exception thrown while loading it
+   */
+  BarsPtr data() const {
+    if (_error) {
+      std::rethrow_exception(_error);
+    }
+    return _data;
+  }
+
+  /**
+   * How long loading the data took, in seconds
+   */
+  double duration() const { return _duration; }
+
+  /**
+   * Loads the data on the calling thread, keeping the exception if loading
+   * fails
+   */
+  void load(DateTimeRangePtr range) {
+    Timer timer;
+    try {
+      _data = _dataManager->getData(_dataInfo.get(), range);
+    }
+    catch (...) {
+      _error = std::current_exception();
+    }
+    _duration = timer.elapsed();
+  }
+};
+
+using PrefetchedDataPtr = std::shared_ptr<PrefetchedData>;
+
+/**
+ * Loads the data for the symbols of a DataInfoIterator on worker pool tasks,
+ * ahead of the runnables that use it, so loading and parsing files overlaps
+ * with running the systems.
+ *
+ * At most depth symbols are loaded or waiting to be taken at any time, which
+ * bounds the memory used by the prefetched data. The symbols are returned in
+ * the order of the iterator, and each symbol is returned once, so runnables
+ * sharing an iterator can share its prefetcher.
+ *
+ * @see Scheduler::setPrefetch
+ */
+class DataPrefetcher {
+  OBJ_COUNTER(DataPrefetcher)
+ private:
+  DataInfoIteratorPtr _symbols;
+  DateTimeRangePtr _range;
+  const size_t _depth;
+  ThreadInitializer* _threadInitializer;
+
+  std::mutex _mutex;
+  // signaled when a symbol has been loaded or there are no more symbols
+  std::condition_variable _loaded;
+  // signaled when a symbol has been taken or the prefetcher is stopped
+  std::condition_variable _taken;
+  // the symbols loaded or being loaded, in the order of the iterator
+  std::deque<PrefetchedDataPtr> _queue;
+  // the iterator has no more symbols
+  bool _done;
+  bool _stopped;
+  // the loading tasks, run by the worker pool
+  TaskGroup _threads;
+
+ private:
+  void load() {
+    // for the whole run, see ThreadInit
+    ThreadInit init(_threadInitializer);
+    StructuredException::install();
+
+    for (;;) {
+      PrefetchedDataPtr next;
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _taken.wait(lock, [this]() -> bool { return _stopped || _done || _queue.size() < _depth; });
+        if (_stopped || _done) {
+          break;
+        }
+
+        try {
+          DataInfoConstPtr si = _symbols->getNext();
+          if (si.get() == 0) {
+            _done = true;
+            _loaded.notify_all();
+            break;
+          }
+          next = std::make_shared<PrefetchedData>(si);
+        }
+        catch (...) {
+          // an invalid symbol, returned to the runnable thread as the last
+          // symbol
+          next = std::make_shared<PrefetchedData>(DataInfoConstPtr());
+          next->_error = std::current_exception();
+          next->_ready = true;
+          _done = true;
+          _queue.push_back(next);
+          _loaded.notify_all();
+          break;
+        }
+        _queue.push_back(next);
+      }
+
+      next->load(_range);
+
+      {
+        std::scoped_lock lock(_mutex);
+        next->_ready = true;
+      }
+      _loaded.notify_all();
+    }
+  }
+
+ public:
+  /**
+   * Starts loading
+   *
+   * @param symbols  the symbols to load, shared with the runnables, which take
+   *                 them from the prefetcher instead
+   * @param range    the range to load
+   * @param depth    the maximum number of symbols loaded ahead
+   * @param threads  the number of threads loading symbols
+   * @param threadInitializer
+   *                 initializes the loading threads, as the runnable threads
+   */
+  DataPrefetcher(DataInfoIteratorPtr symbols, DateTimeRangePtr range, size_t depth, unsigned int threads, ThreadInitializer* threadInitializer)
+      : _symbols(symbols), _range(range), _depth((std::max)(depth, (size_t)1)), _threadInitializer(threadInitializer), _done(false), _stopped(false), _threads(_workerPool) {
+    assert(_symbols);
+    for (unsigned int n = 0; n < (std::max)(threads, 1u); ++n) {
+      _threads.run([this]() { load(); });
+    }
+  }
+
+  ~DataPrefetcher() { stop(); }
+
+  /**
+   * Returns the next symbol and its data, waiting for it to be loaded if
+   * necessary, or 0 if there are no more symbols
+   *
+   * @exception DataInfoException
+   *                   or any other exception thrown by the symbols iterator
+   */
+  PrefetchedDataPtr getNext() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _loaded.wait(lock, [this]() -> bool { return _stopped || (_queue.empty() ? _done : _queue.front()->_ready); });
+    if (_queue.empty() || !_queue.front()->_ready) {
+      return 0;
+    }
+
+    PrefetchedDataPtr next = _queue.front();
+    _queue.pop_front();
+    _taken.notify_all();
+    lock.unlock();
+
+    if (!next->_dataInfo) {
+      std::rethrow_exception(next->_error);
+    }
+    return next;
+  }
+
+  /**
+   * Stops loading and waits for the loading threads to end. Symbols not taken
+   * yet are dropped
+   */
+  void stop() {
+    {
+      std::scoped_lock lock(_mutex);
+      _stopped = true;
+    }
+    _taken.notify_all();
+    _loaded.notify_all();
+    _threads.wait();
+  }
+};
+
+using DataPrefetcherPtr = std::shared_ptr<DataPrefetcher>;
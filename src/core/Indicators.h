@@ -16,6 +16,9 @@
 
 #pragma once
 
+#include <serieskernels.h>
+#include <deque>
+
 using CacheableSeries = Cacheable<SeriesAbstr>;
 using CacheableSeriesPtr = std::shared_ptr<CacheableSeries>;
 
@@ -41,13 +44,65 @@ template <class T> class CacheableBuilderY : public CacheableBuilder<T> {
 
 using CacheableBuilderX = CacheableBuilderY<SeriesAbstr>;
 
+/**
+ * Id of a series known only through its abstract interface. Series that are
+ * not Ideable can't be identified, so anything calculated from them gets a
+ * unique id and will never be shared
+ */
+inline Id seriesId(const SeriesAbstr& series) {
+  const Ideable* ideable = dynamic_cast<const Ideable*>(&series);
+  return ideable != nullptr ? ideable->getId() : Id::unique();
+}
+
+/**
+ * Id of a series calculated from a series synchronized with synchronizer,
+ * given the id it would have if calculated from the unsynchronized series.
+ *
+ * A calculated series carries the synchronizer of the series it is calculated
+ * from, so it can only be shared with callers that use the same synchronizer.
+ * Each requester of a symbol gets a copy of its bars with the same ids (see
+ * BarsImpl(const BarsImpl&)), and can synchronize it to different reference
+ * bars.
+ *
+ * The synchronizer is identified by its address, which no other synchronizer
+ * can have while a cached series keeps it alive
+ */
+inline Id synchronizedId(const Id& id, const Synchronizer::SynchronizerPtr& synchronizer) {
+  return synchronizer ? Id::make("synchronized", id, (uint64_t)(uintptr_t)synchronizer.get()) : id;
+}
+
+extern SeriesCache* _cache;
+
+/**
+ * If series extends another series (see SeriesImpl::Prefix), looks up in the
+ * cache the same indicator calculated on the other series. There is nothing
+ * to reuse unless the series cache is enabled (see enableSeriesCache).
+ *
+ * @param series the series the indicator is calculated on
+ * @param makeId makes the id of the indicator from the id of the series it is
+ *               calculated on
+ * @return the cached indicator and the number of its values that can be
+ *         reused, or null and 0 if there is nothing to reuse
+ */
+template <class T, class MakeId>
+std::pair<std::shared_ptr<const T>, size_t> findExtended(const SeriesImpl& series, MakeId makeId) {
+  const std::optional<SeriesImpl::Prefix>& prefix = series.prefix();
+  if (prefix && prefix->size <= series.unsyncSize()) {
+    std::shared_ptr<const T> base = std::dynamic_pointer_cast<const T>(_cache->find(makeId(prefix->id)));
+    if (base && base->unsyncSize() >= prefix->size) {
+      return {base, prefix->size};
+    }
+  }
+  return {nullptr, 0};
+}
+
 class MakeFromSeries : public CacheableBuilderX {
  private:
   const SeriesImpl& _series;
 
  protected:
   MakeFromSeries(const SeriesImpl& series, const Id& id)
-      : _series(series), CacheableBuilderX(id) {}
+      : _series(series), CacheableBuilderX(synchronizedId(id, series.synchronizer())) {}
 
   const SeriesImpl& getSeries() const { return _series; }
 };
@@ -58,23 +113,41 @@ class MakeFromSeriesWithOnePeriod : public MakeFromSeries {
 
  public:
   MakeFromSeriesWithOnePeriod(const SeriesImpl& series, unsigned int period, const std::string& name)
-      : MakeFromSeries(series, calculateId(series, period, name)), _period(period) {}
+      : MakeFromSeries(series, calculateId(series.getId(), period, name)), _period(period) {}
 
  protected:
-  const Id calculateId(const SeriesImpl& series, unsigned int period, const std::string& name) {
-    return Id( tradery::format( series.getId(), " - ", name, " - ", period));
+  static const Id calculateId(const Id& seriesId, unsigned int period, const std::string& name) {
+    return Id::make(name.c_str(), seriesId, period);
   }
 
   unsigned int getPeriod() const { return _period; }
 };
 
+/**
+ * Adds a series calculated in a batch to the cache, under the id of the series
+ * made by Builder, so it is found when the series is looked up on its own
+ */
+template <class Builder>
+class MakeBatchSeries : public CacheableBuilderX {
+ private:
+  mutable std::unique_ptr<SeriesImpl> _series;
+
+ public:
+  MakeBatchSeries(std::unique_ptr<SeriesImpl>&& series)
+      : CacheableBuilderX(series->getId()), _series(std::move(series)) {}
+
+  CacheableSeriesPtr make() const override {
+    return std::make_shared<IndicatorCacheable>(_series.release(), id());
+  }
+};
+
 class MakeFromBars : public CacheableBuilderX {
  private:
   const BarsImpl& _bars;
 
  protected:
   MakeFromBars(const BarsImpl& bars, const Id& id)
-      : _bars(bars), CacheableBuilderX(id) {}
+      : _bars(bars), CacheableBuilderX(synchronizedId(id, bars.synchronizer())) {}
 
   const BarsImpl& getBars() const { return _bars; }
 };
@@ -89,12 +162,258 @@ class MakeFromBarsWithOnePeriod : public MakeFromBars {
 
  protected:
   const Id calculateId(const BarsImpl& bars, unsigned int period, const std::string& name) {
-    return Id(tradery::format( bars.getId(), " - ", name, " - ", period));
+    return Id::make(name.c_str(), bars.getId(), period);
   }
 
   unsigned int getPeriod() const { return _period; }
 };
 
+/**
+ * Calculations of the same indicator for several periods at once.
+ *
+ * The values for each period are calculated with exactly the same operations,
+ * in the same order, as when calculated on their own (which is a batch of one
+ * period), so the results are identical and can be shared through the cache.
+ * The sums over the first values are shared by all periods, and the periods
+ * are calculated in groups, so their recurrences, each dependent on its
+ * previous value, run in parallel while the input is read once per group.
+ *
+ * out[i] receives the values for periods[i], and must have room for size
+ * values. Only the values from period - 1 on are set
+ */
+constexpr size_t BATCH_GROUP_SIZE = 8;
+
+/**
+ * the order in which to process the periods - increasing, so the initial sums
+ * can be shared
+ */
+inline std::vector<size_t> batchOrder(const unsigned int* periods, size_t count) {
+  std::vector<size_t> order(count);
+  for (size_t n = 0; n < count; ++n) {
+    order[n] = n;
+  }
+  std::sort(order.begin(), order.end(), [periods](size_t a, size_t b) { return periods[a] < periods[b]; });
+  return order;
+}
+
+/**
+ * Simple moving averages. Requires 0 < periods[i] < size
+ */
+inline void calculateSMAs(const double* v, size_t size, const unsigned int* periods, double* const* out, size_t count) {
+  const std::vector<size_t> order(batchOrder(periods, count));
+
+  double f = 0;
+  size_t n = 0;
+  for (size_t i : order) {
+    for (; n < periods[i]; n++) {
+      f += v[n];
+    }
+    out[i][periods[i] - 1] = f / (double)periods[i];
+  }
+
+  for (size_t group = 0; group < count; group += BATCH_GROUP_SIZE) {
+    const size_t groupSize = (std::min)(BATCH_GROUP_SIZE, count - group);
+    unsigned int p[BATCH_GROUP_SIZE];
+    double* o[BATCH_GROUP_SIZE];
+    for (size_t j = 0; j < groupSize; j++) {
+      p[j] = periods[order[group + j]];
+      o[j] = out[order[group + j]];
+    }
+
+    for (size_t n = p[0]; n < size; n++) {
+      for (size_t j = 0; j < groupSize; j++) {
+        if (n >= p[j]) {
+          o[j][n] = o[j][n - 1] + (v[n] - v[n - p[j]]) / (double)p[j];
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Exponential moving averages, with exps[i] the exponent for periods[i].
+ * Requires 0 < periods[i] < size
+ */
+inline void calculateEMAs(const double* v, size_t size, const unsigned int* periods, const double* exps, double* const* out, size_t count) {
+  const std::vector<size_t> order(batchOrder(periods, count));
+
+  double f = 0;
+  size_t n = 0;
+  for (size_t i : order) {
+    for (; n < periods[i]; n++) {
+      f += v[n];
+    }
+    out[i][periods[i] - 1] = f / (double)periods[i];
+  }
+
+  for (size_t group = 0; group < count; group += BATCH_GROUP_SIZE) {
+    const size_t groupSize = (std::min)(BATCH_GROUP_SIZE, count - group);
+    unsigned int p[BATCH_GROUP_SIZE];
+    double e[BATCH_GROUP_SIZE];
+    double* o[BATCH_GROUP_SIZE];
+    for (size_t j = 0; j < groupSize; j++) {
+      p[j] = periods[order[group + j]];
+      e[j] = exps[order[group + j]];
+      o[j] = out[order[group + j]];
+    }
+
+    for (size_t n = p[0]; n < size; n++) {
+      for (size_t j = 0; j < groupSize; j++) {
+        if (n >= p[j]) {
+          o[j][n] = e[j] * (v[n] - o[j][n - 1]) + o[j][n - 1];
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Extends a simple moving average calculated up to from, to size values.
+ * Requires 0 < period < from, as for the values up to from
+ */
+inline void extendSMA(const double* v, size_t from, size_t size, unsigned int period, double* out) {
+  for (size_t n = from; n < size; n++) {
+    out[n] = out[n - 1] + (v[n] - v[n - period]) / (double)period;
+  }
+}
+
+/**
+ * Extends an exponential moving average calculated up to from, to size values.
+ * Requires 0 < period < from, as for the values up to from
+ */
+inline void extendEMA(const double* v, size_t from, size_t size, unsigned int period, double exp, double* out) {
+  for (size_t n = from; n < size; n++) {
+    out[n] = exp * (v[n] - out[n - 1]) + out[n - 1];
+  }
+}
+
+/**
+ * The standard deviation over the period ending at n. total1 and total2 are
+ * the sums of the previous period - 1 values and of their squares, and are
+ * moved forward by one value
+ */
+inline double stdDevStep(const double* v, size_t n, unsigned int period, double nbDev, double& total1, double& total2) {
+  total1 += v[n];
+  total2 += v[n] * v[n];
+  const double mean1 = total1 / period;
+  const double mean2 = total2 / period;
+  const double trailing = v[n + 1 - period];
+  total1 -= trailing;
+  total2 -= trailing * trailing;
+  const double variance = mean2 - mean1 * mean1;
+  return variance < 0.00000001 ? 0.0 : (nbDev != 1.0 ? sqrt(variance) * nbDev : sqrt(variance));
+}
+
+/**
+ * Standard deviations, calculated as TA_STDDEV does (the variance from the
+ * running sums of the values and of their squares), so the results are the
+ * same. Requires 1 < periods[i] <= size
+ *
+ * If totals is not null, totals[2 * i] and totals[2 * i + 1] receive the sums
+ * left after the last value for periods[i], which extendStdDev starts from
+ */
+inline void calculateStdDevs(const double* v, size_t size, const unsigned int* periods, double nbDev, double* const* out, size_t count, double* totals = nullptr) {
+  const std::vector<size_t> order(batchOrder(periods, count));
+
+  // the sums of the first period - 1 values, and of their squares
+  std::vector<double> initialTotal1(count);
+  std::vector<double> initialTotal2(count);
+  double total1 = 0;
+  double total2 = 0;
+  size_t n = 0;
+  for (size_t i : order) {
+    for (; n < periods[i] - 1; n++) {
+      total1 += v[n];
+      total2 += v[n] * v[n];
+    }
+    initialTotal1[i] = total1;
+    initialTotal2[i] = total2;
+  }
+
+  for (size_t group = 0; group < count; group += BATCH_GROUP_SIZE) {
+    const size_t groupSize = (std::min)(BATCH_GROUP_SIZE, count - group);
+    unsigned int p[BATCH_GROUP_SIZE];
+    double t1[BATCH_GROUP_SIZE];
+    double t2[BATCH_GROUP_SIZE];
+    double* o[BATCH_GROUP_SIZE];
+    for (size_t j = 0; j < groupSize; j++) {
+      p[j] = periods[order[group + j]];
+      t1[j] = initialTotal1[order[group + j]];
+      t2[j] = initialTotal2[order[group + j]];
+      o[j] = out[order[group + j]];
+    }
+
+    for (size_t n = p[0] - 1; n < size; n++) {
+      for (size_t j = 0; j < groupSize; j++) {
+        if (n + 1 >= p[j]) {
+          o[j][n] = stdDevStep(v, n, p[j], nbDev, t1[j], t2[j]);
+        }
+      }
+    }
+
+    if (totals != nullptr) {
+      for (size_t j = 0; j < groupSize; j++) {
+        totals[2 * order[group + j]] = t1[j];
+        totals[2 * order[group + j] + 1] = t2[j];
+      }
+    }
+  }
+}
+
+/**
+ * Extends a standard deviation calculated up to from, to size values, starting
+ * from the sums left by calculateStdDevs or by a previous extension. Requires
+ * 1 < period <= from
+ */
+inline void extendStdDev(const double* v, size_t from, size_t size, unsigned int period, double nbDev, double* out, double& total1, double& total2) {
+  for (size_t n = from; n < size; n++) {
+    out[n] = stdDevStep(v, n, period, nbDev, total1, total2);
+  }
+}
+
+/**
+ * Moving minimums (if better is std::less) or maximums (std::greater), in one
+ * pass for all periods.
+ *
+ * A single deque holds the positions in the window of the longest period
+ * whose values are better than all the values after them, so the values at
+ * these positions go from best to worst. The value for a period is that at
+ * the first position in the deque still within its window.
+ *
+ * Each value is one of the input values, so the results are the same as those
+ * of TA_MIN and TA_MAX. Requires 1 < periods[i] <= size
+ */
+template <class Better>
+void calculateExtremes(const double* v, size_t size, const unsigned int* periods, double* const* out, size_t count, Better better) {
+  const unsigned int longest = *std::max_element(periods, periods + count);
+
+  std::deque<size_t> positions;
+  for (size_t n = 0; n < size; n++) {
+    while (!positions.empty() && !better(v[positions.back()], v[n])) {
+      positions.pop_back();
+    }
+    positions.push_back(n);
+    if (positions.front() + longest <= n) {
+      positions.pop_front();
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      if (n + 1 >= periods[i]) {
+        const size_t start = n + 1 - periods[i];
+        out[i][n] = v[*std::lower_bound(positions.begin(), positions.end(), start)];
+      }
+    }
+  }
+}
+
+inline void calculateMins(const double* v, size_t size, const unsigned int* periods, double* const* out, size_t count) {
+  calculateExtremes(v, size, periods, out, count, std::less<double>());
+}
+
+inline void calculateMaxs(const double* v, size_t size, const unsigned int* periods, double* const* out, size_t count) {
+  calculateExtremes(v, size, periods, out, count, std::greater<double>());
+}
+
 using TA_LOOKBACK_INT = int (*)(int);
 using TA_FUNC1 = TA_RetCode (*)(int, int, const double[], int, int*, int*, double[]);
 using TA_FUNC1Int = TA_RetCode (*)(int, int, const double[], int, int*, int*, int[]);
@@ -133,6 +452,21 @@ template <TA_FUNC1Int T> class TAFunc1IntConstants {
 template <> const char* TAFunc1IntConstants<TA_MAXINDEX>::_id = "Max index";
 template <> const char* TAFunc1IntConstants<TA_MININDEX>::_id = "Min index";
 
+/**
+ * Whether each value of the function depends only on the input values in its
+ * lookback window, so the values for data with bars appended can be calculated
+ * starting where the values for the shorter data end, with the same results.
+ *
+ * Functions with running state (moving averages, RSI etc) depend on all the
+ * values before, and are calculated again from the start
+ */
+inline bool isWindowFunction(TA_FUNC1 f) {
+  return f == TA_MAX || f == TA_MIN || f == TA_MIDPOINT || f == TA_MOM || f == TA_ROC || f == TA_ROCP || f == TA_ROCR || f == TA_ROCR100 ||
+         f == TA_LINEARREG || f == TA_LINEARREG_SLOPE || f == TA_LINEARREG_ANGLE || f == TA_LINEARREG_INTERCEPT || f == TA_TSF;
+}
+
+inline bool isWindowFunction(TA_FUNC1Int f) { return f == TA_MAXINDEX || f == TA_MININDEX; }
+
 template <TA_LOOKBACK_INT TA_LB, TA_FUNC1 TA_FUNC> class MakeSeriesTAFunc1 : public MakeFromSeriesWithOnePeriod {
  private:
   /**
@@ -142,12 +476,17 @@ template <TA_LOOKBACK_INT TA_LB, TA_FUNC1 TA_FUNC> class MakeSeriesTAFunc1 : pub
   class XSeries : public SeriesImpl {
    public:
     // TODO: enforce that T is of type series using function_requires
-    XSeries(const SeriesImpl& series, unsigned int period, const Id& id)
+    XSeries(const SeriesImpl& series, unsigned int period, const Id& id, const SeriesImpl* base, size_t baseSize)
         : SeriesImpl(series.unsyncSize(), series.synchronizer(), id) {
-      if (unsyncSize() > (unsigned int)TA_LB(period)) {
+      size_t start = (unsigned int)TA_LB(period);
+      if (base != nullptr && baseSize > start) {
+        extend(*base, baseSize);
+        start = baseSize;
+      }
+      if (unsyncSize() > start) {
         int begIdx;
         int nbElement;
-        TA_FUNC(0, unsyncSize() - 1, series.getArray(), period, &begIdx, &nbElement, &at(TA_LB(period)));
+        TA_FUNC((int)start, unsyncSize() - 1, series.getArray(), period, &begIdx, &nbElement, &at(start));
       }
     }
   };
@@ -157,7 +496,11 @@ template <TA_LOOKBACK_INT TA_LB, TA_FUNC1 TA_FUNC> class MakeSeriesTAFunc1 : pub
       : MakeFromSeriesWithOnePeriod(series, period, TAFunc1Constants<TA_FUNC>::_id) {}
 
   virtual CacheableSeriesPtr make() const {
-    return std::make_shared< IndicatorCacheable >(new XSeries(getSeries(), getPeriod(), id()), id());
+    std::pair<std::shared_ptr<const SeriesImpl>, size_t> base;
+    if (isWindowFunction(TA_FUNC)) {
+      base = findExtended<SeriesImpl>(getSeries(), [this](const Id& seriesId) { return calculateId(seriesId, getPeriod(), TAFunc1Constants<TA_FUNC>::_id); });
+    }
+    return std::make_shared< IndicatorCacheable >(new XSeries(getSeries(), getPeriod(), id(), base.first.get(), base.second), id());
   }
 };
 
@@ -171,16 +514,21 @@ class MakeSeriesTAFunc1Int : public MakeFromSeriesWithOnePeriod {
   class XSeries : public SeriesImpl {
    public:
     // TODO: enforce that T is of type series using function_requires
-    XSeries(const SeriesImpl& series, unsigned int period, const Id& id)
+    XSeries(const SeriesImpl& series, unsigned int period, const Id& id, const SeriesImpl* base, size_t baseSize)
         : SeriesImpl(series.unsyncSize(), series.synchronizer(), id) {
-      if (unsyncSize() > (unsigned int)TA_LB(period)) {
-        vector<int> x(unsyncSize());
+      size_t start = (unsigned int)TA_LB(period);
+      if (base != nullptr && baseSize > start) {
+        extend(*base, baseSize);
+        start = baseSize;
+      }
+      if (unsyncSize() > start) {
+        vector<int> x(unsyncSize() - start);
 
         int begIdx;
         int nbElement;
-        TA_FUNC(0, unsyncSize() - 1, series.getArray(), period, &begIdx, &nbElement, &x.at(TA_LB(period)));
+        TA_FUNC((int)start, unsyncSize() - 1, series.getArray(), period, &begIdx, &nbElement, x.data());
 
-        std::copy(x.begin(), x.end(), _v.begin());
+        std::copy(x.begin(), x.end(), _v.begin() + start);
       }
     }
   };
@@ -190,7 +538,11 @@ class MakeSeriesTAFunc1Int : public MakeFromSeriesWithOnePeriod {
       : MakeFromSeriesWithOnePeriod(series, period, TAFunc1IntConstants<TA_FUNC>::_id) {}
 
   virtual CacheableSeriesPtr make() const {
-    return std::make_shared< IndicatorCacheable >(new XSeries(getSeries(), getPeriod(), id()), id());
+    std::pair<std::shared_ptr<const SeriesImpl>, size_t> base;
+    if (isWindowFunction(TA_FUNC)) {
+      base = findExtended<SeriesImpl>(getSeries(), [this](const Id& seriesId) { return calculateId(seriesId, getPeriod(), TAFunc1IntConstants<TA_FUNC>::_id); });
+    }
+    return std::make_shared< IndicatorCacheable >(new XSeries(getSeries(), getPeriod(), id(), base.first.get(), base.second), id());
   }
 };
 
@@ -221,7 +573,7 @@ class MakeBBandUpperSeries : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series, unsigned int period, double stdDev) {
-    return Id(tradery::format( series.getId(), " - BBand upper - ", period, ", ", stdDev ));
+    return Id::make("BBand upper", series.getId(), period, stdDev);
   }
 
  public:
@@ -258,7 +610,7 @@ class MakeBBandLowerSeries : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series, unsigned int period, double stdDev) {
-    return Id(tradery::format( series.getId(), " - BBand lower - ", period, ", ", stdDev));
+    return Id::make("BBand lower", series.getId(), period, stdDev);
   }
 
  public:
@@ -267,7 +619,7 @@ class MakeBBandLowerSeries : public MakeFromSeries {
         _period(period), _stdDev(stdDev) {}
 
   virtual CacheableSeriesPtr make() const {
-    return std::make_shared< IndicatorCacheable >(new BBandLowerSeries(getSeries(), _period, _stdDev, id()), Id());
+    return std::make_shared< IndicatorCacheable >(new BBandLowerSeries(getSeries(), _period, _stdDev, id()), id());
   }
 };
 
@@ -280,24 +632,16 @@ class MakeEMASeries : public MakeFromSeries {
    public:
     // TODO: enforce that T is of type series using function_requires
 
-    EMASeries(const SeriesAbstr& series, unsigned int period, double exp, const Id& id)
+    EMASeries(const SeriesAbstr& series, unsigned int period, double exp, const Id& id, const SeriesImpl* base, size_t baseSize)
         : SeriesImpl(series.unsyncSize(), series.synchronizer(), id) {
 
-      if (period < unsyncSize()) {
-        double f = 0;
-
-        const std::vector<double>& v(series.getVector());
-
-        // TODO: use std::accumulate
-        unsigned int n = 0;
-        for (; n < period; n++) f += v[n];
-
-        at(period - 1) = f / (double)period;
-
-        for (; n < unsyncSize(); n++) {
-          double x = exp * (v[n] - at(n - 1)) + at(n - 1);
-          at(n) = x;
-        }
+      if (base != nullptr && period > 0 && period < baseSize) {
+        extend(*base, baseSize);
+        extendEMA(series.getArray(), baseSize, unsyncSize(), period, exp, _v.data());
+      }
+      else if (isBatchable(series, period)) {
+        double* out = _v.data();
+        calculateEMAs(series.getArray(), unsyncSize(), &period, &exp, &out, 1);
       }
     }
   };
@@ -307,16 +651,27 @@ class MakeEMASeries : public MakeFromSeries {
   double _exp;
 
  private:
-  static const Id calculateId(const SeriesImpl& series, unsigned int period, double exp) {
-    return Id(tradery::format( series.getId(), " - EMA - ", period, ", ", exp) );
+  static const Id calculateId(const Id& seriesId, unsigned int period, double exp) {
+    return Id::make("EMA", seriesId, period, exp);
   }
 
  public:
+  /**
+   * whether the period can be calculated by calculateEMAs, otherwise the
+   * series is all 0
+   */
+  static bool isBatchable(const SeriesAbstr& series, unsigned int period) {
+    return period > 0 && period < series.unsyncSize();
+  }
+
   MakeEMASeries(const SeriesImpl& series, unsigned int period, double exp)
-      : MakeFromSeries(series, calculateId(series, period, exp)), _period(period), _exp(exp) {}
+      : MakeFromSeries(series, calculateId(series.getId(), period, exp)), _period(period), _exp(exp) {}
 
   CacheableSeriesPtr make() const {
-    return std::make_shared< IndicatorCacheable >( new EMASeries(getSeries(), _period, _exp, id()), id());
+    // the series made by SeriesImpl::EMAs are not EMASeries, so any SeriesImpl will do
+    const std::pair<std::shared_ptr<const SeriesImpl>, size_t> base =
+        findExtended<SeriesImpl>(getSeries(), [this](const Id& seriesId) { return calculateId(seriesId, _period, _exp); });
+    return std::make_shared< IndicatorCacheable >( new EMASeries(getSeries(), _period, _exp, id(), base.first.get(), base.second), id());
   }
 };
 
@@ -344,7 +699,7 @@ class MakeHTTrendlineSeries : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series) {
-    return Id(series.getId() + " - HTTrendline");
+    return Id::make("HTTrendline", series.getId());
   }
 
  public:
@@ -352,7 +707,7 @@ class MakeHTTrendlineSeries : public MakeFromSeries {
       : MakeFromSeries(series, calculateId(series)) {}
 
   CacheableSeriesPtr make() const {
-    return std::make_shared< IndicatorCacheable >(new HTTrendlineSeries(getSeries(), id()), Id());
+    return std::make_shared< IndicatorCacheable >(new HTTrendlineSeries(getSeries(), id()), id());
   }
 };
 
@@ -383,7 +738,7 @@ class MakeMAMASeries : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series, double fastLimit, double slowLimit) {
-    return Id( tradery::format( series.getId(), " - MAMA - ", fastLimit, ", ", slowLimit) );
+    return Id::make("MAMA", series.getId(), fastLimit, slowLimit);
   }
 
  public:
@@ -391,7 +746,7 @@ class MakeMAMASeries : public MakeFromSeries {
       : MakeFromSeries(series, calculateId(series, fastLimit, slowLimit)), _fastLimit(fastLimit), _slowLimit(slowLimit) {}
 
   CacheableSeriesPtr make() const {
-    return std::make_shared< IndicatorCacheable >(new MAMASeries(getSeries(), _fastLimit, _slowLimit, id()), Id());
+    return std::make_shared< IndicatorCacheable >(new MAMASeries(getSeries(), _fastLimit, _slowLimit, id()), id());
   }
 };
 
@@ -421,7 +776,7 @@ class MakeFAMASeries : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series, double fastLimit, double slowLimit) {
-    return Id( tradery::format( series.getId(), " - FAMA - ", fastLimit, ", ", slowLimit) );
+    return Id::make("FAMA", series.getId(), fastLimit, slowLimit);
   }
 
  public:
@@ -512,7 +867,7 @@ class MakeSARSeries : public MakeFromBars {
 
  private:
   static const Id calculateId(const BarsImpl& bars, double acceleration, double maximum) {
-    return Id( tradery::format( bars.getId(), " - SAR - ", acceleration, ", ", maximum) );
+    return Id::make("SAR", bars.getId(), acceleration, maximum);
   }
 
  public:
@@ -532,34 +887,37 @@ class MakeSMASeries : public MakeFromSeriesWithOnePeriod {
   class SMASeries : public SeriesImpl {
    public:
     // TODO: enforce that T is of type series using function_requires
-    SMASeries(const SeriesImpl& series, unsigned int period, const Id& id)
+    SMASeries(const SeriesImpl& series, unsigned int period, const Id& id, const SeriesImpl* base, size_t baseSize)
         : SeriesImpl(series.unsyncSize(), series.synchronizer(), id) {
       // function_requires< SeriesImpl< T > >();
 
-      if (period < unsyncSize()) {
-        double f = 0;
-
-        const std::vector<double>& v(series.getVector());
-
-        // TODO: use std::accumulate
-        unsigned int n = 0;
-        for (; n < period; n++) { f += v[n]; }
-
-        at(period - 1) = f / (double)period;
-
-        for (; n < unsyncSize(); n++) {
-          at(n) = at(n - 1) + (v[n] - v[n - period]) / (double)period;
-        }
+      if (base != nullptr && period > 0 && period < baseSize) {
+        extend(*base, baseSize);
+        extendSMA(series.getArray(), baseSize, unsyncSize(), period, _v.data());
+      }
+      else if (isBatchable(series, period)) {
+        double* out = _v.data();
+        calculateSMAs(series.getArray(), unsyncSize(), &period, &out, 1);
       }
     }
   };
 
  public:
+  /**
+   * whether the period can be calculated by calculateSMAs, otherwise the
+   * series is all 0
+   */
+  static bool isBatchable(const SeriesAbstr& series, unsigned int period) {
+    return period > 0 && period < series.unsyncSize();
+  }
+
   MakeSMASeries(const SeriesImpl& series, unsigned int period)
       : MakeFromSeriesWithOnePeriod(series, period, "SMA") {}
 
   CacheableSeriesPtr make() const {
-    return std::make_shared< IndicatorCacheable >(new SMASeries(getSeries(), getPeriod(), id()), id());
+    const std::pair<std::shared_ptr<const SeriesImpl>, size_t> base =
+        findExtended<SeriesImpl>(getSeries(), [this](const Id& seriesId) { return calculateId(seriesId, getPeriod(), "SMA"); });
+    return std::make_shared< IndicatorCacheable >(new SMASeries(getSeries(), getPeriod(), id(), base.first.get(), base.second), id());
   }
 };
 
@@ -585,7 +943,7 @@ class MakeT3Series : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series, unsigned int period, double vFactor) {
-    return Id( tradery::format(series.getId(), " - T3 - ", period, ", ", vFactor ));
+    return Id::make("T3", series.getId(), period, vFactor);
   }
 
  public:
@@ -639,7 +997,7 @@ class MakeWMASeries : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series, unsigned int period) {
-    return Id(tradery::format(series.getId(), " - WMA - ", period) );
+    return Id::make("WMA", series.getId(), period);
   }
 
  public:
@@ -702,7 +1060,7 @@ class MakeTRSeries : public MakeFromBars {
 
  private:
   static const Id calculateId(const BarsImpl& bars) {
-    return Id(bars.getId() + " - True Range");
+    return Id::make("TR", bars.getId());
   }
 
  public:
@@ -737,7 +1095,7 @@ class MakeAPOSeries : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series, unsigned int fastPeriod, unsigned int slowPeriod, MAType maType) {
-    return Id(tradery::format(series.getId(), " - APO - ", fastPeriod, ", ", slowPeriod, ", ", maType ));
+    return Id::make("APO", series.getId(), fastPeriod, slowPeriod, maType);
   }
 
  public:
@@ -828,7 +1186,7 @@ class MakeMACDSeries : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series, unsigned int fastPeriod, unsigned int slowPeriod, unsigned int signalPeriod) {
-    return Id(tradery::format(series.getId(), " - MACD - ", fastPeriod, ", ", slowPeriod, ", ", signalPeriod));
+    return Id::make("MACD", series.getId(), fastPeriod, slowPeriod, signalPeriod);
   }
 
  public:
@@ -871,7 +1229,7 @@ class MakeMACDSignalSeries : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series, unsigned int fastPeriod, unsigned int slowPeriod, unsigned int signalPeriod) {
-    return Id( tradery::format( series.getId(), " - MACD Signal - ", fastPeriod, ", ", slowPeriod, ", ", signalPeriod ));
+    return Id::make("MACD Signal", series.getId(), fastPeriod, slowPeriod, signalPeriod);
   }
 
  public:
@@ -914,7 +1272,7 @@ class MakeMACDHistSeries : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series, unsigned int fastPeriod, unsigned int slowPeriod, unsigned int signalPeriod) {
-    return Id(tradery::format( series.getId(), " - MACD Hist - ", fastPeriod, ", ", slowPeriod, ", ", signalPeriod ) );
+    return Id::make("MACD Hist", series.getId(), fastPeriod, slowPeriod, signalPeriod);
   }
 
  public:
@@ -960,7 +1318,7 @@ class MakeMACDExtSeries : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series, unsigned int fastPeriod, MAType fastMAType, unsigned int slowPeriod, MAType slowMAType, unsigned int signalPeriod, MAType signalMAType) {
-    return Id( tradery::format( series.getId(), " - MACD Ext- ", fastPeriod, ", ", fastMAType, ", ", slowPeriod, ", ", slowMAType, ", ", signalPeriod, ", ", signalMAType));
+    return Id::make("MACD Ext", series.getId(), fastPeriod, fastMAType, slowPeriod, slowMAType, signalPeriod, signalMAType);
   }
 
  public:
@@ -1012,8 +1370,7 @@ class MakeMACDSignalExtSeries : public MakeFromSeries {
  private:
   static const Id calculateId(const SeriesImpl& series, unsigned int fastPeriod, MAType fastMAType, unsigned int slowPeriod,
                               MAType slowMAType, unsigned int signalPeriod, MAType signalMAType) {
-    return Id(tradery::format( series.getId(), " - MACD Signal Ext - ", fastPeriod, ", ", fastMAType, ", ", slowPeriod,
-      ", ", slowMAType, ", ", signalPeriod, ", ", signalMAType ));
+    return Id::make("MACD Signal Ext", series.getId(), fastPeriod, fastMAType, slowPeriod, slowMAType, signalPeriod, signalMAType);
   }
 
  public:
@@ -1068,7 +1425,7 @@ class MakeMACDHistExtSeries : public MakeFromSeries {
  private:
   static const Id calculateId(const SeriesImpl& series, unsigned int fastPeriod, MAType fastMAType, unsigned int slowPeriod,
                               MAType slowMAType, unsigned int signalPeriod, MAType signalMAType) {
-    return Id(tradery::format(series.getId(), " - MACD Hist Ext- ", fastPeriod, ", ", fastMAType, ", ", slowPeriod, ", ", slowMAType, ", ", signalPeriod, ", ", signalMAType));
+    return Id::make("MACD Hist Ext", series.getId(), fastPeriod, fastMAType, slowPeriod, slowMAType, signalPeriod, signalMAType);
   }
 
  public:
@@ -1233,7 +1590,7 @@ class MakePPOSeries : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series, unsigned int fastPeriod, unsigned int slowPeriod, MAType maType) {
-    return Id(tradery::format(series.getId(), " - PPO - ", fastPeriod, ", ", slowPeriod, ", ", maType));
+    return Id::make("PPO", series.getId(), fastPeriod, slowPeriod, maType);
   }
 
  public:
@@ -1264,7 +1621,7 @@ class MakeHTDCPeriodSeries : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series) {
-    return Id(series.getId() + " - HT DC Period");
+    return Id::make("HT DC Period", series.getId());
   }
 
  public:
@@ -1294,7 +1651,7 @@ class MakeHTDCPhaseSeries : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series) {
-    return Id(series.getId() + " - HT DC Phase");
+    return Id::make("HT DC Phase", series.getId());
   }
 
  public:
@@ -1325,7 +1682,7 @@ class MakeHTPhasorPhaseSeries : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series) {
-    return Id(series.getId() + " - HT Phasor Phase");
+    return Id::make("HT Phasor Phase", series.getId());
   }
 
  public:
@@ -1356,7 +1713,7 @@ class MakeHTPhasorQuadratureSeries : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series) {
-    return Id(series.getId() + " - HT Phasor quadrature");
+    return Id::make("HT Phasor quadrature", series.getId());
   }
 
  public:
@@ -1387,7 +1744,7 @@ class MakeHTSineSeries : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series) {
-    return Id(series.getId() + " - HT Sine");
+    return Id::make("HT Sine", series.getId());
   }
 
  public:
@@ -1419,7 +1776,7 @@ class MakeHTLeadSineSeries : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series) {
-    return Id(series.getId() + " - HT Lead sine");
+    return Id::make("HT Lead sine", series.getId());
   }
 
  public:
@@ -1455,7 +1812,7 @@ class MakeHTTrendModeSeries : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series) {
-    return Id(series.getId() + " - HT Trend Mode");
+    return Id::make("HT Trend Mode", series.getId());
   }
 
  public:
@@ -1489,7 +1846,7 @@ class MakeChaikinADSeries : public MakeFromBars {
 
  private:
   static const Id calculateId(const BarsImpl& bars) {
-    return Id(bars.getId() + " - Chaikin A/D");
+    return Id::make("Chaikin A/D", bars.getId());
   }
 
  public:
@@ -1528,7 +1885,7 @@ class MakeChaikinADOscillatorSeries : public MakeFromBars {
 
  private:
   static const Id calculateId(const BarsImpl& bars, unsigned int fastPeriod, unsigned int slowPeriod) {
-    return Id(tradery::format(bars.getId(), " - Chaikin A/D Oscillator - ", fastPeriod, ", ", slowPeriod));
+    return Id::make("Chaikin A/D Oscillator", bars.getId(), fastPeriod, slowPeriod);
   }
 
  public:
@@ -1567,13 +1924,13 @@ class MakeOBVSeries : public MakeFromBars {
   const Series& _series;
 
  private:
-  static const Id calculateId(const BarsImpl& bars, const SeriesImpl& series) {
-    return Id(tradery::format(bars.getId(), ", ", series.getId(), " - OBV"));
+  static const Id calculateId(const BarsImpl& bars, const SeriesAbstr& series) {
+    return Id::make("OBV", bars.getId(), seriesId(series));
   }
 
  public:
   MakeOBVSeries(const BarsImpl& bars, const Series& series)
-      : MakeFromBars(bars, calculateId(bars, dynamic_cast<const SeriesImpl&>(series.getSeries()))), _series(series) {}
+      : MakeFromBars(bars, calculateId(bars, series.getSeries())), _series(series) {}
 
   CacheableSeriesPtr make() const {
     return std::make_shared< IndicatorCacheable >(new OBVSeries(getBars(), _series, id()), id());
@@ -1581,18 +1938,36 @@ class MakeOBVSeries : public MakeFromBars {
 };
 
 class MakeStdDevSeries : public MakeFromSeries {
- private:
+ public:
+  /**
+   * Keeps the running sums left after the last value, so the series can be
+   * extended when bars are appended to the data
+   */
   class StdDevSeries : public SeriesImpl {
+   private:
+    double _totals[2] = {0, 0};
+
    public:
+    StdDevSeries(size_t size, Synchronizer::SynchronizerPtr synchronizer, const Id& id)
+        : SeriesImpl(size, synchronizer, id) {}
+
     // TODO: enforce that T is of type series using function_requires
-    StdDevSeries(const SeriesImpl& series, unsigned int period, double nbDev, const Id& id)
+    StdDevSeries(const SeriesImpl& series, unsigned int period, double nbDev, const Id& id, const StdDevSeries* base, size_t baseSize)
         : SeriesImpl(series.unsyncSize(), series.synchronizer(), id) {
-      if (unsyncSize() > (unsigned int)TA_STDDEV_Lookback(period, nbDev)) {
-        int begIdx;
-        int nbElement;
-        TA_STDDEV(0, unsyncSize() - 1, series.getArray(), period, nbDev, &begIdx, &nbElement, &at(TA_STDDEV_Lookback(period, nbDev)));
+      // the sums are those after the last value of base, so all of it must be reused
+      if (base != nullptr && baseSize == base->unsyncSize() && baseSize > (unsigned int)TA_STDDEV_Lookback(period, nbDev)) {
+        extend(*base, baseSize);
+        _totals[0] = base->_totals[0];
+        _totals[1] = base->_totals[1];
+        extendStdDev(series.getArray(), baseSize, unsyncSize(), period, nbDev, _v.data(), _totals[0], _totals[1]);
+      }
+      else if (isBatchable(series, period, nbDev)) {
+        double* out = _v.data();
+        calculateStdDevs(series.getArray(), unsyncSize(), &period, nbDev, &out, 1, _totals);
       }
     }
+
+    double* totals() { return _totals; }
   };
 
  private:
@@ -1600,16 +1975,26 @@ class MakeStdDevSeries : public MakeFromSeries {
   const double _nbDev;
 
  private:
-  static const Id calculateId(const SeriesImpl& series, unsigned int period, double nbDev) {
-    return Id(tradery::format(series.getId(), " - Standard deviation - ", period, ", ", nbDev));
+  static const Id calculateId(const Id& seriesId, unsigned int period, double nbDev) {
+    return Id::make("Standard deviation", seriesId, period, nbDev);
   }
 
  public:
+  /**
+   * whether the period can be calculated by calculateStdDevs, otherwise the
+   * series is all 0 - the same conditions as for TA_STDDEV
+   */
+  static bool isBatchable(const SeriesAbstr& series, unsigned int period, double nbDev) {
+    return series.unsyncSize() > (unsigned int)TA_STDDEV_Lookback(period, nbDev);
+  }
+
   MakeStdDevSeries(const SeriesImpl& series, unsigned int period, double nbDev)
-      : MakeFromSeries(series, calculateId(series, period, nbDev)), _period(period), _nbDev(nbDev) {}
+      : MakeFromSeries(series, calculateId(series.getId(), period, nbDev)), _period(period), _nbDev(nbDev) {}
 
   CacheableSeriesPtr make() const {
-    return std::make_shared< IndicatorCacheable >(new StdDevSeries(getSeries(), _period, _nbDev, id()), id());
+    const std::pair<std::shared_ptr<const StdDevSeries>, size_t> base =
+        findExtended<StdDevSeries>(getSeries(), [this](const Id& seriesId) { return calculateId(seriesId, _period, _nbDev); });
+    return std::make_shared< IndicatorCacheable >(new StdDevSeries(getSeries(), _period, _nbDev, id(), base.first.get(), base.second), id());
   }
 };
 
@@ -1634,7 +2019,7 @@ class MakeVarianceSeries : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series, unsigned int period, double nbDev) {
-    return Id(tradery::format(series.getId(), " - Variance - ", period, ", ", nbDev));
+    return Id::make("Variance", series.getId(), period, nbDev);
   }
 
  public:
@@ -1667,7 +2052,7 @@ class MakeAvgPriceSeries : public MakeFromBars {
 
  private:
   static const Id calculateId(const BarsImpl& bars) {
-    return Id(tradery::format( bars.getId(), " - Average Price"));
+    return Id::make("Average Price", bars.getId());
   }
 
  public:
@@ -1698,7 +2083,7 @@ class MakeMedPriceSeries : public MakeFromBars {
 
  private:
   static const Id calculateId(const BarsImpl& bars) {
-    return Id(tradery::format(bars.getId(), " - Median Price"));
+    return Id::make("Median Price", bars.getId());
   }
 
  public:
@@ -1730,7 +2115,7 @@ class MakeTypPriceSeries : public MakeFromBars {
 
  private:
   static const Id calculateId(const BarsImpl& bars) {
-    return Id(tradery::format(bars.getId(), " - Typical Price"));
+    return Id::make("Typical Price", bars.getId());
   }
 
  public:
@@ -1763,7 +2148,7 @@ class MakeWclPriceSeries : public MakeFromBars {
 
  private:
   static const Id calculateId(const BarsImpl& bars) {
-    return Id(tradery::format(bars.getId(), " - Wighted Close Price"));
+    return Id::make("Wighted Close Price", bars.getId());
   }
 
  public:
@@ -1803,7 +2188,7 @@ class MakeAccumDistSeries : public MakeFromBars {
 
  private:
   static const Id calculateId(const BarsImpl& bars) {
-    return Id(bars.getId() + "- Accum/Dist");
+    return Id::make("Accum/Dist", bars.getId());
   }
 
  public:
@@ -1840,7 +2225,7 @@ class MakeTrueRangeSeries : public MakeFromBars {
 
  private:
   static const Id calculateId(const BarsImpl& bars) {
-    return Id(bars.getId() + "- True Range");
+    return Id::make("True Range", bars.getId());
   }
 
  public:
@@ -1999,7 +2384,7 @@ class MakeCandle : public MakeFromBars {
 
  private:
   static const Id calculateId(const BarsImpl& bars) {
-    return Id(bars.getId() + " - ") + CandleConstants<T>::_id;
+    return Id::make(CandleConstants<T>::_id, bars.getId());
   }
 
  public:
@@ -2041,7 +2426,7 @@ class MakeCandlePenetration : public MakeFromBars {
 
  private:
   static const Id calculateId(const BarsImpl& bars, double penetration) {
-    return Id(tradery::format( bars.getId(), CandleConstantsPenetration<T>::_id, penetration));
+    return Id::make(CandleConstantsPenetration<T>::_id, bars.getId(), penetration);
   }
 
  public:
@@ -2187,7 +2572,7 @@ class MakeStochSlowKSeries : public MakeFromBars {
 
  private:
   static const Id calculateId(const BarsImpl& bars, int fastKPeriod, int slowKPeriod, MAType slowKMAType, int slowDPeriod, MAType slowDMAType) {
-    return Id(tradery::format(bars.getId(), ", ", fastKPeriod, ", ", slowKPeriod, ", " , slowKMAType, ", ", slowDPeriod, ", ", slowDMAType, " - Stochastic Slow K"));
+    return Id::make("Stochastic Slow K", bars.getId(), fastKPeriod, slowKPeriod, slowKMAType, slowDPeriod, slowDMAType);
   }
 
  public:
@@ -2228,7 +2613,7 @@ class MakeBOPSeries : public MakeFromBars {
 
  private:
   static const Id calculateId(const BarsImpl& bars) {
-    return Id(tradery::format(bars.getId(), ", ", " - BOP"));
+    return Id::make("BOP", bars.getId());
   }
 
  public:
@@ -2271,7 +2656,7 @@ class MakeStochSlowDSeries : public MakeFromBars {
 
  private:
   static const Id calculateId(const BarsImpl& bars, int fastKPeriod, int slowKPeriod, MAType slowKMAType, int slowDPeriod, MAType slowDMAType) {
-    return Id(tradery::format(bars.getId(), ", ", fastKPeriod, ", ", slowKPeriod, ", ", slowKMAType, ", ", slowDPeriod, ", ", slowDMAType, " - Stochastic Slow D"));
+    return Id::make("Stochastic Slow D", bars.getId(), fastKPeriod, slowKPeriod, slowKMAType, slowDPeriod, slowDMAType);
   }
 
  public:
@@ -2317,7 +2702,7 @@ class MakeStochFastDSeries : public MakeFromBars {
 
  private:
   static const Id calculateId(const BarsImpl& bars, int fastKPeriod, int fastDPeriod, MAType fastDMAType) {
-    return Id(tradery::format(bars.getId(), ", ", fastKPeriod, ", ", fastDPeriod, ", ", fastDMAType, " - Stochastic Fast D"));
+    return Id::make("Stochastic Fast D", bars.getId(), fastKPeriod, fastDPeriod, fastDMAType);
   }
 
  public:
@@ -2361,7 +2746,7 @@ class MakeStochFastKSeries : public MakeFromBars {
 
  private:
   static const Id calculateId(const BarsImpl& bars, int fastKPeriod, int fastDPeriod, MAType fastDMAType) {
-    return Id(tradery::format(bars.getId(), ", ", fastKPeriod, ", ", fastDPeriod, ", ", fastDMAType, " - Stochastic Fast K"));
+    return Id::make("Stochastic Fast K", bars.getId(), fastKPeriod, fastDPeriod, fastDMAType);
   }
 
  public:
@@ -2403,7 +2788,7 @@ class MakeStochRSIFastKSeries : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series, unsigned int period, int fastKPeriod, int fastDPeriod, MAType fastDMAType) {
-    return Id(tradery::format(series.getId(), ", ", period, ", ", fastKPeriod, ", ", fastDPeriod, ", ", fastDMAType, " - Stochastic RSI Fast K"));
+    return Id::make("Stochastic RSI Fast K", series.getId(), period, fastKPeriod, fastDPeriod, fastDMAType);
   }
 
  public:
@@ -2446,7 +2831,7 @@ class MakeStochRSIFastDSeries : public MakeFromSeries {
 
  private:
   static const Id calculateId(const SeriesImpl& series, unsigned int period, int fastKPeriod, int fastDPeriod, MAType fastDMAType) {
-    return Id(tradery::format(series.getId(), ", ", period, ", ", fastKPeriod, ", ", fastDPeriod, ", ", fastDMAType, " - Stochastic RSI Fast K"));
+    return Id::make("Stochastic RSI Fast D", series.getId(), period, fastKPeriod, fastDPeriod, fastDMAType);
   }
 
  public:
@@ -2468,13 +2853,14 @@ class Op2SeriesBase : public CacheableBuilderX {
   virtual SeriesImpl* makeUnsyncSeries(const SeriesAbstr& series1, const SeriesAbstr& series2) const = 0;
   virtual SeriesImpl* makeSyncSeries(const SeriesAbstr& series1, const SeriesAbstr& series2) const = 0;
 
-  static const Id calculateId(const SeriesAbstr& series1, const SeriesAbstr& series2) {
-    return Id();
+  static const Id calculateId(const SeriesAbstr& series1, const SeriesAbstr& series2, const Id& op) {
+    const Id id = Id::make("Op2", op, seriesId(series1), seriesId(series2));
+    return synchronizedId(synchronizedId(id, series1.synchronizer()), series2.synchronizer());
   }
 
  public:
-  Op2SeriesBase(const SeriesAbstr& series1, const SeriesAbstr& series2)
-      : _series1(series1), _series2(series2), CacheableBuilderX(calculateId(series1, series2)) {}
+  Op2SeriesBase(const SeriesAbstr& series1, const SeriesAbstr& series2, const Id& op)
+      : _series1(series1), _series2(series2), CacheableBuilderX(calculateId(series1, series2, op)) {}
 
   virtual CacheableSeriesPtr make() const {
     if (_series1.size() != _series2.size()) {
@@ -2500,34 +2886,36 @@ class Op2SeriesBase : public CacheableBuilderX {
   }
 };
 
-using OpFunction = std::function< double(double, double) >;
+using BinaryOp = tradery::kernels::BinaryOp;
 
 class Op : public SeriesImpl {
 public:
   /* generates an unsync series (at least on of series1 or 2 is */
   /* unsynchronized */
-  Op(const SeriesAbstr& series1, const SeriesAbstr& series2, const Id& id, OpFunction op)
+  Op(const SeriesAbstr& series1, const SeriesAbstr& series2, const Id& id, BinaryOp op)
     : SeriesImpl(series1.size(), Synchronizer::SynchronizerPtr(), id) {
-    for (size_t n = 0; n < series1.size(); n++) {
-      _v.at(n) = std::invoke( op, series1[n], series2[n]);
+    if (!series1.isSynchronized() && !series2.isSynchronized()) {
+      // both are unsynchronized, so the values can be used directly
+      tradery::kernels::binary(op, series1.getArray(), series2.getArray(), _v.data(), _v.size());
+    }
+    else {
+      for (size_t n = 0; n < series1.size(); n++) {
+        _v[n] = tradery::kernels::apply(op, series1[n], series2[n]);
+      }
     }
   }
   /* generates a synced series*/
 
-  Op(const SeriesAbstr& series1, const SeriesAbstr& series2, Synchronizer::SynchronizerPtr synchronizer, const Id& id, OpFunction op )
+  Op(const SeriesAbstr& series1, const SeriesAbstr& series2, Synchronizer::SynchronizerPtr synchronizer, const Id& id, BinaryOp op )
     : SeriesImpl(series1.unsyncSize(), synchronizer, id) {
-    const double* s1 = series1.getArray();
-    const double* s2 = series2.getArray();
-    for (size_t n = 0; n < series1.unsyncSize(); n++) {
-      _v.at(n) = std::invoke( op, s1[n], s2[n]);
-    }
+    tradery::kernels::binary(op, series1.getArray(), series2.getArray(), _v.data(), _v.size());
   }
 };
 
 class Operation : public Op2SeriesBase
 {
 private:
-  OpFunction m_op;
+  BinaryOp m_op;
 
   SeriesImpl* makeUnsyncSeries(const SeriesAbstr& series1, const SeriesAbstr& series2) const override {
     return new Op(series1, series2, id(), m_op);
@@ -2537,42 +2925,45 @@ private:
   }
 
 public:
-  Operation(const SeriesAbstr& series1, const SeriesAbstr& series2, OpFunction op)
-    : Op2SeriesBase(series1, series2 ), m_op( op ) {}
+  Operation(const SeriesAbstr& series1, const SeriesAbstr& series2, const char* name, BinaryOp op)
+    : Op2SeriesBase(series1, series2, Id::make(name)), m_op( op ) {}
 };
 
 
 class MakeMultiplySeries : public Operation {
 public:
   MakeMultiplySeries(const SeriesAbstr& series1, const SeriesAbstr& series2 )
-    : Operation(series1, series2, [](double v1, double v2)->double { return v1 * v2; } ) {}
+    : Operation(series1, series2, "multiply", BinaryOp::multiply) {}
 };
 
 class MakeAddSeries : public Operation {
 public:
   MakeAddSeries(const SeriesAbstr& series1, const SeriesAbstr& series2)
-    : Operation(series1, series2, [](double v1, double v2)->double { return v1 + v2; }) {}
+    : Operation(series1, series2, "add", BinaryOp::add) {}
 };
 
 class MakeDivideSeries : public Operation {
 public:
   MakeDivideSeries(const SeriesAbstr& series1, const SeriesAbstr& series2)
-    : Operation(series1, series2, [](double v1, double v2)->double { return v1 / v2; }) {}
+    : Operation(series1, series2, "divide", BinaryOp::divide) {}
 };
 
 class MakeSubtractSeries : public Operation {
 public:
   MakeSubtractSeries(const SeriesAbstr& series1, const SeriesAbstr& series2)
-    : Operation(series1, series2, [](double v1, double v2)->double { return v1 - v2; }) {}
+    : Operation(series1, series2, "subtract", BinaryOp::subtract) {}
 };
 
 using  TA_FUNC2 = TA_RetCode (*)(int, int, const double[], const double[], int, int*, int*, double[]);
 
 template <TA_FUNC2 T> class TAFunc2Constants {
  public:
-  static const LPCTSTR _id;
+  static const char* _id;
 };
 
+template <> const char* TAFunc2Constants<TA_CORREL>::_id = "Correlation";
+template <> const char* TAFunc2Constants<TA_BETA>::_id = "Beta";
+
 template <TA_LOOKBACK_INT T, TA_FUNC2 U> class MakeOp2SeriesPeriod : public Op2SeriesBase {
  private:
   unsigned int _period;
@@ -2609,7 +3000,7 @@ template <TA_LOOKBACK_INT T, TA_FUNC2 U> class MakeOp2SeriesPeriod : public Op2S
 
  public:
   MakeOp2SeriesPeriod(const SeriesAbstr& series1, const SeriesAbstr& series2, unsigned int period)
-      : Op2SeriesBase(series1, series2), _period(period) {}
+      : Op2SeriesBase(series1, series2, Id::make(TAFunc2Constants<U>::_id, period)), _period(period) {}
 };
 
 using MakeCorrelationSeries = MakeOp2SeriesPeriod<TA_CORREL_Lookback, TA_CORREL>;
@@ -2634,7 +3025,7 @@ class MakeShiftRightSeries : public CacheableBuilderX {
 
  public:
   static const Id calculateId(const SeriesAbstr& series, unsigned int n) {
-    return Id();
+    return synchronizedId(Id::make("Shift right", seriesId(series), n), series.synchronizer());
   }
 
   MakeShiftRightSeries(const SeriesAbstr& series, unsigned int n)
@@ -2664,7 +3055,7 @@ class MakeShiftLeftSeries : public CacheableBuilderX {
 
  public:
   static const Id calculateId(const SeriesAbstr& series, unsigned int n) {
-    return Id();
+    return synchronizedId(Id::make("Shift left", seriesId(series), n), series.synchronizer());
   }
 
   MakeShiftLeftSeries(const SeriesAbstr& series, unsigned int n)
@@ -2681,73 +3072,79 @@ class SeriesOperation : public CacheableBuilderX
 private:
   const SeriesAbstr& _series;
   const double _value;
-  OpFunction m_opFunction;
+  const BinaryOp _op;
+  const bool _valueFirst;
 
 private:
   class OpValue : public SeriesImpl {
     public:
-      OpValue(const SeriesAbstr& series, double value, const Id& id, OpFunction op )
+      OpValue(const SeriesAbstr& series, double value, const Id& id, BinaryOp op, bool valueFirst )
         : SeriesImpl(series.unsyncSize(), series.synchronizer(), id) {
-          std::transform(series.getVector().begin(), series.getVector().end(), _v.begin(),
-          [&value, &op](double a) {
-            return std::invoke(op, value, a);
-        }
-      );
+      if (valueFirst) {
+        tradery::kernels::binary(op, value, series.getArray(), _v.data(), _v.size());
+      }
+      else {
+        tradery::kernels::binary(op, series.getArray(), value, _v.data(), _v.size());
+      }
     }
   };
 
-  static const Id calculateId(const SeriesImpl& series, double value, const Id& id){
-    return Id(tradery::format( series.getId(), id, value ));
+  static const Id calculateId(const SeriesImpl& series, double value, const char* name){
+    return synchronizedId(Id::make(name, series.getId(), value), series.synchronizer());
   }
 
 public:
-  SeriesOperation(const SeriesImpl& series, double value, const Id& id, OpFunction op )
-        : _series(series), _value(value), CacheableBuilderX(calculateId(series, value, id)), m_opFunction( op ) {}
+  /**
+   * @param valueFirst    if true, calculates value op series[i], otherwise
+   *                      series[i] op value
+   */
+  SeriesOperation(const SeriesImpl& series, double value, const char* name, BinaryOp op, bool valueFirst = false )
+        : _series(series), _value(value), CacheableBuilderX(calculateId(series, value, name)), _op( op ), _valueFirst( valueFirst ) {}
 
   CacheableSeriesPtr make() const override {
-    return std::make_shared< IndicatorCacheable >(new OpValue(_series, _value, id(), m_opFunction ), id()); 
+    return std::make_shared< IndicatorCacheable >(new OpValue(_series, _value, id(), _op, _valueFirst ), id()); 
   }
 };
 
 class MakeAddSeriesToValue : public SeriesOperation {
 public:
   MakeAddSeriesToValue(const SeriesImpl& series, double value)
-    : SeriesOperation(series, value, " - add value - ", [](double value, double a)->double { return a + value; }) {
+    : SeriesOperation(series, value, "add value", BinaryOp::add) {
   }
 };
 
 class MakeSubtractValueFromSeries : public SeriesOperation {
 public:
   MakeSubtractValueFromSeries(const SeriesImpl& series, double value)
-    : SeriesOperation(series, value, " - subtract value - ", [](double value, double a)->double { return a - value; }) {
+    : SeriesOperation(series, value, "subtract value", BinaryOp::subtract) {
   }
 };
 
 class MakeDivideSeriesByValue : public SeriesOperation {
 public:
   MakeDivideSeriesByValue(const SeriesImpl& series, double value)
-    : SeriesOperation(series, value, " - divide by value - ", [](double value, double a)->double { return a / value; }) {
+    : SeriesOperation(series, value, "divide by value", BinaryOp::divide) {
   }
 };
 
 class MakeDivideValueBySeries : public SeriesOperation {
 public:
   MakeDivideValueBySeries(const SeriesImpl& series, double value)
-    : SeriesOperation(series, value, " - divide value by - ", [](double value, double a)->double { return value / a; }) {
+    : SeriesOperation(series, value, "divide value by", BinaryOp::divide, true) {
   }
 };
 
 class MakeSubtractSeriesFromValue : public SeriesOperation {
 public:
   MakeSubtractSeriesFromValue(const SeriesImpl& series, double value)
-    : SeriesOperation(series, value, " - subtract from value - ", [](double value, double a)->double { return value - a; }) {
+    : SeriesOperation(series, value, "subtract from value", BinaryOp::subtract, true) {
   }
 };
 
 class MakeMultiplySeriesByValue : public SeriesOperation {
 public:
   MakeMultiplySeriesByValue(const SeriesImpl& series, double value)
-    : SeriesOperation(series, value, " - multiply by value - ", [](double value, double a)->double { return a * value; }) {
+    : SeriesOperation(series, value, "multiply by value", BinaryOp::multiply) {
   }
 };
 
@@ -2755,20 +3152,11 @@ public:
 // they could be removed from the
 // cache.
 class EmptySeries : public SeriesImpl {
- private:
-  static unsigned long _l;
-  static std::mutex _mutex;
-
-  static const Id calculateId() {
-    std::scoped_lock lock(_mutex);
-    return std::to_string(_l++);
-  }
-
  public:
-  EmptySeries() : SeriesImpl(calculateId()) {}
+  EmptySeries() : SeriesImpl(Id::unique()) {}
 
   EmptySeries(size_t size)
-      : SeriesImpl(size, Synchronizer::SynchronizerPtr(), calculateId()) {}
+      : SeriesImpl(size, Synchronizer::SynchronizerPtr(), Id::unique()) {}
 };
 
 using TA_FUNC0 = TA_RetCode (*)(int, int, const double[], int*, int*, double[]);
@@ -2778,21 +3166,21 @@ template <TA_FUNC0 T> class TAFunc0Constants {
   static const char* _id;
 };
 
-template <> const char* TAFunc0Constants<TA_SIN>::_id = "- Sin";
-template <> const char* TAFunc0Constants<TA_COS>::_id = "- Cos";
-template <> const char* TAFunc0Constants<TA_TAN>::_id = "- Tan";
-template <> const char* TAFunc0Constants<TA_COSH>::_id = "- Cosh";
-template <> const char* TAFunc0Constants<TA_SINH>::_id = "- Sinh";
-template <> const char* TAFunc0Constants<TA_TANH>::_id = "- Tanh";
-template <> const char* TAFunc0Constants<TA_ACOS>::_id = "- Acos";
-template <> const char* TAFunc0Constants<TA_ASIN>::_id = "- Asin";
-template <> const char* TAFunc0Constants<TA_ATAN>::_id = "- Atan";
-template <> const char* TAFunc0Constants<TA_CEIL>::_id = "- Ceil";
-template <> const char* TAFunc0Constants<TA_FLOOR>::_id = "- Floor";
-template <> const char* TAFunc0Constants<TA_EXP>::_id = "- Exp";
-template <> const char* TAFunc0Constants<TA_SQRT>::_id = "- Sqrt";
-template <> const char* TAFunc0Constants<TA_LN>::_id = "- Ln";
-template <> const char* TAFunc0Constants<TA_LOG10>::_id = "- Log10";
+template <> const char* TAFunc0Constants<TA_SIN>::_id = "Sin";
+template <> const char* TAFunc0Constants<TA_COS>::_id = "Cos";
+template <> const char* TAFunc0Constants<TA_TAN>::_id = "Tan";
+template <> const char* TAFunc0Constants<TA_COSH>::_id = "Cosh";
+template <> const char* TAFunc0Constants<TA_SINH>::_id = "Sinh";
+template <> const char* TAFunc0Constants<TA_TANH>::_id = "Tanh";
+template <> const char* TAFunc0Constants<TA_ACOS>::_id = "Acos";
+template <> const char* TAFunc0Constants<TA_ASIN>::_id = "Asin";
+template <> const char* TAFunc0Constants<TA_ATAN>::_id = "Atan";
+template <> const char* TAFunc0Constants<TA_CEIL>::_id = "Ceil";
+template <> const char* TAFunc0Constants<TA_FLOOR>::_id = "Floor";
+template <> const char* TAFunc0Constants<TA_EXP>::_id = "Exp";
+template <> const char* TAFunc0Constants<TA_SQRT>::_id = "Sqrt";
+template <> const char* TAFunc0Constants<TA_LN>::_id = "Ln";
+template <> const char* TAFunc0Constants<TA_LOG10>::_id = "Log10";
 
 template <TA_LOOKBACK TA_LB, TA_FUNC0 TA_FUNC>
 class MakeSeriesTAFunc0 : public MakeFromSeries {
@@ -2816,7 +3204,7 @@ class MakeSeriesTAFunc0 : public MakeFromSeries {
 
  public:
   MakeSeriesTAFunc0(const SeriesImpl& series)
-      : MakeFromSeries(series, TAFunc0Constants<TA_FUNC>::_id) {}
+      : MakeFromSeries(series, Id::make(TAFunc0Constants<TA_FUNC>::_id, series.getId())) {}
 
   CacheableSeriesPtr make() const override {
     return std::make_shared<IndicatorCacheable>(new XSeries(getSeries(), id()), id());
@@ -0,0 +1,264 @@
+/*
+   Copyright (C) 2018-2020 Adrian Michel
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "cache.h"
+#include "bars.h"
+#include <panel.h>
+
+#include <limits>
+
+using namespace tradery;
+
+// panels are cached with the data they are made from
+PanelCache* _panelCache;
+
+namespace {
+constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+
+bool isValid(const double* values, const unsigned char* valid, size_t n) { return valid[n] != 0 && !std::isnan(values[n]); }
+
+// the indexes of the valid values, sorted by ascending value, equal values in
+// index order
+std::vector<size_t> sortedValid(const double* values, const unsigned char* valid, size_t n) {
+  std::vector<size_t> indexes;
+  indexes.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    if (isValid(values, valid, i)) {
+      indexes.push_back(i);
+    }
+  }
+  std::stable_sort(indexes.begin(), indexes.end(), [values](size_t a, size_t b) { return values[a] < values[b]; });
+  return indexes;
+}
+}  // namespace
+
+CORE_API void tradery::crossSection::rank(const double* values, const unsigned char* valid, size_t n, double* out) {
+  std::fill(out, out + n, NaN);
+  const std::vector<size_t> sorted(sortedValid(values, valid, n));
+  for (size_t first = 0; first < sorted.size();) {
+    size_t last = first + 1;
+    while (last < sorted.size() && values[sorted[last]] == values[sorted[first]]) {
+      ++last;
+    }
+    // equal values in [first, last) get the average of their ranks
+    const double r = (first + last - 1) / 2.0;
+    for (size_t i = first; i < last; ++i) {
+      out[sorted[i]] = r;
+    }
+    first = last;
+  }
+}
+
+CORE_API void tradery::crossSection::percentile(const double* values, const unsigned char* valid, size_t n, double* out) {
+  rank(values, valid, n, out);
+  size_t count = 0;
+  for (size_t i = 0; i < n; ++i) {
+    count += isValid(values, valid, i) ? 1 : 0;
+  }
+  const double scale = count > 1 ? 1.0 / (count - 1) : 0;
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = count > 1 ? out[i] * scale : (std::isnan(out[i]) ? NaN : 0.5);
+  }
+}
+
+CORE_API void tradery::crossSection::zScore(const double* values, const unsigned char* valid, size_t n, double* out) {
+  double sum = 0;
+  size_t count = 0;
+  for (size_t i = 0; i < n; ++i) {
+    if (isValid(values, valid, i)) {
+      sum += values[i];
+      ++count;
+    }
+  }
+  const double mean = count > 0 ? sum / count : 0;
+  double squares = 0;
+  for (size_t i = 0; i < n; ++i) {
+    if (isValid(values, valid, i)) {
+      squares += (values[i] - mean) * (values[i] - mean);
+    }
+  }
+  const double stdDev = count > 0 ? std::sqrt(squares / count) : 0;
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = !isValid(values, valid, i) ? NaN : stdDev > 0 ? (values[i] - mean) / stdDev : 0;
+  }
+}
+
+CORE_API std::vector<size_t> tradery::crossSection::topK(const double* values, const unsigned char* valid, size_t n, size_t k) {
+  std::vector<size_t> indexes;
+  indexes.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    if (isValid(values, valid, i)) {
+      indexes.push_back(i);
+    }
+  }
+  k = std::min(k, indexes.size());
+  std::partial_sort(indexes.begin(), indexes.begin() + k, indexes.end(),
+                    [values](size_t a, size_t b) { return values[a] > values[b] || (values[a] == values[b] && a < b); });
+  indexes.resize(k);
+  return indexes;
+}
+
+std::vector<double> Panel::rank(Field field, size_t date) const {
+  std::vector<double> out(symbols());
+  crossSection::rank(values(field, date), valid(date), symbols(), out.data());
+  return out;
+}
+
+std::vector<double> Panel::percentile(Field field, size_t date) const {
+  std::vector<double> out(symbols());
+  crossSection::percentile(values(field, date), valid(date), symbols(), out.data());
+  return out;
+}
+
+std::vector<double> Panel::zScore(Field field, size_t date) const {
+  std::vector<double> out(symbols());
+  crossSection::zScore(values(field, date), valid(date), symbols(), out.data());
+  return out;
+}
+
+std::vector<size_t> Panel::topK(Field field, size_t date, size_t k) const {
+  return crossSection::topK(values(field, date), valid(date), symbols(), k);
+}
+
+class PanelImpl : public Panel {
+ private:
+  TimeSeries _timeSeries;
+  const size_t _dates;
+  const std::vector<std::string> _symbols;
+  // dates() x symbols(), the symbols of a date are contiguous
+  std::vector<double> _closes;
+  std::vector<double> _volumes;
+  std::vector<unsigned char> _valid;
+  std::vector<size_t> _validCount;
+
+ private:
+  // merges the time stamps of the bars of a symbol with the master calendar,
+  // in one pass
+  void align(size_t symbolIndex, const BarsImpl& bars) {
+    const size_t symbols = _symbols.size();
+    const DateTime* dates = _timeSeries.data();
+    const DateTime* times = bars.unsyncTimeSeries().data();
+    const size_t size = bars.unsyncSize();
+    const std::vector<double>& closes(bars.closeSeries().getVector());
+    const std::vector<double>& volumes(bars.volumeSeries().getVector());
+
+    for (size_t date = 0, bar = 0; date < _dates && bar < size;) {
+      const __int64 dateTicks = dates[date].ticks();
+      const __int64 barTicks = times[bar].ticks();
+      if (dateTicks == barTicks) {
+        const size_t n = date * symbols + symbolIndex;
+        _closes[n] = closes[bar];
+        _volumes[n] = volumes[bar];
+        _valid[n] = 1;
+        ++_validCount[date];
+        ++date;
+        ++bar;
+      }
+      else if (dateTicks < barTicks) {
+        ++date;
+      }
+      else {
+        ++bar;
+      }
+    }
+  }
+
+ public:
+  PanelImpl(Bars master, const std::vector<std::string>& symbols, const std::vector<Bars>& bars)
+      : _timeSeries(master.timeSeries()),
+        _dates(master.size()),
+        _symbols(symbols),
+        _closes(_dates * symbols.size(), NaN),
+        _volumes(_dates * symbols.size(), NaN),
+        _valid(_dates * symbols.size(), 0),
+        _validCount(_dates, 0) {
+    assert(symbols.size() == bars.size());
+    for (size_t n = 0; n < bars.size(); ++n) {
+      const BarsImpl* b = dynamic_cast<const BarsImpl*>(bars[n].getBarsAbstr());
+      if (b != 0) {
+        align(n, *b);
+      }
+    }
+  }
+
+  size_t dates() const override { return _dates; }
+  size_t symbols() const override { return _symbols.size(); }
+  const std::string& symbol(size_t symbolIndex) const override { return _symbols.at(symbolIndex); }
+  TimeSeries timeSeries() const override { return _timeSeries; }
+
+  const double* values(Field field, size_t date) const override {
+    assert(date < _dates);
+    return (field == VOLUME ? _volumes : _closes).data() + date * _symbols.size();
+  }
+
+  const unsigned char* valid(size_t date) const override {
+    assert(date < _dates);
+    return _valid.data() + date * _symbols.size();
+  }
+
+  size_t validCount(size_t date) const override { return _validCount.at(date); }
+};
+
+template <>
+class CacheableBytes<Panel> {
+ public:
+  static uint64_t bytes(const Panel& panel) {
+    return sizeof(panel) + panel.dates() * (panel.symbols() * (2 * sizeof(double) + sizeof(unsigned char)) + sizeof(size_t));
+  }
+};
+
+class MakePanel : public CacheableBuilder<Panel> {
+ private:
+  Bars _master;
+  const std::vector<std::string>& _symbols;
+  const std::vector<Bars>& _bars;
+  Id _id;
+
+  static Id barsId(const Bars& bars) {
+    const BarsImpl* b = dynamic_cast<const BarsImpl*>(bars.getBarsAbstr());
+    return b != 0 ? b->getId() : Id::make("nobars");
+  }
+
+ public:
+  MakePanel(Bars master, const std::vector<std::string>& symbols, const std::vector<Bars>& bars)
+      : _master(master), _symbols(symbols), _bars(bars), _id(Id::make("panel", barsId(master), master.size())) {
+    for (size_t n = 0; n < symbols.size(); ++n) {
+      _id = Id::make("panel", _id, symbols[n], barsId(bars[n]));
+    }
+  }
+
+  std::shared_ptr<Cacheable<Panel> > make() const override {
+    return std::make_shared<Cacheable<Panel> >(std::make_shared<PanelImpl>(_master, _symbols, _bars), _id);
+  }
+
+  const Id& id() const override { return _id; }
+
+  // the ids hash all the bar values
+  bool isConsistent(const Cacheable<Panel>& cacheable) const override { return true; }
+};
+
+Panel::PanelPtr Panel::create(Bars master, const std::vector<std::string>& symbols, const std::vector<Bars>& bars) {
+  if (symbols.size() != bars.size()) {
+    throw OperationOnUnequalSizeSeriesException(symbols.size(), bars.size());
+  }
+  // synchronized master bars have the dates of their reference bars, which
+  // their id doesn't reflect
+  if (_panelCache == 0 || master.isSynchronized()) {
+    return std::make_shared<PanelImpl>(master, symbols, bars);
+  }
+  return _panelCache->findAndAdd(MakePanel(master, symbols, bars));
+}
@@ -0,0 +1,222 @@
+/*
+   Copyright (C) 2018-2020 Adrian Michel
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <log.h>
+
+#include <deque>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+
+/** @file
+ *  \brief Durations of the previous runs of each system on each symbol, used
+ *  to run the longest first
+ */
+
+/**
+ * How long running each system on each symbol took in previous sessions, and
+ * the number of bars of each symbol, kept in a text file with one
+ * "system<tab>symbol<tab>seconds<tab>bars" line per system and symbol.
+ *
+ * A session is over when its slowest thread is done, so running the longest
+ * symbols first, while the other threads can still take the short ones,
+ * shortens the tail of multi-threaded sessions
+ *
+ * @see Scheduler::setRunProfile
+ */
+class RunProfile {
+ private:
+  struct Entry {
+    double seconds;
+    unsigned __int64 bars;
+
+    Entry& operator+=(const Entry& entry) {
+      seconds += entry.seconds;
+      bars += entry.bars;
+      return *this;
+    }
+
+    Entry& operator-=(const Entry& entry) {
+      seconds -= entry.seconds;
+      bars -= entry.bars;
+      return *this;
+    }
+
+    // seconds per bar, or -1 if unknown
+    double perBar() const { return bars > 0 ? seconds / bars : -1; }
+  };
+
+  const std::string _fileName;
+  mutable std::mutex _mutex;
+  // by system and symbol
+  std::map<std::pair<std::string, std::string>, Entry> _entries;
+  // the number of bars of each symbol, from any system
+  std::map<std::string, unsigned __int64> _bars;
+  // the totals of the entries of each system, and of all the entries
+  std::map<std::string, Entry> _systems;
+  Entry _total;
+
+ private:
+  void set(const std::string& system, const std::string& symbol, const Entry& entry) {
+    Entry& e = _entries.insert(std::make_pair(std::make_pair(system, symbol), Entry{0, 0})).first->second;
+    Entry& totals = _systems.insert(std::make_pair(system, Entry{0, 0})).first->second;
+    totals -= e;
+    _total -= e;
+    e = entry;
+    totals += e;
+    _total += e;
+    _bars[symbol] = entry.bars;
+  }
+
+ public:
+  /**
+   * Loads the profile, if the file exists
+   */
+  RunProfile(const std::string& fileName) : _fileName(fileName), _total{0, 0} {
+    std::ifstream file(fileName);
+    for (std::string line; std::getline(file, line);) {
+      std::vector<std::string> fields;
+      boost::split(fields, line, boost::is_any_of("\t"));
+      if (fields.size() == 4) {
+        try {
+          set(fields[0], fields[1], Entry{std::stod(fields[2]), std::stoull(fields[3])});
+        }
+        catch (const std::exception&) {
+          // skip invalid lines
+        }
+      }
+    }
+  }
+
+  /**
+   * Records the duration of running a system on a symbol. Durations already
+   * recorded are averaged with the new one, to smooth out outliers
+   */
+  void record(const std::string& system, const std::string& symbol, double seconds, unsigned __int64 bars) {
+    std::scoped_lock lock(_mutex);
+    auto i = _entries.find(std::make_pair(system, symbol));
+    set(system, symbol, Entry{i == _entries.end() ? seconds : (i->second.seconds + seconds) / 2, bars});
+  }
+
+  /**
+   * The expected duration of running a system on a symbol: its recorded
+   * duration or, if the system hasn't been run on the symbol, the symbol's
+   * number of bars times the time per bar of the system (or of all the systems)
+   *
+   * @return the duration in seconds, or -1 if unknown
+   */
+  double estimate(const std::string& system, const std::string& symbol) const {
+    std::scoped_lock lock(_mutex);
+    auto i = _entries.find(std::make_pair(system, symbol));
+    if (i != _entries.end()) {
+      return i->second.seconds;
+    }
+    auto bars = _bars.find(symbol);
+    if (bars == _bars.end()) {
+      return -1;
+    }
+    auto totals = _systems.find(system);
+    double perBar = totals == _systems.end() ? -1 : totals->second.perBar();
+    if (perBar < 0) {
+      perBar = _total.perBar();
+    }
+    return perBar < 0 ? -1 : bars->second * perBar;
+  }
+
+  void save() const {
+    std::scoped_lock lock(_mutex);
+    std::ofstream file(_fileName, std::ios_base::trunc);
+    if (!file) {
+      LOG(log_error, "Can't write the run profile \"", _fileName, "\"");
+      return;
+    }
+    file.precision(6);
+    for (const auto& i : _entries) {
+      file << i.first.first << '\t' << i.first.second << '\t' << i.second.seconds << '\t' << i.second.bars << std::endl;
+    }
+  }
+};
+
+using RunProfilePtr = std::shared_ptr<RunProfile>;
+
+/**
+ * Returns the symbols of another iterator, longest to run first.
+ *
+ * The symbols are all taken from the other iterator on the first call to
+ * getNext. Symbols whose duration is unknown are returned first, as they could
+ * be the longest, then the others by decreasing duration. If the other
+ * iterator throws, the exception is rethrown after the symbols it returned
+ * before throwing.
+ */
+class LongestFirstDataInfoIterator : public DataInfoIterator {
+ public:
+  // the expected duration of a symbol, or < 0 if unknown
+  using Duration = std::function<double(const std::string& symbol)>;
+
+ private:
+  DataInfoIteratorPtr _symbols;
+  const Duration _duration;
+
+  std::mutex _mutex;
+  bool _ordered;
+  std::deque<DataInfoConstPtr> _next;
+  std::exception_ptr _error;
+
+ private:
+  void order() {
+    std::vector<std::pair<double, DataInfoConstPtr> > symbols;
+    try {
+      for (DataInfoConstPtr si = _symbols->getNext(); si.get() != 0; si = _symbols->getNext()) {
+        const double duration = _duration(si->symbol().symbol());
+        symbols.push_back(std::make_pair(duration < 0 ? std::numeric_limits<double>::infinity() : duration, si));
+      }
+    }
+    catch (...) {
+      _error = std::current_exception();
+    }
+    std::stable_sort(symbols.begin(), symbols.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (const auto& symbol : symbols) {
+      _next.push_back(symbol.second);
+    }
+    _ordered = true;
+  }
+
+ public:
+  LongestFirstDataInfoIterator(DataInfoIteratorPtr symbols, Duration duration) : _symbols(symbols), _duration(duration), _ordered(false) {
+    assert(_symbols);
+  }
+
+  DataInfoConstPtr getNext() override {
+    std::scoped_lock lock(_mutex);
+    if (!_ordered) {
+      order();
+    }
+    if (_next.empty()) {
+      if (_error) {
+        std::exception_ptr error = _error;
+        _error = nullptr;
+        std::rethrow_exception(error);
+      }
+      return DataInfoConstPtr();
+    }
+    DataInfoConstPtr si = _next.front();
+    _next.pop_front();
+    return si;
+  }
+};
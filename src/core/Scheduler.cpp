@@ -32,6 +32,7 @@ static char THIS_FILE[] = __FILE__;
 //////////////////////////////////////////////////////////////////////
 
 DataManager* _dataManager;
+WorkerPool* _workerPool;
 
 void thread_func(void* param) {
   AsynchRunInfo* p = reinterpret_cast<AsynchRunInfo*>(param);
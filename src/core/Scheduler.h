@@ -18,10 +18,15 @@
 
 #include "structuredexception.h"
 #include "moremiscwin.h"
+#include "DataPrefetcher.h"
+#include "RunProfile.h"
+#include "WorkerPool.h"
 #include <log.h>
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <future>
 #include <mutex>
 
@@ -92,6 +97,18 @@ class RunnableInfo {
 
   const ExplicitTrades* _explicitTrades;
 
+  // if set, the symbols and their data are taken from the prefetcher instead
+  // of _symbols
+  DataPrefetcherPtr _prefetcher;
+  // if set, the symbols are taken from here instead of _symbols - they are
+  // the same symbols, in the order they are to be run
+  DataInfoIteratorPtr _runSymbols;
+  // if set, receives the duration of each symbol
+  RunProfilePtr _profile;
+
+  // begin has been called and the runnable is iterating over the symbols
+  bool _begun;
+
  private:
   void addErrorEvent(ErrorEventPtr e) { _es->push(e); }
 
@@ -136,7 +153,8 @@ class RunnableInfo {
         _commission(commission),
         _runnableRunInfoHandler(runnableRunInfoHandler),
         _chartManager(chartManager),
-        _explicitTrades(explicitTrades) {
+        _explicitTrades(explicitTrades),
+        _begun(false) {
     assert(_symbols != 0);
     assert(_runnable != 0);
     assert(_es != 0);
@@ -156,7 +174,8 @@ class RunnableInfo {
         _signalHandlers(signalHandlers),
         _runnableRunInfoHandler(runnableRunInfoHandler),
         _chartManager(chartManager),
-        _explicitTrades(explicitTrades) {
+        _explicitTrades(explicitTrades),
+        _begun(false) {
     assert(_symbols != 0);
     assert(_runnable != 0);
     assert(_es != 0);
@@ -164,16 +183,29 @@ class RunnableInfo {
 
   virtual ~RunnableInfo() {}
 
-  void runSymbol(const std::string& threadName, DataInfoConstPtr si, DateTimeRangePtr range, PositionsContainer::PositionsContainerPtr pc, DateTime startTradesDateTime,
-    PositionsManagerImpl& pos ) {
+  const std::string& name() const { return _runnable->name(); }
+  DataInfoIteratorPtr symbols() const { return _symbols; }
+  // the symbols as they are to be run
+  DataInfoIteratorPtr runSymbols() const { return _runSymbols ? _runSymbols : _symbols; }
+  void setRunSymbols(DataInfoIteratorPtr symbols) { _runSymbols = symbols; }
+  void setPrefetcher(DataPrefetcherPtr prefetcher) { _prefetcher = prefetcher; }
+  void setProfile(RunProfilePtr profile) { _profile = profile; }
+  // the next step begins a new run, in case the previous one was canceled
+  void reset() { _begun = false; }
+
+  // prefetched is the data loaded by the prefetcher for si, or 0 if the data
+  // is to be loaded here
+  void runSymbol(const std::string& threadName, DataInfoConstPtr si, PrefetchedDataPtr prefetched, DateTimeRangePtr range, PositionsContainer::PositionsContainerPtr pc,
+    DateTime startTradesDateTime, PositionsManagerImpl& pos ) {
     chart::Chart* chart = 0;
     double dataDuration = 0;
+    double prefetchDuration = prefetched ? prefetched->duration() : 0;
     double runnableDuration = 0;
     unsigned __int64 dataSize = 0;
     bool exitCall = false;
     try {
       Timer dataTimer;
-      BarsPtr data = si->dataSource()->getData(si.get(), range)->getDataCollection();
+      BarsPtr data = prefetched ? prefetched->data() : _dataManager->getData(si.get(), range);
       if (data.get() != 0) {
         dataSize = data->size();
       }
@@ -254,7 +286,10 @@ class RunnableInfo {
       // we are here because there are no errors, so send the status
       if (_runnableRunInfoHandler != 0) {
         // there were no errors
-        _runnableRunInfoHandler->status(RunnableRunInfo(_runnable->name(), si->symbol().symbol(), dataDuration, runnableDuration, dataSize, false, threadName));
+        _runnableRunInfoHandler->status(RunnableRunInfo(_runnable->name(), si->symbol().symbol(), dataDuration, runnableDuration, dataSize, false, threadName, prefetchDuration));
+      }
+      if (_profile) {
+        _profile->record(_runnable->name(), si->symbol().symbol(), dataDuration + prefetchDuration + runnableDuration, dataSize);
       }
     }
     catch (const ExitRunnableException&) {
@@ -267,7 +302,7 @@ class RunnableInfo {
       // chart
       if (_runnableRunInfoHandler != 0) {
         // there were errors
-        _runnableRunInfoHandler->status(RunnableRunInfo(_runnable->name(), si->symbol().symbol(), dataDuration, runnableDuration, dataSize, true, threadName));
+        _runnableRunInfoHandler->status(RunnableRunInfo(_runnable->name(), si->symbol().symbol(), dataDuration, runnableDuration, dataSize, true, threadName, prefetchDuration));
       }
 
       // only stop charting if there were real errors, if it's an exit,
@@ -282,7 +317,8 @@ class RunnableInfo {
   }
 
   /**
-   * runs the Runnable on a range of the available data
+   * runs the Runnable on the next symbol of its list, on a range of the
+   * available data
    * If first initializes it with all the information such as the collection
    * of data elements on which to run it, the positions collection etc.
    *
@@ -293,96 +329,157 @@ class RunnableInfo {
    * This method also captures all runtime errors triggered by the Runnable and
    * sends them to the ErrroEventSink
    *
-   * The cancelStat is reference to a flag that indicates whether the Runnable
-   * should cancel its run. This flag is set if a cancel command is given by the
-   * user code
+   * The Runnable begin method is called before the first symbol, and its again
+   * method after the last one, as when the Runnable was run on all its symbols
+   * in one call. Each call runs one symbol so the scheduler can interleave the
+   * runnables on its threads, but a RunnableInfo must only be stepped by one
+   * thread at a time
+   *
+   * The cancelState is the cancellation token of the run, which is canceled if
+   * a cancel command is given by the user code
    *
    * @param cancelState
-   *               reference to flag indicating whether the Runnable should
-   * abort
+   *               the cancellation token of the run
    * @param range  The range of data on which to run the Runnable
-   * @return
+   * @return true if the Runnable has more symbols to run on, false if it is done
    * @exception DataSourceException
    */
-  bool run(const std::string& threadName, const std::atomic_bool& cancelState, DateTimeRangePtr range, DateTime startTradesDateTime){
-    do {
+  bool step(const std::string& threadName, const CancellationToken& cancelState, DateTimeRangePtr range, DateTime startTradesDateTime) {
+    if (!begin()) {
+      return false;
+    }
+
+    PrefetchedDataPtr prefetched;
+    DataInfoConstPtr si;
+    try {
+      prefetched = _prefetcher ? _prefetcher->getNext() : PrefetchedDataPtr();
+      si = _prefetcher ? (prefetched ? prefetched->dataInfo() : DataInfoConstPtr()) : runSymbols()->getNext();
+    }
+    catch (const DataInfoException&) {
+      dataInfoError();
+    }
+
+    if (si.get() == 0) {
+      // no more symbols - run again on all the symbols if the runnable
+      // returns true, indicating that it hasn't finished its work
+      _begun = false;
+      return _runnable->again();
+    }
+
+    return runOn(threadName, cancelState, si, prefetched, range, startTradesDateTime);
+  }
+
+  /**
+   * Calls the Runnable begin method if the Runnable is not iterating over the
+   * symbols already
+   *
+   * @return false if the Runnable is not to be run on any symbol
+   */
+  bool begin() {
+    if (!_begun) {
       // called before the first symbol, to signal that a new simulation session
       // is starting if false, then stop running this runnable
-      if (!_runnable->begin()) break;
+      _begun = _runnable->begin();
+    }
+    return _begun;
+  }
 
-      try {
-        for (DataInfoConstPtr si = _symbols->getNext(); si.get() != 0; si = _symbols->getNext()) {
-          Timer t;
-          //        std::auto_ptr< const SymbolInfo > psi( si );
-          // creating an empty  local list of positions, which will contain
-          // positions for the current run of the runnable.
-          PositionsContainer::PositionsContainerPtr pc = _pos.getNewPositionsContainer();
-          // creating a positions object, which will be passed to the runnable.
-          // This positions object contains a pointer to the positions list
-          // object
-          PositionsManagerImpl pos(pc, startTradesDateTime, PosInfinityDateTime(), _slippage, _commission);
-
-          pos.registerSignalHandlers(_signalHandlers);
-
-          // get the pointer to the bars object
-
-          try {
-              runSymbol( threadName, si, range, pc, startTradesDateTime, pos );
-          }
-          ERROR_EVENT_HANDLER(BarException, INVALID_DATA)
-          ERROR_EVENT_HANDLER(DataSourceException, DATA_SOURCE_ERROR)
-          ERROR_EVENT_HANDLER(GeneralSystemException, GENERAL_SYSTEM_ERROR)
-          ERROR_EVENT_HANDLER(PositionIdNotFoundException, POSITION_ID_NOT_FOUND_ERROR)
-          ERROR_EVENT_HANDLER(SystemException, GENERAL_SYSTEM_ERROR)
-          ERROR_EVENT_HANDLER(BarIndexOutOfRangeException, BAR_INDEX_OUT_OF_RANGE_ERROR)
-          ERROR_EVENT_HANDLER(InvalidLimitPriceException, INVALID_LIMIT_PRICE_ERROR)
-          ERROR_EVENT_HANDLER(InvalidStopPriceException, INVALID_STOP_PRICE_ERROR)
-          ERROR_EVENT_HANDLER(SeriesIndexOutOfRangeException, SERIES_INDEX_OUT_OF_RANGE_ERROR)
-          ERROR_EVENT_HANDLER(TimeSeriesIndexOutOfRangeException, TIME_SERIES_INDEX_OUT_OF_RANGE_ERROR)
-          ERROR_EVENT_HANDLER(SynchronizedSeriesIndexOutOfRangeException, SYNCHRONIZED_SERIES_INDEX_OUT_OF_RANGE_ERROR)
-          ERROR_EVENT_HANDLER(CoveringLongPositionException, COVERING_LONG_POSITION_ERROR)
-          ERROR_EVENT_HANDLER(SellingShortPositionException, SELLING_SHORT_POSITION_ERROR)
-          ERROR_EVENT_HANDLER(ClosingAlreadyClosedPositionException, CLOSING_ALREADY_CLOSED_POSITION_ERROR)
-          ERROR_EVENT_HANDLER(OperationOnUnequalSizeSeriesException, OPERATION_ON_UNEQUAL_SIZE_SERIES_ERROR)
-          catch (const DivideByZeroException& e) {
-            // dummy division with a NaN (not a number) result.
-            double x = 100.0 / 50.0;
-            ERROR_EVENT(FLOATING_POINT_DIVIDE_BY_0_ERROR);
-          }
-          ERROR_EVENT_HANDLER(AccessViolationException, ACCESS_VIOLATION_ERROR)
-          ERROR_EVENT_HANDLER(SignalHandlerException, SIGNAL_HANDLER_ERROR)
-          ERROR_EVENT_HANDLER(InvalidIndexForOperationException, INVALID_INDEX_FOR_OPERATION_EXCEPTION)
-          ERROR_EVENT_HANDLER(SeriesSynchronizerException, SERIES_SYNCHRONIZER_ERROR)
-          ERROR_EVENT_HANDLER(chart::ChartException, CHART_ERROR)
-          ERROR_EVENT_HANDLER(OperationOnSeriesSyncedToDifferentSynchronizers, OPERATION_ON_SERIES_SYNCED_TO_DIFFERENT_SYNCHRONIZERS_ERROR)
-          ERROR_EVENT_HANDLER(PositionCloseOperationOnOpenPositionException, POSITION_CLOSE_OPERATION_ON_OPEN_POSITION_ERROR)
-          ERROR_EVENT_HANDLER(PositionZeroPriceException, POSITION_ZERO_PRICE_ERROR)
-          ERROR_EVENT_HANDLER(OperationNotAllowedOnSynchronizedseriesException, OPERATION_NOT_ALLOWED_ON_SYNCHRONIZED_SERIES_ERROR)
-          catch (const ExitRunnableException& e) {
-            ERROR_EVENT(EXIT_STATMENT_CALL);
-            return false;
-          }
-          ERROR_EVENT_HANDLER(InvalidBarsCollectionException, INVALID_BARS_COLLECTION_ERROR)
-          ERROR_EVENT_HANDLER(ArrayIndexNotFoundException, ARRAY_INDEX_NOT_FOUND_ERROR)
-          ERROR_EVENT_HANDLER(DictionaryKeyNotFoundException, DICTIONARY_KEY_NOT_FOUND_ERROR)
-          ERROR_EVENT_HANDLER(InvalidPositionException, INVALID_POSITION_ERROR)
-          ERROR_EVENT_HANDLER(ClosingPostionOnDifferentSymbolException, CLOSING_POSITION_ON_DIFFERENT_SYMBOL_ERROR)
-          catch (...) {
-            // catch any other unhandled exceptions
-            ERROR_EVENT_MESSAGE_SYMBOL(UNKNOWN_APPLICATION_ERROR, "Unknown error", "");
-          }
-          // exit if cancel signaled
-          if (cancelState) return false;
-        }
-      }
-      catch (const DataInfoException&) {
-        ERROR_EVENT_MESSAGE_SYMBOL(DATA_INFO_ERROR, "Data info invalid, possibly a null symbol", "");
-      }
+  void dataInfoError() { ERROR_EVENT_MESSAGE_SYMBOL(DATA_INFO_ERROR, "Data info invalid, possibly a null symbol", ""); }
+
+  /**
+   * Reports the exception being handled, thrown by step or begin outside of a
+   * symbol run - by the Runnable begin or again methods or while getting the
+   * next symbol. Called from a catch block, after which the Runnable is not
+   * run anymore
+   */
+  void stepError() {
+    _begun = false;
+    try {
+      throw;
+    }
+    catch (const ExitRunnableException& e) {
+      ERROR_EVENT_MESSAGE_SYMBOL(EXIT_STATMENT_CALL, e.message(), "");
+    }
+    catch (const CoreException& e) {
+      ERROR_EVENT_MESSAGE_SYMBOL(GENERAL_SYSTEM_ERROR, e.message(), "");
+    }
+    catch (const std::exception& e) {
+      ERROR_EVENT_MESSAGE_SYMBOL(UNKNOWN_APPLICATION_ERROR, e.what(), "");
+    }
+    catch (...) {
+      ERROR_EVENT_MESSAGE_SYMBOL(UNKNOWN_APPLICATION_ERROR, "Unknown error", "");
     }
-    // repeats the loop until the runnable returns true, indicating that it has
-    // finished its work
-    while (_runnable->again());
-    return true;
+  }
+
+  /**
+   * runs the Runnable on one symbol, capturing all its runtime errors
+   *
+   * @param si         the symbol
+   * @param prefetched the data of the symbol, if already loaded, or 0
+   * @return false if the Runnable has called exit or the run is canceled
+   */
+  bool runOn(const std::string& threadName, const CancellationToken& cancelState, DataInfoConstPtr si, PrefetchedDataPtr prefetched, DateTimeRangePtr range,
+             DateTime startTradesDateTime) {
+    //        std::auto_ptr< const SymbolInfo > psi( si );
+    // creating an empty  local list of positions, which will contain
+    // positions for the current run of the runnable.
+    PositionsContainer::PositionsContainerPtr pc = _pos.getNewPositionsContainer();
+    // creating a positions object, which will be passed to the runnable.
+    // This positions object contains a pointer to the positions list
+    // object
+    PositionsManagerImpl pos(pc, startTradesDateTime, PosInfinityDateTime(), _slippage, _commission);
+
+    pos.registerSignalHandlers(_signalHandlers);
+
+    // get the pointer to the bars object
+
+    try {
+      runSymbol( threadName, si, prefetched, range, pc, startTradesDateTime, pos );
+    }
+    ERROR_EVENT_HANDLER(BarException, INVALID_DATA)
+    ERROR_EVENT_HANDLER(DataSourceException, DATA_SOURCE_ERROR)
+    ERROR_EVENT_HANDLER(GeneralSystemException, GENERAL_SYSTEM_ERROR)
+    ERROR_EVENT_HANDLER(PositionIdNotFoundException, POSITION_ID_NOT_FOUND_ERROR)
+    ERROR_EVENT_HANDLER(SystemException, GENERAL_SYSTEM_ERROR)
+    ERROR_EVENT_HANDLER(BarIndexOutOfRangeException, BAR_INDEX_OUT_OF_RANGE_ERROR)
+    ERROR_EVENT_HANDLER(InvalidLimitPriceException, INVALID_LIMIT_PRICE_ERROR)
+    ERROR_EVENT_HANDLER(InvalidStopPriceException, INVALID_STOP_PRICE_ERROR)
+    ERROR_EVENT_HANDLER(SeriesIndexOutOfRangeException, SERIES_INDEX_OUT_OF_RANGE_ERROR)
+    ERROR_EVENT_HANDLER(TimeSeriesIndexOutOfRangeException, TIME_SERIES_INDEX_OUT_OF_RANGE_ERROR)
+    ERROR_EVENT_HANDLER(SynchronizedSeriesIndexOutOfRangeException, SYNCHRONIZED_SERIES_INDEX_OUT_OF_RANGE_ERROR)
+    ERROR_EVENT_HANDLER(CoveringLongPositionException, COVERING_LONG_POSITION_ERROR)
+    ERROR_EVENT_HANDLER(SellingShortPositionException, SELLING_SHORT_POSITION_ERROR)
+    ERROR_EVENT_HANDLER(ClosingAlreadyClosedPositionException, CLOSING_ALREADY_CLOSED_POSITION_ERROR)
+    ERROR_EVENT_HANDLER(OperationOnUnequalSizeSeriesException, OPERATION_ON_UNEQUAL_SIZE_SERIES_ERROR)
+    catch (const DivideByZeroException& e) {
+      // dummy division with a NaN (not a number) result.
+      double x = 100.0 / 50.0;
+      ERROR_EVENT(FLOATING_POINT_DIVIDE_BY_0_ERROR);
+    }
+    ERROR_EVENT_HANDLER(AccessViolationException, ACCESS_VIOLATION_ERROR)
+    ERROR_EVENT_HANDLER(SignalHandlerException, SIGNAL_HANDLER_ERROR)
+    ERROR_EVENT_HANDLER(InvalidIndexForOperationException, INVALID_INDEX_FOR_OPERATION_EXCEPTION)
+    ERROR_EVENT_HANDLER(SeriesSynchronizerException, SERIES_SYNCHRONIZER_ERROR)
+    ERROR_EVENT_HANDLER(chart::ChartException, CHART_ERROR)
+    ERROR_EVENT_HANDLER(OperationOnSeriesSyncedToDifferentSynchronizers, OPERATION_ON_SERIES_SYNCED_TO_DIFFERENT_SYNCHRONIZERS_ERROR)
+    ERROR_EVENT_HANDLER(PositionCloseOperationOnOpenPositionException, POSITION_CLOSE_OPERATION_ON_OPEN_POSITION_ERROR)
+    ERROR_EVENT_HANDLER(PositionZeroPriceException, POSITION_ZERO_PRICE_ERROR)
+    ERROR_EVENT_HANDLER(OperationNotAllowedOnSynchronizedseriesException, OPERATION_NOT_ALLOWED_ON_SYNCHRONIZED_SERIES_ERROR)
+    catch (const ExitRunnableException& e) {
+      ERROR_EVENT(EXIT_STATMENT_CALL);
+      return false;
+    }
+    ERROR_EVENT_HANDLER(InvalidBarsCollectionException, INVALID_BARS_COLLECTION_ERROR)
+    ERROR_EVENT_HANDLER(ArrayIndexNotFoundException, ARRAY_INDEX_NOT_FOUND_ERROR)
+    ERROR_EVENT_HANDLER(DictionaryKeyNotFoundException, DICTIONARY_KEY_NOT_FOUND_ERROR)
+    ERROR_EVENT_HANDLER(InvalidPositionException, INVALID_POSITION_ERROR)
+    ERROR_EVENT_HANDLER(ClosingPostionOnDifferentSymbolException, CLOSING_POSITION_ON_DIFFERENT_SYMBOL_ERROR)
+    catch (...) {
+      // catch any other unhandled exceptions
+      ERROR_EVENT_MESSAGE_SYMBOL(UNKNOWN_APPLICATION_ERROR, "Unknown error", "");
+    }
+    // exit if cancel signaled
+    return !cancelState;
   }
 };
 
@@ -393,15 +490,6 @@ class RunnableInfo {
  * This is used by the Scheduler to store RunnableInfo instances created when
  * the user code adds new Runnable instances to the Scheduler
  *
- * A RunnableInfoList stores a reference to a "current" RunnableInfo, and has
- * a getNext method, both of which are used to iterate through the list
- * of all RunnableInfo instances and run the associated Runnable.
- *
- * This class is thread safe, in that different threads can call its methods
- * simultaneously and the access to data will be safely serialized. This is
- * necessary as each thread will have to call into this class to get the next
- * RunnableInfo that has the info for the Runnable to be run.
- *
  * @see PVector
  * @see RunnableInfo
  * @see Scheduler
@@ -409,67 +497,430 @@ class RunnableInfo {
 class RunnableInfoList : public PtrVector<RunnableInfo> {
   OBJ_COUNTER(RunnableInfoList)
  private:
-  unsigned int _crt;
-  mutable std::mutex _mutex;
   const std::string _name;
 
  public:
   /**
    * Constructor - takes the name
    *
-   * Also resets the "current" value to point to the first element in the list
-   *
    * @param name   The name
    */
-  RunnableInfoList(const std::string& name) : _crt(0), _name(name) {}
+  RunnableInfoList(const std::string& name) : _name(name) {}
+};
 
-  void reset() {
-    std::scoped_lock lock(_mutex);
-    _crt = 0;
+/**
+ * The runnables waiting to be run on their next symbol, in one deque per
+ * thread.
+ *
+ * The unit of work is one runnable on one symbol: a thread takes a runnable,
+ * runs it on its next symbol and puts it back at the back of its own deque, so
+ * it keeps running the same runnable while the runnable's code and data are
+ * hot. A thread whose deque is empty steals the runnable at the front of
+ * another thread's deque, so all the threads stay busy until there are fewer
+ * runnables with symbols left than threads.
+ *
+ * A runnable is in at most one deque, or is being run by one thread, so a
+ * Runnable instance is never run by two threads at the same time
+ *
+ * @see RunnableThread
+ */
+class RunnableQueues {
+ private:
+  struct Queue {
+    std::mutex _mutex;
+    std::deque<std::shared_ptr<RunnableInfo> > _runnables;
+  };
+
+  std::vector<std::unique_ptr<Queue> > _queues;
+
+  std::mutex _mutex;
+  // signaled when a runnable is put back in a deque, is done, or the run is
+  // canceled
+  std::condition_variable _changed;
+  // the runnables in the deques
+  size_t _queued;
+  // the runnables that are not done, in the deques or being run
+  size_t _active;
+  bool _stopped;
+
+ private:
+  std::shared_ptr<RunnableInfo> take(size_t thread) {
+    // the back of the thread's own deque first
+    {
+      Queue& queue = *_queues[thread];
+      std::scoped_lock lock(queue._mutex);
+      if (!queue._runnables.empty()) {
+        std::shared_ptr<RunnableInfo> runnable = queue._runnables.back();
+        queue._runnables.pop_back();
+        return runnable;
+      }
+    }
+    // then the front of the other threads' deques
+    for (size_t n = 1; n < _queues.size(); ++n) {
+      Queue& queue = *_queues[(thread + n) % _queues.size()];
+      std::scoped_lock lock(queue._mutex);
+      if (!queue._runnables.empty()) {
+        std::shared_ptr<RunnableInfo> runnable = queue._runnables.front();
+        queue._runnables.pop_front();
+        return runnable;
+      }
+    }
+    return 0;
+  }
+
+ public:
+  /**
+   * Distributes the runnables to the threads' deques, round robin
+   */
+  RunnableQueues(const RunnableInfoList& runnables, size_t threads) : _queued(runnables.size()), _active(runnables.size()), _stopped(false) {
+    for (size_t n = 0; n < (std::max)(threads, (size_t)1); ++n) {
+      _queues.push_back(std::make_unique<Queue>());
+    }
+    for (size_t n = 0; n < runnables.size(); ++n) {
+      _queues[n % _queues.size()]->_runnables.push_back(runnables[n]);
+    }
+  }
+
+  /**
+   * Returns the next runnable to be run by a thread, waiting for one if all the
+   * remaining runnables are being run by other threads, or 0 if there are no
+   * more runnables to run
+   */
+  std::shared_ptr<RunnableInfo> pop(size_t thread) {
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _changed.wait(lock, [this]() -> bool { return _stopped || _active == 0 || _queued > 0; });
+        if (_stopped || _active == 0) {
+          return 0;
+        }
+      }
+
+      std::shared_ptr<RunnableInfo> runnable = take(thread);
+      if (runnable) {
+        std::scoped_lock lock(_mutex);
+        --_queued;
+        return runnable;
+      }
+      // another thread took the last queued runnable, wait again
+    }
   }
 
   /**
-   * Returns the next available RunnableInfo and increments the "current" value
-   * to point to the following one.
+   * Puts a runnable that has more symbols to run on back in the thread's deque
+   */
+  void push(size_t thread, std::shared_ptr<RunnableInfo> runnable) {
+    {
+      Queue& queue = *_queues[thread];
+      std::scoped_lock lock(queue._mutex);
+      queue._runnables.push_back(runnable);
+    }
+    {
+      std::scoped_lock lock(_mutex);
+      ++_queued;
+    }
+    _changed.notify_one();
+  }
+
+  /**
+   * Signals that a runnable taken by pop has finished its run
+   */
+  void done() {
+    {
+      std::scoped_lock lock(_mutex);
+      --_active;
+    }
+    _changed.notify_all();
+  }
+
+  /**
+   * Stops the run, pop returns 0 from now on
+   */
+  void stop() {
+    {
+      std::scoped_lock lock(_mutex);
+      _stopped = true;
+    }
+    _changed.notify_all();
+  }
+};
+
+/**
+ * The instances of a system (the runnables sharing a symbols iterator) not
+ * being run by a thread, for symbol-major runs
+ */
+class RunnableInstances {
+ private:
+  std::mutex _mutex;
+  // signaled when an instance is released
+  std::condition_variable _released;
+  std::vector<std::shared_ptr<RunnableInfo> > _free;
+  // the instances that are still running, free or not
+  size_t _count;
+  // the names of the runnables, for the run profile
+  std::set<std::string> _names;
+
+ public:
+  RunnableInstances() : _count(0) {}
+
+  void add(std::shared_ptr<RunnableInfo> runnable) {
+    _free.push_back(runnable);
+    _names.insert(runnable->name());
+    ++_count;
+  }
+
+  const std::set<std::string>& names() const { return _names; }
+
+  /**
+   * Returns a free instance, waiting for one if all are being run by other
+   * threads, or 0 if all the instances have finished their run
+   */
+  std::shared_ptr<RunnableInfo> acquire() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _released.wait(lock, [this]() -> bool { return !_free.empty() || _count == 0; });
+    if (_free.empty()) {
+      return 0;
+    }
+    std::shared_ptr<RunnableInfo> runnable = _free.back();
+    _free.pop_back();
+    return runnable;
+  }
+
+  /**
+   * Returns an instance taken by acquire
    *
-   * if there are no more RunnableInfo in the collection, return null.
+   * @param done   true if the instance has finished its run (begin returned
+   *               false or it called exit) and is not to be run anymore
+   */
+  void release(std::shared_ptr<RunnableInfo> runnable, bool done) {
+    {
+      std::scoped_lock lock(_mutex);
+      if (done) {
+        --_count;
+      }
+      else {
+        _free.push_back(runnable);
+      }
+    }
+    _released.notify_all();
+  }
+};
+
+/**
+ * A symbol-major run: the threads take the symbols one by one, load the data
+ * of each symbol once and run all the systems that have the symbol on it back
+ * to back, so the bars and the indicators the systems have in common are still
+ * in the series cache and in the processor caches when the next system uses
+ * them.
+ *
+ * The symbols of all the systems' iterators are read when the run is created.
+ * A symbol returned by several iterators is run once, on all their systems,
+ * and each system is run only on the symbols of its own iterator, by one of
+ * its instances. The runnables' begin method is called before their first
+ * symbol, but as there is only one pass over the symbols, their again method
+ * is not called
+ *
+ * @see Scheduler::setSymbolMajor
+ */
+class SymbolMajorRun {
+ private:
+  /**
+   * Returns the symbols of the run, in the order they are to be run
+   */
+  class Symbols : public DataInfoIterator {
+   private:
+    std::mutex _mutex;
+    std::deque<DataInfoConstPtr> _next;
+
+   public:
+    Symbols(std::deque<DataInfoConstPtr>&& symbols) : _next(std::move(symbols)) {}
+
+    DataInfoConstPtr getNext() override {
+      std::scoped_lock lock(_mutex);
+      if (_next.empty()) {
+        return DataInfoConstPtr();
+      }
+      DataInfoConstPtr si = _next.front();
+      _next.pop_front();
+      return si;
+    }
+  };
+
+  // one entry per system, in the order the runnables were added
+  std::vector<std::unique_ptr<RunnableInstances> > _systems;
+  // the systems to run on each symbol, set on creation and only read by the
+  // threads after that
+  std::map<const DataInfo*, std::vector<RunnableInstances*> > _symbolSystems;
+  std::shared_ptr<Symbols> _symbols;
+  DataPrefetcherPtr _prefetcher;
+
+ public:
+  /**
+   * @param runnables  the runnables, grouped in systems by symbols iterator
+   * @param profile    the run profile, to run the symbols longest first, or 0
+   *                   to run them in the order of the iterators
+   */
+  SymbolMajorRun(const RunnableInfoList& runnables, RunProfilePtr profile) {
+    std::map<DataInfoIterator*, RunnableInstances*> systems;
+    std::vector<std::pair<DataInfoIteratorPtr, std::shared_ptr<RunnableInfo> > > iterators;
+    for (auto runnable : runnables) {
+      RunnableInstances*& instances = systems[runnable->symbols().get()];
+      if (instances == 0) {
+        _systems.push_back(std::make_unique<RunnableInstances>());
+        instances = _systems.back().get();
+        iterators.push_back(std::make_pair(runnable->symbols(), runnable));
+      }
+      instances->add(runnable);
+    }
+
+    // the symbols of all the iterators, each with the systems to run on it
+    std::vector<std::pair<DataInfoConstPtr, std::vector<RunnableInstances*> > > symbols;
+    std::map<std::pair<const DataSource*, std::string>, size_t> found;
+    for (size_t n = 0; n < iterators.size(); ++n) {
+      try {
+        DataInfoIterator& iterator = *iterators[n].first;
+        for (DataInfoConstPtr si = iterator.getNext(); si.get() != 0; si = iterator.getNext()) {
+          const auto [i, added] = found.insert(std::make_pair(std::make_pair(si->dataSource(), si->symbol().symbol()), symbols.size()));
+          if (added) {
+            symbols.push_back(std::make_pair(si, std::vector<RunnableInstances*>()));
+          }
+          symbols[i->second].second.push_back(_systems[n].get());
+        }
+      }
+      catch (const DataInfoException&) {
+        // the system is run on the symbols before the invalid one
+        iterators[n].second->dataInfoError();
+      }
+    }
+
+    if (profile) {
+      // the duration of a symbol is that of all the systems run on it
+      std::vector<double> durations;
+      for (const auto& symbol : symbols) {
+        double duration = 0;
+        for (const RunnableInstances* instances : symbol.second) {
+          for (const std::string& name : instances->names()) {
+            const double d = profile->estimate(name, symbol.first->symbol().symbol());
+            // unknown durations first, as in LongestFirstDataInfoIterator
+            duration += d < 0 ? std::numeric_limits<double>::infinity() : d;
+          }
+        }
+        durations.push_back(duration);
+      }
+      std::vector<size_t> order(symbols.size());
+      for (size_t n = 0; n < order.size(); ++n) {
+        order[n] = n;
+      }
+      std::stable_sort(order.begin(), order.end(), [&durations](size_t a, size_t b) { return durations[a] > durations[b]; });
+      std::vector<std::pair<DataInfoConstPtr, std::vector<RunnableInstances*> > > ordered;
+      for (size_t n : order) {
+        ordered.push_back(std::move(symbols[n]));
+      }
+      symbols.swap(ordered);
+    }
+
+    std::deque<DataInfoConstPtr> next;
+    for (auto& symbol : symbols) {
+      next.push_back(symbol.first);
+      _symbolSystems[symbol.first.get()] = std::move(symbol.second);
+    }
+    _symbols = std::make_shared<Symbols>(std::move(next));
+  }
+
+  /**
+   * The symbols of the run, in the order they are run
+   */
+  DataInfoIteratorPtr symbols() const { return _symbols; }
+
+  /**
+   * Sets the prefetcher that loads the data of the symbols ahead, or 0 to load
+   * it on the runnable threads. The prefetcher iterates over symbols()
+   */
+  void setPrefetcher(DataPrefetcherPtr prefetcher) { _prefetcher = prefetcher; }
+
+  /**
+   * Runs the systems of the next symbol on it
    *
-   * @return A pointer to a RunnableInfo or 0 if no more available
+   * @return false if there are no more symbols
    */
-  std::shared_ptr< RunnableInfo > getNext() {
-    std::scoped_lock lock(_mutex);
+  bool runNext(const std::string& threadName, const CancellationToken& cancelState, DateTimeRangePtr range, DateTime startTradesDateTime) {
+    PrefetchedDataPtr data;
+    if (_prefetcher) {
+      data = _prefetcher->getNext();
+    }
+    else {
+      DataInfoConstPtr si = _symbols->getNext();
+      if (si.get() != 0) {
+        data = std::make_shared<PrefetchedData>(si);
+        data->load(range);
+      }
+    }
+    if (!data) {
+      return false;
+    }
 
-    std::shared_ptr< RunnableInfo > p = _crt < size() ? at(_crt++) : 0;
-    return p;
+    bool first = true;
+    for (RunnableInstances* instances : _symbolSystems.at(data->dataInfo().get())) {
+      std::shared_ptr<RunnableInfo> runnable = instances->acquire();
+      if (runnable) {
+        // each system runs on its own copy of the bars, as a system can
+        // synchronize them. The other copies are requested from the data
+        // manager, which has the bars of the symbol in its cache
+        PrefetchedDataPtr systemData = data;
+        if (!first) {
+          systemData = std::make_shared<PrefetchedData>(data->dataInfo());
+          systemData->load(range);
+        }
+        first = false;
+
+        bool running = false;
+        try {
+          running = runnable->begin() && runnable->runOn(threadName, cancelState, data->dataInfo(), systemData, range, startTradesDateTime);
+        }
+        catch (...) {
+          // begin threw, the instance is released as done so the threads
+          // waiting for it don't wait forever
+          runnable->stepError();
+        }
+        instances->release(runnable, !running && !cancelState);
+      }
+      if (cancelState) {
+        return false;
+      }
+    }
+    return true;
   }
 };
 
 /**
  * This implements a thread of execution for Runnable instances.
  *
- * Each new thread created by the Scheduler will have a RunnableThread object
- * associated
+ * Each thread of a run is a RunnableThread object, run as a task by the
+ * process wide WorkerPool
  *
  * The thread runs in the operator() method of this object.
  *
  * A RunnableThread has
- * - a reference to a RunnableInfoList where it will get the next
+ * - a reference to the RunnableQueues where it will get the next
  * RunnableInfo to run.
  * - the name of the thread
  * - the range on which to run all Runnable instances in the current thread
  * - a ThreadInitializer, used to do a one time thread initialization.
  *
  * @see Scheduler
- * @see RunnableInfoList
+ * @see RunnableQueues
  * @see SynchronizedFlag
  * @see Range
  */
 class RunnableThread {
  private:
-  RunnableInfoList& _runnables;
+  // the runnables for a runnable-major run, or 0
+  RunnableQueues* _runnables;
+  // the symbols for a symbol-major run, or 0
+  SymbolMajorRun* _symbols;
   const unsigned int _index;
   const std::string _name;
-  const std::atomic_bool& _cancelState;
+  const CancellationToken& _cancelState;
   DateTimeRangePtr _range;
   const DateTime _startTradesDateTime;
   ThreadInitializer* _threadInitializer;
@@ -480,22 +931,25 @@ class RunnableThread {
    * Constructor - takes all parameters needed to intialize the object as
    * parameters
    *
-   * @param systems Reference to the RunnableInfoList object
+   * @param systems Pointer to the RunnableQueues object, or 0 for a
+   * symbol-major run
+   * @param symbols Pointer to the SymbolMajorRun object, or 0 for a
+   * runnable-major run
    * @param name    The name of the thread
    * @param cancelState
-   *                Reference to the cancelState flag indicating whether to
-   * abort or not
+   *                Reference to the cancellation token of the run
    * @param range   Pointer to a range object
    * @param threadInitializer
    *                pointer to a thread initializer
    * @see ThreadInitializer
    * @see Range
    * @see SynchronizedFlag
-   * @see RunnableInfoList
+   * @see RunnableQueues
    */
-  RunnableThread(RunnableInfoList& systems, unsigned int index, const std::string& name, const std::atomic_bool& cancelState,
+  RunnableThread(RunnableQueues* systems, SymbolMajorRun* symbols, unsigned int index, const std::string& name, const CancellationToken& cancelState,
                  DateTimeRangePtr range, ThreadInitializer* threadInitializer, bool cpuAffinity, DateTime startTradesDateTime)
       : _runnables(systems),
+        _symbols(symbols),
         _index(index),
         _name(name),
         _cancelState(cancelState),
@@ -509,55 +963,69 @@ class RunnableThread {
   /**
    * operator() - called when the new thread starts/
    *
-   * This function gets called when the thread starts. It will iterate through
-   * the list of RunnableInfo until the iterator points to the end of the list.
-   *
-   * For each RunnableInfo in the list it will run the associated Runnable.
+   * This function gets called when the thread starts. It takes runnables from
+   * the RunnableQueues and runs each on its next symbol, until there are no
+   * more runnables with symbols left to run on.
    *
-   * Multiple threads will iterate through the same list, so each thread will
-   * get to run only a subset of all the RunnableInfo instances in the list.
+   * All the threads take runnables from the same RunnableQueues, so a thread
+   * that has run out of runnables steals them from the other threads, and all
+   * threads created by a Scheduler will be busy until there are no more symbols
+   * to run on.
    *
-   * Because of this algorithm, all threads created by a Scheduler will be busy
-   * until the itertor points to the end of the list, meaning that all the
-   * Runnable have been run.
+   * A runnable is run on one symbol at a time, so in order to run one system on
+   * multiple symbols at the same time, create multiple instances of the same
+   * runnable and use one symbols list iterator for all of them
    *
-   * In order to run one runnable in multiple threads, create multiple instances
-   * of the same runnable and use one symbols list iterator for all of them
+   * In a symbol-major run, the threads take symbols from the SymbolMajorRun
+   * instead, and run all the systems on each symbol
    *
-   * @see The thread function.
-   * @see This operator gets called when the thread starts. It will iterate
-   * through the
-   * @see list of RunnableInfo and for each RunnableInfo will run the associated
-   * Runnable.
-   * @see Multiple threads will iterate through the same lists
+   * @see RunnableQueues
    */
   void operator()() {
+    // a pinned thread keeps its processor caches, and what it allocates and
+    // first touches is usually on its NUMA node. The bars it runs on may have
+    // been loaded by other threads, on another node
     if (_cpuAffinity) {
-      setCurrentThreadIdealProcessor(_index);
-    }
-    if (_threadInitializer != 0) {
-      _threadInitializer->init();
+      setCurrentThreadAffinity(_index);
     }
+    // for the whole run, see ThreadInit
+    ThreadInit init(_threadInitializer);
     StructuredException::install();
-    bool f = true;
 
-    for (std::shared_ptr< RunnableInfo > si = _runnables.getNext(); si != 0 && f; si = _runnables.getNext()) {
-      f = si->run(_name, _cancelState, _range, _startTradesDateTime);
+    if (_symbols != 0) {
+      while (_symbols->runNext(_name, _cancelState, _range, _startTradesDateTime)) {
+      }
+    }
+    else {
+      for (std::shared_ptr< RunnableInfo > si = _runnables->pop(_index); si != 0; si = _runnables->pop(_index)) {
+        bool more = false;
+        try {
+          more = si->step(_name, _cancelState, _range, _startTradesDateTime);
+        }
+        catch (...) {
+          // thrown outside of the symbol run, which reports its own errors -
+          // the runnable is done, so the other threads don't wait for it
+          si->stepError();
+        }
+        if (more) {
+          _runnables->push(_index, si);
+        }
+        else {
+          _runnables->done();
+        }
+        if (_cancelState) {
+          _runnables->stop();
+        }
+      }
     }
 
-    if (_threadInitializer != 0) {
-      _threadInitializer->uninit();
+    // the thread is a pool worker, which will run other tasks
+    if (_cpuAffinity) {
+      resetCurrentThreadAffinity();
     }
   }
 };
 
-/**
- * Definition of a ThreadVector
- *
- * @see RunnableThread
- * @see PtrVector
- */
-using ThreadVector = PtrVector<RunnableThread>;
 /**
  * Prototype for the actual thread function that will be called when the
  * Runnable are run in asyncronous mode
@@ -650,10 +1118,16 @@ class SchedulerImpl : public Scheduler {
   mutable std::mutex m_mx;
   mutable std::condition_variable m_condition;
 
-  std::atomic_bool _cancelState = false;
+  // the cancellation token of the current run, or 0 if not running
+  CancellationTokenPtr _cancelToken;
+  mutable std::mutex _cancelMutex;
   std::atomic_bool _running = false ;
   ThreadInitializer* _threadInitializer;
   RunEventHandler* _runEventHandler;
+  unsigned int _prefetchDepth;
+  unsigned int _prefetchThreads;
+  bool _symbolMajor;
+  std::string _runProfile;
 
   // a set of all signal handlers for the session. There are no duplicates here,
   // so if each runnable sends signals to the same signal handler, there will
@@ -680,7 +1154,10 @@ class SchedulerImpl : public Scheduler {
   SchedulerImpl(RunEventHandler* runEventHandler = 0)
       : _runnables("Systems"),
         _threadInitializer(0),
-        _runEventHandler(runEventHandler) {}
+        _runEventHandler(runEventHandler),
+        _prefetchDepth(DEFAULT_PREFETCH_DEPTH),
+        _prefetchThreads(DEFAULT_PREFETCH_THREADS),
+        _symbolMajor(false) {}
 
   virtual ~SchedulerImpl() {}
 
@@ -760,6 +1237,15 @@ class SchedulerImpl : public Scheduler {
 
   void resetRunnables() { _runnables.clear(); }
 
+  void setPrefetch(unsigned int depth, unsigned int threads) override {
+    _prefetchDepth = depth;
+    _prefetchThreads = threads;
+  }
+
+  void setSymbolMajor(bool symbolMajor) override { _symbolMajor = symbolMajor; }
+
+  void setRunProfile(const std::string& fileName) override { _runProfile = fileName; }
+
   /**
    * Indicates the status running or resting of the scheduler.
    *
@@ -772,7 +1258,10 @@ class SchedulerImpl : public Scheduler {
    *
    * @return Returns true if it's canceling, false otherwise
    */
-  bool isCanceling() const { return _cancelState; }
+  bool isCanceling() const {
+    std::scoped_lock lock(_cancelMutex);
+    return _cancelToken && _cancelToken->isCanceled();
+  }
 
   /**
    * Starts running the Runnable objects in the list of runnables
@@ -794,8 +1283,18 @@ class SchedulerImpl : public Scheduler {
     }
 
     _running = true;
+    {
+      std::scoped_lock lock(_cancelMutex);
+      _cancelToken = std::make_shared<CancellationToken>();
+    }
     if (asynch) {
-      _beginthread(thread_func, 0, new AsynchRunInfo(this, threads, cpuAffinity, range, startTradesDateTime));
+      AsynchRunInfo* info = new AsynchRunInfo(this, threads, cpuAffinity, range, startTradesDateTime);
+      if (_workerPool != 0) {
+        _workerPool->submit([info]() { thread_func(info); });
+      }
+      else {
+        _beginthread(thread_func, 0, info);
+      }
     }
     else {
       run(threads, cpuAffinity, range, startTradesDateTime);
@@ -823,7 +1322,12 @@ class SchedulerImpl : public Scheduler {
    * immediately, without waiting for the run to be canceled
    */
   void cancelAsync() override {
-    _cancelState = true;
+    {
+      std::scoped_lock lock(_cancelMutex);
+      if (_cancelToken) {
+        _cancelToken->cancel();
+      }
+    }
     if (_runEventHandler != 0) {
       _runEventHandler->runCanceled();
     }
@@ -837,18 +1341,107 @@ class SchedulerImpl : public Scheduler {
 
     // only run if there are no errors
     _running = true;
-    _runnables.reset();
-    boost::thread_group _threads;
-    ThreadVector _threadVector;
+    CancellationTokenPtr cancelToken;
+    {
+      std::scoped_lock lock(_cancelMutex);
+      assert(_cancelToken);
+      cancelToken = _cancelToken;
+    }
+
+    for (auto runnable : _runnables) {
+      runnable->reset();
+    }
+
+    // with a run profile, each symbols iterator returns its symbols longest
+    // first, the duration of a symbol being that of all the systems using the
+    // iterator. A symbol-major run orders the symbols of all the iterators
+    // itself
+    RunProfilePtr profile;
+    if (!_runProfile.empty()) {
+      profile = std::make_shared<RunProfile>(_runProfile);
+      for (auto runnable : _runnables) {
+        runnable->setProfile(profile);
+      }
+    }
+    if (profile && !_symbolMajor) {
+      std::map<DataInfoIterator*, std::set<std::string> > systems;
+      for (auto runnable : _runnables) {
+        systems[runnable->symbols().get()].insert(runnable->name());
+      }
+      std::map<DataInfoIterator*, DataInfoIteratorPtr> runSymbols;
+      for (auto runnable : _runnables) {
+        DataInfoIteratorPtr& symbols = runSymbols[runnable->symbols().get()];
+        if (!symbols) {
+          const std::set<std::string> names(systems[runnable->symbols().get()]);
+          symbols = std::make_shared<LongestFirstDataInfoIterator>(runnable->symbols(), [profile, names](const std::string& symbol) {
+            double duration = 0;
+            for (const auto& name : names) {
+              const double d = profile->estimate(name, symbol);
+              if (d < 0) {
+                return -1.0;
+              }
+              duration += d;
+            }
+            return duration;
+          });
+        }
+        runnable->setRunSymbols(symbols);
+      }
+    }
+
+    // a symbol-major run reads the symbols of all the iterators when created,
+    // so it is only created in symbol-major mode
+    std::unique_ptr<SymbolMajorRun> symbols;
+    if (_symbolMajor) {
+      symbols = std::make_unique<SymbolMajorRun>(_runnables, profile);
+    }
+
+    // one prefetcher per symbols iterator, shared by all the runnables using
+    // that iterator, or one for the symbols of a symbol-major run
+    std::map<DataInfoIterator*, DataPrefetcherPtr> prefetchers;
+    DataPrefetcherPtr symbolMajorPrefetcher;
+    if (_prefetchDepth > 0 && symbols) {
+      symbolMajorPrefetcher = std::make_shared<DataPrefetcher>(symbols->symbols(), range, _prefetchDepth, _prefetchThreads, _threadInitializer);
+      symbols->setPrefetcher(symbolMajorPrefetcher);
+    }
+    else if (_prefetchDepth > 0) {
+      for (auto runnable : _runnables) {
+        DataPrefetcherPtr& prefetcher = prefetchers[runnable->symbols().get()];
+        if (!prefetcher) {
+          prefetcher = std::make_shared<DataPrefetcher>(runnable->runSymbols(), range, _prefetchDepth, _prefetchThreads, _threadInitializer);
+        }
+        runnable->setPrefetcher(prefetcher);
+      }
+    }
 
+    RunnableQueues queues(_runnables, threads);
+    // the run threads are tasks of the process wide worker pool
+    TaskGroup tasks(_workerPool);
     for (unsigned int n = 0; n < threads; n++) {
-      _threadVector.push_back(std::make_shared< RunnableThread >( _runnables, n, std::to_string(n), _cancelState, range, _threadInitializer, cpuAffinity, startTradesDateTime) );
-      _threads.create_thread( *_threadVector.back());
+      auto thread = std::make_shared< RunnableThread >( symbols ? 0 : &queues, symbols.get(), n, std::to_string(n), *cancelToken, range, _threadInitializer, cpuAffinity, startTradesDateTime);
+      tasks.run([thread]() { (*thread)(); });
+    }
+    tasks.wait();
+
+    for (auto runnable : _runnables) {
+      runnable->setPrefetcher(0);
+      runnable->setRunSymbols(0);
+      runnable->setProfile(0);
+    }
+    // stops the prefetch threads
+    prefetchers.clear();
+    if (symbolMajorPrefetcher) {
+      symbolMajorPrefetcher->stop();
+    }
+    if (profile) {
+      profile->save();
     }
-    _threads.join_all();
 
     _running = false;
-    _cancelState = false;
+    {
+      std::scoped_lock lock(_cancelMutex);
+      _cancelToken.reset();
+    }
     m_condition.notify_all();
 
     LOG(log_debug, "session ended");
@@ -0,0 +1,242 @@
+/*
+   Copyright (C) 2018-2020 Adrian Michel
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "seriesimpl.h"
+#include "indicators.h"
+#include "seriesexpression.h"
+
+extern SeriesCache* _cache;
+
+using tradery::kernels::BinaryOp;
+
+namespace {
+/**
+ * The ids of the arithmetic operations are the same as those used by the
+ * eager operations, so both share the cached results
+ */
+struct OpNames {
+  const char* seriesSeries;
+  const char* seriesValue;
+  const char* valueSeries;
+};
+
+const OpNames& opNames(BinaryOp op) {
+  static const OpNames names[] = {
+    { "add", "add value", "add value" },
+    { "subtract", "subtract value", "subtract from value" },
+    { "multiply", "multiply by value", "multiply by value" },
+    { "divide", "divide by value", "divide value by" },
+    { "min", "min value", "value min" },
+    { "max", "max value", "value max" },
+    { "less", "less than value", "value less than" },
+    { "greater", "greater than value", "value greater than" },
+    { "less equal", "less equal value", "value less equal" },
+    { "greater equal", "greater equal value", "value greater equal" },
+    { "equal", "equal value", "value equal" },
+    { "not equal", "not equal value", "value not equal" }
+  };
+
+  return names[static_cast<size_t>(op)];
+}
+
+// a synchronized series combined with an unsynchronized one results in an
+// unsynchronized series, calculated on the synchronized values, so these are
+// copied first
+SeriesAbstrPtr unsynchronized(const SeriesAbstrPtr& series) {
+  auto s = std::make_shared<SeriesImpl>(series->size(), Synchronizer::SynchronizerPtr());
+  for (size_t n = 0; n < series->size(); ++n) {
+    s->at(n) = series->getValue(n);
+  }
+  return s;
+}
+
+class ExpressionSeries : public SeriesImpl {
+ public:
+  ExpressionSeries(const SeriesExpression& expression, const Id& id)
+      : SeriesImpl(expression.unsyncSize(), expression.synchronizer(), id) {
+    expression.evaluate(_v.data());
+  }
+};
+
+class MakeExpressionSeries : public CacheableBuilderX {
+ private:
+  const SeriesExpression& _expression;
+
+ public:
+  MakeExpressionSeries(const SeriesExpression& expression)
+      : CacheableBuilderX(synchronizedId(expression.getId(), expression.synchronizer())), _expression(expression) {}
+
+  CacheableSeriesPtr make() const override {
+    return std::make_shared<IndicatorCacheable>(new ExpressionSeries(_expression, id()), id());
+  }
+};
+
+}  // namespace
+
+SeriesExpression::SeriesExpression(Kind kind, BinaryOp op, double value, SeriesAbstrPtr operand1, SeriesAbstrPtr operand2,
+                                   const Synchronizer::SynchronizerPtr& synchronizer, const Id& id)
+    : Ideable(id),
+      _kind(kind),
+      _op(op),
+      _value(value),
+      _operand1(operand1),
+      _operand2(operand2),
+      _size(operand1->size()),
+      _unsyncSize(operand1->unsyncSize()),
+      _synchronizer(synchronizer),
+      _depth(kind == Kind::seriesSeries ? (std::max)(depth(operand1), depth(operand2) + 1) : depth(operand1)) {}
+
+SeriesAbstrPtr SeriesExpression::make(BinaryOp op, SeriesAbstrPtr series1, SeriesAbstrPtr series2) {
+  assert(series1 && series2);
+
+  series1 = operand(series1);
+  series2 = operand(series2);
+
+  if (series1->size() != series2->size()) {
+    throw OperationOnUnequalSizeSeriesException(series1->size(), series2->size());
+  }
+
+  const Id id(Id::make("Op2", Id::make(opNames(op).seriesSeries), seriesId(*series1), seriesId(*series2)));
+
+  Synchronizer::SynchronizerPtr synchronizer;
+  if (series1->isSynchronized() && series2->isSynchronized()) {
+    if (*(series1->synchronizer()) != *(series2->synchronizer())) {
+      throw OperationOnSeriesSyncedToDifferentSynchronizers();
+    }
+    if (series1->unsyncSize() != series2->unsyncSize()) {
+      throw OperationOnUnequalSizeSeriesException(series1->unsyncSize(), series2->unsyncSize());
+    }
+    synchronizer = series1->synchronizer();
+  }
+  else {
+    if (series1->isSynchronized()) {
+      series1 = unsynchronized(series1);
+    }
+    if (series2->isSynchronized()) {
+      series2 = unsynchronized(series2);
+    }
+  }
+
+  return std::make_shared<SeriesExpression>(Kind::seriesSeries, op, 0, series1, series2, synchronizer, id);
+}
+
+SeriesAbstrPtr SeriesExpression::make(BinaryOp op, SeriesAbstrPtr series, double value) {
+  assert(series);
+
+  series = operand(series);
+  const Id id(Id::make(opNames(op).seriesValue, seriesId(*series), value));
+  return std::make_shared<SeriesExpression>(Kind::seriesValue, op, value, series, SeriesAbstrPtr(), series->synchronizer(), id);
+}
+
+SeriesAbstrPtr SeriesExpression::make(BinaryOp op, double value, SeriesAbstrPtr series) {
+  assert(series);
+
+  if (op == BinaryOp::add || op == BinaryOp::multiply) {
+    return make(op, series, value);
+  }
+
+  series = operand(series);
+  const Id id(Id::make(opNames(op).valueSeries, seriesId(*series), value));
+  return std::make_shared<SeriesExpression>(Kind::valueSeries, op, value, series, SeriesAbstrPtr(), series->synchronizer(), id);
+}
+
+SeriesAbstrPtr SeriesExpression::operand(const SeriesAbstrPtr& series) {
+  const SeriesExpression* expression = dynamic_cast<const SeriesExpression*>(series.get());
+  return expression != 0 && expression->_copy ? expression->_copy : series;
+}
+
+unsigned int SeriesExpression::depth(const SeriesAbstrPtr& operand) {
+  const SeriesExpression* expression = dynamic_cast<const SeriesExpression*>(operand.get());
+  return expression != 0 && !expression->isMaterialized() ? expression->_depth : 0;
+}
+
+void SeriesExpression::evaluate(double* out) const {
+  std::vector<double> scratch(_depth * BLOCK_SIZE);
+
+  for (size_t begin = 0; begin < _unsyncSize; begin += BLOCK_SIZE) {
+    evaluate(begin, (std::min)(BLOCK_SIZE, _unsyncSize - begin), out + begin, scratch.data());
+  }
+}
+
+void SeriesExpression::evaluate(size_t begin, size_t count, double* out, double* scratch) const {
+  switch (_kind) {
+    case Kind::seriesSeries: {
+      const double* values1 = evaluate(_operand1, begin, count, out, scratch);
+      const double* values2 = evaluate(_operand2, begin, count, scratch, scratch + BLOCK_SIZE);
+      tradery::kernels::binary(_op, values1, values2, out, count);
+      break;
+    }
+    case Kind::seriesValue:
+      tradery::kernels::binary(_op, evaluate(_operand1, begin, count, out, scratch), _value, out, count);
+      break;
+    case Kind::valueSeries:
+      tradery::kernels::binary(_op, _value, evaluate(_operand1, begin, count, out, scratch), out, count);
+      break;
+    default:
+      assert(false);
+      break;
+  }
+}
+
+// returns the values of the operand in [begin, begin + count), either directly
+// from its array, or calculated into out if it is an expression
+const double* SeriesExpression::evaluate(const SeriesAbstrPtr& operand, size_t begin, size_t count, double* out, double* scratch) {
+  const SeriesExpression* expression = dynamic_cast<const SeriesExpression*>(operand.get());
+
+  if (expression == 0) {
+    return operand->getArray() + begin;
+  }
+  else if (expression->isMaterialized()) {
+    // the cached result, not the copy, which may have been changed since
+    return expression->_result->getArray() + begin;
+  }
+  else {
+    expression->evaluate(begin, count, out, scratch);
+    return out;
+  }
+}
+
+const SeriesAbstrPtr& SeriesExpression::result() const {
+  if (!_result) {
+    _result = _cache->findAndAdd(MakeExpressionSeries(*this));
+    // the values are now available, the operands are not needed anymore
+    _operand1.reset();
+    _operand2.reset();
+  }
+  return _result;
+}
+
+const SeriesAbstrPtr& SeriesExpression::writable() {
+  if (!_copy) {
+    _copy = result()->clone();
+    // the values will be different from those of the operation
+    setId(Id::unique());
+  }
+  return _copy;
+}
+
+CORE_API SeriesAbstrPtr tradery::makeSeriesExpression(kernels::BinaryOp op, SeriesAbstrPtr series1, SeriesAbstrPtr series2) {
+  return SeriesExpression::make(op, series1, series2);
+}
+
+CORE_API SeriesAbstrPtr tradery::makeSeriesExpression(kernels::BinaryOp op, SeriesAbstrPtr series, double value) {
+  return SeriesExpression::make(op, series, value);
+}
+
+CORE_API SeriesAbstrPtr tradery::makeSeriesExpression(kernels::BinaryOp op, double value, SeriesAbstrPtr series) {
+  return SeriesExpression::make(op, value, series);
+}
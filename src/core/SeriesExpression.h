@@ -0,0 +1,228 @@
+/*
+   Copyright (C) 2018-2020 Adrian Michel
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "seriesimpl.h"
+
+/**
+ * A lazily evaluated arithmetic operation on series.
+ *
+ * The Series arithmetic operators don't calculate anything, they just
+ * capture the operation and its operands, which can be other expressions,
+ * building an operator tree. The tree is evaluated in one pass, block by
+ * block, only when its values are needed: when indexed, when its array is
+ * retrieved, or when an indicator is calculated on it. The intermediate
+ * results are never stored, only the final one, which goes in the series
+ * cache under the same id the corresponding eager operation would have.
+ *
+ * Writing to an expression (setValue, push_back, compound operators etc.)
+ * makes a private copy of its values, with a new id, so neither the cached
+ * result nor the expressions already built on it are affected.
+ *
+ * Not thread safe, like the other series
+ */
+class SeriesExpression : public tradery::SeriesAbstr,
+                         public Ideable,
+                         public std::enable_shared_from_this<SeriesExpression> {
+ public:
+  using BinaryOp = tradery::kernels::BinaryOp;
+
+  enum class Kind { seriesSeries, seriesValue, valueSeries };
+
+  /**
+   * the number of values evaluated at once - the temporary block for each
+   * level of the tree stays in the L1 cache
+   */
+  static constexpr size_t BLOCK_SIZE = 512;
+
+ private:
+  const Kind _kind;
+  const BinaryOp _op;
+  const double _value;
+  // either can be another expression. Released once the expression is
+  // materialized
+  mutable SeriesAbstrPtr _operand1;
+  mutable SeriesAbstrPtr _operand2;
+  const size_t _size;
+  const size_t _unsyncSize;
+  const Synchronizer::SynchronizerPtr _synchronizer;
+  // the number of temporary blocks needed to evaluate the tree
+  const unsigned int _depth;
+
+  // the cached result
+  mutable SeriesAbstrPtr _result;
+  // the private copy, once the expression has been written to
+  SeriesAbstrPtr _copy;
+
+ public:
+  SeriesExpression(Kind kind, BinaryOp op, double value, SeriesAbstrPtr operand1, SeriesAbstrPtr operand2, const Synchronizer::SynchronizerPtr& synchronizer, const Id& id);
+
+  static SeriesAbstrPtr make(BinaryOp op, SeriesAbstrPtr series1, SeriesAbstrPtr series2);
+  static SeriesAbstrPtr make(BinaryOp op, SeriesAbstrPtr series, double value);
+  static SeriesAbstrPtr make(BinaryOp op, double value, SeriesAbstrPtr series);
+
+  bool isMaterialized() const { return (bool)_result; }
+
+  /**
+   * Calculates all the values of the expression into out, which must have
+   * room for unsyncSize() values
+   */
+  void evaluate(double* out) const;
+
+ private:
+  const double* evaluate(size_t begin, size_t count, double* out, double* scratch) const;
+  static const double* evaluate(const SeriesAbstrPtr& operand, size_t begin, size_t count, double* out, double* scratch);
+  static unsigned int depth(const SeriesAbstrPtr& operand);
+  static SeriesAbstrPtr operand(const SeriesAbstrPtr& series);
+
+  const SeriesAbstrPtr& result() const;
+  const SeriesAbstrPtr& current() const { return _copy ? _copy : result(); }
+  const SeriesAbstrPtr& writable();
+  SeriesAbstrPtr self() const { return std::const_pointer_cast<SeriesExpression>(shared_from_this()); }
+
+ public:
+  bool isSynchronized() const override { return (bool)synchronizer(); }
+  Synchronizer::SynchronizerPtr synchronizer() const override { return _copy ? _copy->synchronizer() : _synchronizer; }
+  void synchronize(Synchronizer::SynchronizerPtr synchronizer) override { writable()->synchronize(synchronizer); }
+  SeriesAbstrPtr clone() const override { return current()->clone(); }
+  double setValue(size_t index, double value) override { return writable()->setValue(index, value); }
+  double getValue(size_t index) const override { return current()->getValue(index); }
+  double& getRef(size_t index) override { return writable()->getRef(index); }
+  size_t unsyncSize() const override { return _copy ? _copy->unsyncSize() : _unsyncSize; }
+  size_t size() const override { return _copy ? _copy->size() : _size; }
+  void push_back(double value) override { writable()->push_back(value); }
+  const double* getArray() const override { return current()->getArray(); }
+  const std::vector<double>& getVector() const override { return current()->getVector(); }
+
+  SeriesAbstr& operator=(SeriesAbstrPtr series) override { *writable() = series; return *this; }
+  SeriesAbstrPtr operator*(SeriesAbstrPtr series) const override { return multiply(series); }
+  SeriesAbstr& operator*=(SeriesAbstrPtr series) override { *writable() *= series; return *this; }
+  SeriesAbstrPtr operator*(double value) const override { return multiply(value); }
+  SeriesAbstr& operator*=(double value) override { *writable() *= value; return *this; }
+  SeriesAbstrPtr operator+(SeriesAbstrPtr series) const override { return add(series); }
+  SeriesAbstr& operator+=(SeriesAbstrPtr series) override { *writable() += series; return *this; }
+  SeriesAbstrPtr operator+(double value) const override { return add(value); }
+  SeriesAbstr& operator+=(double value) override { *writable() += value; return *this; }
+  SeriesAbstrPtr operator-(SeriesAbstrPtr series) const override { return subtract(series); }
+  SeriesAbstr& operator-=(SeriesAbstrPtr series) override { *writable() -= series; return *this; }
+  SeriesAbstrPtr operator-(double value) const override { return subtract(value); }
+  SeriesAbstr& operator-=(double value) override { *writable() -= value; return *this; }
+  SeriesAbstrPtr operator/(SeriesAbstrPtr series) const override { return divide(series); }
+  SeriesAbstr& operator/=(SeriesAbstrPtr series) override { *writable() /= series; return *this; }
+  SeriesAbstrPtr operator/(double value) const override { return divide(value); }
+  SeriesAbstr& operator/=(double value) override { *writable() /= value; return *this; }
+
+  SeriesAbstrPtr multiply(SeriesAbstrPtr series) const override { return make(BinaryOp::multiply, self(), series); }
+  SeriesAbstrPtr multiply(double value) const override { return make(BinaryOp::multiply, self(), value); }
+  SeriesAbstrPtr add(SeriesAbstrPtr series) const override { return make(BinaryOp::add, self(), series); }
+  SeriesAbstrPtr add(double value) const override { return make(BinaryOp::add, self(), value); }
+  SeriesAbstrPtr subtract(SeriesAbstrPtr series) const override { return make(BinaryOp::subtract, self(), series); }
+  SeriesAbstrPtr subtract(double value) const override { return make(BinaryOp::subtract, self(), value); }
+  SeriesAbstrPtr subtractFrom(double value) const override { return make(BinaryOp::subtract, value, self()); }
+  SeriesAbstrPtr divide(SeriesAbstrPtr series) const override { return make(BinaryOp::divide, self(), series); }
+  SeriesAbstrPtr divide(double value) const override { return make(BinaryOp::divide, self(), value); }
+  SeriesAbstrPtr divideBy(double value) const override { return make(BinaryOp::divide, value, self()); }
+
+  // everything else is calculated on the values of the expression
+  SeriesAbstrPtr Min(unsigned int period) const override { return current()->Min(period); }
+  SeriesAbstrPtr Max(unsigned int period) const override { return current()->Max(period); }
+  SeriesAbstrPtr MinIndex(unsigned int period) const override { return current()->MinIndex(period); }
+  SeriesAbstrPtr MaxIndex(unsigned int period) const override { return current()->MaxIndex(period); }
+  bool crossOver(size_t index, SeriesAbstrPtr series) const override { return current()->crossOver(index, series); }
+  bool crossOver(size_t index, double d) const override { return current()->crossOver(index, d); }
+  bool crossUnder(size_t index, SeriesAbstrPtr series) const override { return current()->crossUnder(index, series); }
+  bool crossUnder(size_t index, double d) const override { return current()->crossUnder(index, d); }
+  bool turnDown(size_t index) const override { return current()->turnDown(index); }
+  bool turnUp(size_t index) const override { return current()->turnUp(index); }
+  SeriesAbstrPtr SMA(unsigned int period) const override { return current()->SMA(period); }
+  SeriesAbstrPtr EMA(unsigned int period) const override { return current()->EMA(period); }
+  SeriesAbstrPtr EMA(unsigned int period, double exp) const override { return current()->EMA(period, exp); }
+  SeriesAbstrPtr WMA(unsigned int period) const override { return current()->WMA(period); }
+  SeriesAbstrPtr AroonDown(unsigned int period) const override { return current()->AroonDown(period); }
+  SeriesAbstrPtr AroonUp(unsigned int period) const override { return current()->AroonUp(period); }
+  SeriesAbstrPtr ROC(unsigned int period) const override { return current()->ROC(period); }
+  SeriesAbstrPtr BBandUpper(unsigned int period, double stdDev) const override { return current()->BBandUpper(period, stdDev); }
+  SeriesAbstrPtr BBandLower(unsigned int period, double stdDev) const override { return current()->BBandLower(period, stdDev); }
+  SeriesAbstrPtr DEMA(unsigned int period) const override { return current()->DEMA(period); }
+  SeriesAbstrPtr HTTrendline() const override { return current()->HTTrendline(); }
+  SeriesAbstrPtr KAMA(unsigned int period) const override { return current()->KAMA(period); }
+  SeriesAbstrPtr MAMA(double fastLimit, double slowLimit) const override { return current()->MAMA(fastLimit, slowLimit); }
+  SeriesAbstrPtr FAMA(double fastLimit, double slowLimit) const override { return current()->FAMA(fastLimit, slowLimit); }
+  SeriesAbstrPtr MidPoint(unsigned int period) const override { return current()->MidPoint(period); }
+  SeriesAbstrPtr PPO(unsigned int fastPeriod, unsigned int slowPeriod, MAType maType) const override { return current()->PPO(fastPeriod, slowPeriod, maType); }
+  SeriesAbstrPtr ROCP(unsigned int period) const override { return current()->ROCP(period); }
+  SeriesAbstrPtr ROCR(unsigned int period) const override { return current()->ROCR(period); }
+  SeriesAbstrPtr ROCR100(unsigned int period) const override { return current()->ROCR100(period); }
+  SeriesAbstrPtr RSI(unsigned int period) const override { return current()->RSI(period); }
+  SeriesAbstrPtr TRIX(unsigned int period) const override { return current()->TRIX(period); }
+  SeriesAbstrPtr HTDCPeriod() const override { return current()->HTDCPeriod(); }
+  SeriesAbstrPtr HTDCPhase() const override { return current()->HTDCPhase(); }
+  SeriesAbstrPtr HTPhasorPhase() const override { return current()->HTPhasorPhase(); }
+  SeriesAbstrPtr HTPhasorQuadrature() const override { return current()->HTPhasorQuadrature(); }
+  SeriesAbstrPtr HTSine() const override { return current()->HTSine(); }
+  SeriesAbstrPtr HTLeadSine() const override { return current()->HTLeadSine(); }
+  SeriesAbstrPtr HTTrendMode() const override { return current()->HTTrendMode(); }
+  SeriesAbstrPtr LinearReg(unsigned int period) const override { return current()->LinearReg(period); }
+  SeriesAbstrPtr LinearRegSlope(unsigned int period) const override { return current()->LinearRegSlope(period); }
+  SeriesAbstrPtr LinearRegAngle(unsigned int period) const override { return current()->LinearRegAngle(period); }
+  SeriesAbstrPtr LinearRegIntercept(unsigned int period) const override { return current()->LinearRegIntercept(period); }
+  SeriesAbstrPtr StdDev(unsigned int period, double nbDev) const override { return current()->StdDev(period, nbDev); }
+  std::vector<SeriesAbstrPtr> SMAs(const std::vector<unsigned int>& periods) const override { return current()->SMAs(periods); }
+  std::vector<SeriesAbstrPtr> EMAs(const std::vector<unsigned int>& periods) const override { return current()->EMAs(periods); }
+  std::vector<SeriesAbstrPtr> StdDevs(const std::vector<unsigned int>& periods, double nbDev) const override { return current()->StdDevs(periods, nbDev); }
+  std::vector<SeriesAbstrPtr> Mins(const std::vector<unsigned int>& periods) const override { return current()->Mins(periods); }
+  std::vector<SeriesAbstrPtr> Maxs(const std::vector<unsigned int>& periods) const override { return current()->Maxs(periods); }
+  SeriesAbstrPtr Variance(unsigned int period, double nbDev) const override { return current()->Variance(period, nbDev); }
+  SeriesAbstrPtr Correlation(SeriesAbstrPtr series, unsigned int period) const override { return current()->Correlation(series, period); }
+  SeriesAbstrPtr Beta(SeriesAbstrPtr series, unsigned int period) const override { return current()->Beta(series, period); }
+  SeriesAbstrPtr TSF(unsigned int period) const override { return current()->TSF(period); }
+  SeriesAbstrPtr CMO(unsigned int period) const override { return current()->CMO(period); }
+  SeriesAbstrPtr MOM(unsigned int period) const override { return current()->MOM(period); }
+  SeriesAbstrPtr Momentum(unsigned int period) const override { return current()->Momentum(period); }
+  SeriesAbstrPtr MACD(unsigned int fastPeriod, unsigned int slowPeriod, unsigned int signalPeriod) const override { return current()->MACD(fastPeriod, slowPeriod, signalPeriod); }
+  SeriesAbstrPtr MACDSignal(unsigned int fastPeriod, unsigned int slowPeriod, unsigned int signalPeriod) const override { return current()->MACDSignal(fastPeriod, slowPeriod, signalPeriod); }
+  SeriesAbstrPtr MACDHist(unsigned int fastPeriod, unsigned int slowPeriod, unsigned int signalPeriod) const override { return current()->MACDHist(fastPeriod, slowPeriod, signalPeriod); }
+  SeriesAbstrPtr MACDExt(unsigned int fastPeriod, MAType fastMAType, unsigned int slowPeriod, MAType slowMAType, unsigned int signalPeriod, MAType signalMAType) const override { return current()->MACDExt(fastPeriod, fastMAType, slowPeriod, slowMAType, signalPeriod, signalMAType); }
+  SeriesAbstrPtr MACDSignalExt(unsigned int fastPeriod, MAType fastMAType, unsigned int slowPeriod, MAType slowMAType, unsigned int signalPeriod, MAType signalMAType) const override { return current()->MACDSignalExt(fastPeriod, fastMAType, slowPeriod, slowMAType, signalPeriod, signalMAType); }
+  SeriesAbstrPtr MACDHistExt(unsigned int fastPeriod, MAType fastMAType, unsigned int slowPeriod, MAType slowMAType, unsigned int signalPeriod, MAType signalMAType) const override { return current()->MACDHistExt(fastPeriod, fastMAType, slowPeriod, slowMAType, signalPeriod, signalMAType); }
+  SeriesAbstrPtr MACDFix(unsigned int period) const override { return current()->MACDFix(period); }
+  SeriesAbstrPtr MACDSignalFix(unsigned int period) const override { return current()->MACDSignalFix(period); }
+  SeriesAbstrPtr MACDHistFix(unsigned int period) const override { return current()->MACDHistFix(period); }
+  SeriesAbstrPtr APO(unsigned int fastPeriod, unsigned int slowPeriod, MAType maType) const override { return current()->APO(fastPeriod, slowPeriod, maType); }
+  SeriesAbstrPtr T3(unsigned int period, double vFactor) const override { return current()->T3(period, vFactor); }
+  SeriesAbstrPtr TEMA(unsigned int period) const override { return current()->TEMA(period); }
+  SeriesAbstrPtr TRIMA(unsigned int period) const override { return current()->TRIMA(period); }
+  SeriesAbstrPtr StochRSIFastK(int period, int fastKPeriod, int fastDPeriod, MAType fastDMAType) const override { return current()->StochRSIFastK(period, fastKPeriod, fastDPeriod, fastDMAType); }
+  SeriesAbstrPtr StochRSIFastD(int period, int fastKPeriod, int fastDPeriod, MAType fastDMAType) const override { return current()->StochRSIFastD(period, fastKPeriod, fastDPeriod, fastDMAType); }
+  SeriesAbstrPtr shiftRight(size_t n) const override { return current()->shiftRight(n); }
+  SeriesAbstrPtr shiftLeft(size_t n) const override { return current()->shiftLeft(n); }
+  SeriesAbstrPtr Sin() const override { return current()->Sin(); }
+  SeriesAbstrPtr Cos() const override { return current()->Cos(); }
+  SeriesAbstrPtr Tan() const override { return current()->Tan(); }
+  SeriesAbstrPtr Cosh() const override { return current()->Cosh(); }
+  SeriesAbstrPtr Sinh() const override { return current()->Sinh(); }
+  SeriesAbstrPtr Tanh() const override { return current()->Tanh(); }
+  SeriesAbstrPtr Acos() const override { return current()->Acos(); }
+  SeriesAbstrPtr Asin() const override { return current()->Asin(); }
+  SeriesAbstrPtr Atan() const override { return current()->Atan(); }
+  SeriesAbstrPtr Ceil() const override { return current()->Ceil(); }
+  SeriesAbstrPtr Floor() const override { return current()->Floor(); }
+  SeriesAbstrPtr Exp() const override { return current()->Exp(); }
+  SeriesAbstrPtr Sqrt() const override { return current()->Sqrt(); }
+  SeriesAbstrPtr Ln() const override { return current()->Ln(); }
+  SeriesAbstrPtr Log10() const override { return current()->Log10(); }
+};
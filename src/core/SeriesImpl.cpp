@@ -33,9 +33,6 @@ static char THIS_FILE[]=__FILE__;
 
 SeriesCache* _cache;
 
-unsigned long EmptySeries::_l = 0;
-std::mutex EmptySeries::_mutex;
-
 SeriesAbstrPtr SeriesImpl::shiftRight(size_t n) const {
   return _cache->findAndAdd(MakeShiftRightSeries(*this, n));
 }
@@ -155,6 +152,124 @@ SeriesAbstrPtr SeriesImpl::Max(unsigned int period) const {
   return _cache->findAndAdd(MakeMaxSeries(*this, period));
 }
 
+/**
+ * Looks up the series for each period, and calculates all those not in the
+ * cache at once. These are then added to the cache under the ids of the
+ * series made by Builder, so the single period calls will find them.
+ *
+ * Periods that can't be batched are made by Builder, and so are all periods
+ * if the series extends another series, so the cached series calculated on
+ * the other series are extended instead
+ *
+ * @param builder   makes the builder for a period
+ * @param batchable whether a period can be calculated in the batch
+ * @param calculate calculates the values of the series made for the periods
+ */
+template <class Builder, class Made = SeriesImpl, class MakeBuilder, class Batchable, class Calculate>
+std::vector<SeriesAbstrPtr> batch(const SeriesImpl& series, const std::vector<unsigned int>& periods, MakeBuilder builder, Batchable batchable, Calculate calculate) {
+  std::vector<SeriesAbstrPtr> result(periods.size());
+
+  std::vector<size_t> missing;
+  std::vector<unsigned int> missingPeriods;
+  std::vector<std::unique_ptr<Made> > made;
+  for (size_t n = 0; n < periods.size(); n++) {
+    const Builder b(builder(periods[n]));
+    result[n] = _cache->find(b.id());
+    if (!result[n]) {
+      if (batchable(periods[n]) && !series.prefix()) {
+        missing.push_back(n);
+        missingPeriods.push_back(periods[n]);
+        made.push_back(std::make_unique<Made>(series.unsyncSize(), series.synchronizer(), b.id()));
+      }
+      else {
+        result[n] = _cache->findAndAdd(b);
+      }
+    }
+  }
+
+  if (!missing.empty()) {
+    calculate(missingPeriods, made);
+    for (size_t n = 0; n < missing.size(); n++) {
+      // if the same series was added in the meantime, the one in the cache is returned
+      result[missing[n]] = _cache->findAndAdd(MakeBatchSeries<Builder>(std::move(made[n])));
+    }
+  }
+  return result;
+}
+
+/**
+ * Where each of the batch calculated series receives its values
+ */
+template <class Made>
+std::vector<double*> outputs(const std::vector<std::unique_ptr<Made> >& made) {
+  std::vector<double*> out;
+  for (const std::unique_ptr<Made>& series : made) {
+    out.push_back(&series->at(0));
+  }
+  return out;
+}
+
+std::vector<SeriesAbstrPtr> SeriesImpl::SMAs(const std::vector<unsigned int>& periods) const {
+  return batch<MakeSMASeries>(*this, periods,
+    [this](unsigned int period) { return MakeSMASeries(*this, period); },
+    [this](unsigned int period) { return MakeSMASeries::isBatchable(*this, period); },
+    [this](const std::vector<unsigned int>& periods, const std::vector<std::unique_ptr<SeriesImpl> >& made) {
+      calculateSMAs(getArray(), unsyncSize(), periods.data(), outputs(made).data(), periods.size());
+    });
+}
+
+std::vector<SeriesAbstrPtr> SeriesImpl::EMAs(const std::vector<unsigned int>& periods) const {
+  return batch<MakeFixedExpEMASeries>(*this, periods,
+    [this](unsigned int period) { return MakeFixedExpEMASeries(*this, period); },
+    [this](unsigned int period) { return MakeEMASeries::isBatchable(*this, period); },
+    [this](const std::vector<unsigned int>& periods, const std::vector<std::unique_ptr<SeriesImpl> >& made) {
+      std::vector<double> exps;
+      for (unsigned int period : periods) {
+        exps.push_back(2 / ((double)period + 1));
+      }
+      calculateEMAs(getArray(), unsyncSize(), periods.data(), exps.data(), outputs(made).data(), periods.size());
+    });
+}
+
+std::vector<SeriesAbstrPtr> SeriesImpl::StdDevs(const std::vector<unsigned int>& periods, double nbDev) const {
+  using StdDevSeries = MakeStdDevSeries::StdDevSeries;
+  return batch<MakeStdDevSeries, StdDevSeries>(*this, periods,
+    [this, nbDev](unsigned int period) { return MakeStdDevSeries(*this, period, nbDev); },
+    [this, nbDev](unsigned int period) { return MakeStdDevSeries::isBatchable(*this, period, nbDev); },
+    [this, nbDev](const std::vector<unsigned int>& periods, const std::vector<std::unique_ptr<StdDevSeries> >& made) {
+      // the running sums are kept in each series, so it can be extended
+      std::vector<double> totals(2 * periods.size());
+      calculateStdDevs(getArray(), unsyncSize(), periods.data(), nbDev, outputs(made).data(), periods.size(), totals.data());
+      for (size_t n = 0; n < made.size(); n++) {
+        made[n]->totals()[0] = totals[2 * n];
+        made[n]->totals()[1] = totals[2 * n + 1];
+      }
+    });
+}
+
+// the periods accepted by TA_MIN and TA_MAX that leave at least one value
+static bool isExtremeBatchable(const SeriesImpl& series, unsigned int period) {
+  return period > 1 && period <= 100000 && period <= series.unsyncSize();
+}
+
+std::vector<SeriesAbstrPtr> SeriesImpl::Mins(const std::vector<unsigned int>& periods) const {
+  return batch<MakeMinSeries>(*this, periods,
+    [this](unsigned int period) { return MakeMinSeries(*this, period); },
+    [this](unsigned int period) { return isExtremeBatchable(*this, period); },
+    [this](const std::vector<unsigned int>& periods, const std::vector<std::unique_ptr<SeriesImpl> >& made) {
+      calculateMins(getArray(), unsyncSize(), periods.data(), outputs(made).data(), periods.size());
+    });
+}
+
+std::vector<SeriesAbstrPtr> SeriesImpl::Maxs(const std::vector<unsigned int>& periods) const {
+  return batch<MakeMaxSeries>(*this, periods,
+    [this](unsigned int period) { return MakeMaxSeries(*this, period); },
+    [this](unsigned int period) { return isExtremeBatchable(*this, period); },
+    [this](const std::vector<unsigned int>& periods, const std::vector<std::unique_ptr<SeriesImpl> >& made) {
+      calculateMaxs(getArray(), unsyncSize(), periods.data(), outputs(made).data(), periods.size());
+    });
+}
+
 SeriesAbstrPtr SeriesImpl::MaxIndex(unsigned int period) const {
   return _cache->findAndAdd(MakeMaxIndexSeries(*this, period));
 }
@@ -376,33 +491,20 @@ tradery::SeriesAbstrPtr SeriesAbstr::create(size_t size) {
 }
 
 
-template< typename F > Series operator_x(double value, const Series& series) {
-  std::shared_ptr<SeriesImpl> si(std::make_shared< SeriesImpl >());
-  const std::vector<double>& v = series.getVector();
-  F op;
-  for (size_t n = 0; n < series.unsyncSize(); n++) {
-    si->push_back(op(value, v[n]));
-  }
-
-  si->synchronize(series.synchronizer());
-  return Series(si);
-}
-
-
-
-constexpr auto plus = [](double v1, double v2)->double { return v1 + v2; };
-constexpr auto minus = [](double v1, double v2)->double { return v1 - v2; };
-constexpr auto mul = [](double v1, double v2)->double { return v1 * v2; };
-constexpr auto division = [](double v1, double v2)->double { return v1 / v2; };
-
 // global operators allowing using a constant as the first operand in an
 // operation ( value + series etc)
-CORE_API Series tradery::operator+(double value, const Series& series) { return operator_x< decltype(plus) >(value, series ); }
-CORE_API Series tradery::operator-(double value, const Series& series) { return operator_x< decltype(minus) >(value, series); }
-CORE_API Series tradery::operator*(double value, const Series& series) { return operator_x< decltype(mul) >(value, series); }
-CORE_API Series tradery::operator/(double value, const Series& series) { return operator_x< decltype(division) >(value, series); }
-
-
+CORE_API Series tradery::operator+(double value, const Series& series) {
+  return Series(makeSeriesExpression(kernels::BinaryOp::add, value, series._series));
+}
+CORE_API Series tradery::operator-(double value, const Series& series) {
+  return Series(makeSeriesExpression(kernels::BinaryOp::subtract, value, series._series));
+}
+CORE_API Series tradery::operator*(double value, const Series& series) {
+  return Series(makeSeriesExpression(kernels::BinaryOp::multiply, value, series._series));
+}
+CORE_API Series tradery::operator/(double value, const Series& series) {
+  return Series(makeSeriesExpression(kernels::BinaryOp::divide, value, series._series));
+}
 
 CORE_API SeriesHelper::SeriesHelper(SeriesAbstrPtr s, size_t ix)
     : _ix(ix), _s(s) {
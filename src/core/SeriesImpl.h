@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <optional>
 #include "cache.h"
 
 using std::vector;
@@ -31,11 +32,25 @@ using std::vector;
 // members to the class Series to make it usable with algorithms, but the
 // process would have been too tedious
 class SeriesImpl : public tradery::SeriesAbstr, public Ideable {
+ public:
+  /**
+   * The first size values of a series are the values of the series with the
+   * given id, for example the close series of bars that were loaded again
+   * after new bars were appended to the data. Indicators on the series can
+   * then extend the cached indicators on the other series, instead of
+   * calculating all the values again, if the series cache is enabled
+   */
+  struct Prefix {
+    Id id;
+    size_t size;
+  };
+
  protected:
   mutable vector<double> _v;
 
  private:
   Synchronizer::SynchronizerPtr _synchronizer;
+  std::optional<Prefix> _prefix;
 
   int getIndex(size_t ix) const {
     return isSynchronized() ? _synchronizer->index(ix) : ix;
@@ -55,7 +70,7 @@ class SeriesImpl : public tradery::SeriesAbstr, public Ideable {
   SeriesImpl(const Id& id = Id()) : Ideable(id) {}
 
   SeriesImpl(const SeriesImpl& series)
-      : _v(series.getVector()), Ideable(Id()), _synchronizer(series.synchronizer()) {}
+      : _v(series.getVector()), Ideable(Id::unique()), _synchronizer(series.synchronizer()) {}
 
   virtual ~SeriesImpl() {}
 
@@ -77,6 +92,10 @@ class SeriesImpl : public tradery::SeriesAbstr, public Ideable {
     _v.push_back(value);
   }
 
+  void reserve(size_t count) { _v.reserve(count); }
+
+  void append(const double* values, size_t count) { _v.insert(_v.end(), values, values + count); }
+
   double setValue(size_t barIndex, double value) override {
     try {
       // todo: should we throw an exception if the series is synced? Probably we
@@ -126,6 +145,36 @@ class SeriesImpl : public tradery::SeriesAbstr, public Ideable {
 
   const vector<double>& getVector() const override { return _v; }
 
+  const std::optional<Prefix>& prefix() const { return _prefix; }
+
+  void setPrefix(const Id& id, size_t size) { _prefix = Prefix{id, size}; }
+
+  /**
+   * A copy with the same values, id and prefix, and not synchronized, unlike
+   * the copy constructor, so indicators calculated on the copy are shared
+   * with those calculated on this series. Once the copy is synchronized, its
+   * indicators are cached separately (see synchronizedId)
+   */
+  std::shared_ptr<SeriesImpl> copy() const {
+    std::shared_ptr<SeriesImpl> series = std::make_shared<SeriesImpl>(getId());
+    series->_v = _v;
+    series->_prefix = _prefix;
+    return series;
+  }
+
+ protected:
+  /**
+   * Copies the first size values of series, which this series extends
+   *
+   * @param series the series calculated on the data this series' data extends
+   * @param size   the number of values to copy
+   */
+  void extend(const SeriesImpl& series, size_t size) {
+    assert(size <= series.unsyncSize() && size <= unsyncSize());
+    std::copy(series._v.begin(), series._v.begin() + size, _v.begin());
+    setPrefix(series.getId(), size);
+  }
+
  public:
   SeriesAbstrPtr operator*(SeriesAbstrPtr series) const override {
     return multiply(series);
@@ -375,6 +424,11 @@ class SeriesImpl : public tradery::SeriesAbstr, public Ideable {
   SeriesAbstrPtr LinearRegAngle(unsigned int period) const override;
   SeriesAbstrPtr LinearRegIntercept(unsigned int period) const override;
   SeriesAbstrPtr StdDev(unsigned int period, double nbDev) const override;
+  std::vector<SeriesAbstrPtr> SMAs(const std::vector<unsigned int>& periods) const override;
+  std::vector<SeriesAbstrPtr> EMAs(const std::vector<unsigned int>& periods) const override;
+  std::vector<SeriesAbstrPtr> StdDevs(const std::vector<unsigned int>& periods, double nbDev) const override;
+  std::vector<SeriesAbstrPtr> Mins(const std::vector<unsigned int>& periods) const override;
+  std::vector<SeriesAbstrPtr> Maxs(const std::vector<unsigned int>& periods) const override;
   SeriesAbstrPtr Variance(unsigned int period, double nbDev) const override;
   SeriesAbstrPtr Correlation(SeriesAbstrPtr series, unsigned int period) const override;
   SeriesAbstrPtr Beta(SeriesAbstrPtr series, unsigned int period) const override;
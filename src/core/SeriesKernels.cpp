@@ -0,0 +1,319 @@
+/*
+   Copyright (C) 2018-2020 Adrian Michel
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "stdafx.h"
+#include <serieskernels.h>
+#include <intrin.h>
+#include <immintrin.h>
+
+using namespace tradery::kernels;
+
+namespace {
+
+/**
+ * Each instruction set is described by a class with the vector type V, the
+ * number of doubles in a vector WIDTH, and the vector operations. The kernels
+ * are templates over these classes
+ */
+class Sse2 {
+ public:
+  using V = __m128d;
+  static constexpr size_t WIDTH = 2;
+
+  static V load(const double* p) { return _mm_loadu_pd(p); }
+  static void store(double* p, V v) { _mm_storeu_pd(p, v); }
+  static V set1(double d) { return _mm_set1_pd(d); }
+
+  static V add(V a, V b) { return _mm_add_pd(a, b); }
+  static V subtract(V a, V b) { return _mm_sub_pd(a, b); }
+  static V multiply(V a, V b) { return _mm_mul_pd(a, b); }
+  static V divide(V a, V b) { return _mm_div_pd(a, b); }
+  static V min(V a, V b) { return _mm_min_pd(a, b); }
+  static V max(V a, V b) { return _mm_max_pd(a, b); }
+  static V abs(V a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+
+  // comparisons return 1.0 where true and 0.0 where false
+  static V less(V a, V b) { return _mm_and_pd(_mm_cmplt_pd(a, b), set1(1.0)); }
+  static V greater(V a, V b) { return _mm_and_pd(_mm_cmpgt_pd(a, b), set1(1.0)); }
+  static V lessEqual(V a, V b) { return _mm_and_pd(_mm_cmple_pd(a, b), set1(1.0)); }
+  static V greaterEqual(V a, V b) { return _mm_and_pd(_mm_cmpge_pd(a, b), set1(1.0)); }
+  static V equal(V a, V b) { return _mm_and_pd(_mm_cmpeq_pd(a, b), set1(1.0)); }
+  static V notEqual(V a, V b) { return _mm_and_pd(_mm_cmpneq_pd(a, b), set1(1.0)); }
+};
+
+class Avx2 {
+ public:
+  using V = __m256d;
+  static constexpr size_t WIDTH = 4;
+
+  static V load(const double* p) { return _mm256_loadu_pd(p); }
+  static void store(double* p, V v) { _mm256_storeu_pd(p, v); }
+  static V set1(double d) { return _mm256_set1_pd(d); }
+
+  static V add(V a, V b) { return _mm256_add_pd(a, b); }
+  static V subtract(V a, V b) { return _mm256_sub_pd(a, b); }
+  static V multiply(V a, V b) { return _mm256_mul_pd(a, b); }
+  static V divide(V a, V b) { return _mm256_div_pd(a, b); }
+  static V min(V a, V b) { return _mm256_min_pd(a, b); }
+  static V max(V a, V b) { return _mm256_max_pd(a, b); }
+  static V abs(V a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+
+  template <int P> static V compare(V a, V b) { return _mm256_and_pd(_mm256_cmp_pd(a, b, P), set1(1.0)); }
+
+  static V less(V a, V b) { return compare<_CMP_LT_OQ>(a, b); }
+  static V greater(V a, V b) { return compare<_CMP_GT_OQ>(a, b); }
+  static V lessEqual(V a, V b) { return compare<_CMP_LE_OQ>(a, b); }
+  static V greaterEqual(V a, V b) { return compare<_CMP_GE_OQ>(a, b); }
+  static V equal(V a, V b) { return compare<_CMP_EQ_OQ>(a, b); }
+  static V notEqual(V a, V b) { return compare<_CMP_NEQ_UQ>(a, b); }
+};
+
+class Avx512 {
+ public:
+  using V = __m512d;
+  static constexpr size_t WIDTH = 8;
+
+  static V load(const double* p) { return _mm512_loadu_pd(p); }
+  static void store(double* p, V v) { _mm512_storeu_pd(p, v); }
+  static V set1(double d) { return _mm512_set1_pd(d); }
+
+  static V add(V a, V b) { return _mm512_add_pd(a, b); }
+  static V subtract(V a, V b) { return _mm512_sub_pd(a, b); }
+  static V multiply(V a, V b) { return _mm512_mul_pd(a, b); }
+  static V divide(V a, V b) { return _mm512_div_pd(a, b); }
+  static V min(V a, V b) { return _mm512_min_pd(a, b); }
+  static V max(V a, V b) { return _mm512_max_pd(a, b); }
+  static V abs(V a) { return _mm512_castsi512_pd(_mm512_and_si512(_mm512_castpd_si512(a), _mm512_set1_epi64(0x7fffffffffffffffLL))); }
+
+  template <int P> static V compare(V a, V b) { return _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(a, b, P), set1(1.0)); }
+
+  static V less(V a, V b) { return compare<_CMP_LT_OQ>(a, b); }
+  static V greater(V a, V b) { return compare<_CMP_GT_OQ>(a, b); }
+  static V lessEqual(V a, V b) { return compare<_CMP_LE_OQ>(a, b); }
+  static V greaterEqual(V a, V b) { return compare<_CMP_GE_OQ>(a, b); }
+  static V equal(V a, V b) { return compare<_CMP_EQ_OQ>(a, b); }
+  static V notEqual(V a, V b) { return compare<_CMP_NEQ_UQ>(a, b); }
+};
+
+/**
+ * Maps a BinaryOp to the corresponding vector operation of instruction set I
+ */
+template <class I, BinaryOp OP> typename I::V vectorOp(typename I::V a, typename I::V b) {
+  if constexpr (OP == BinaryOp::add) return I::add(a, b);
+  else if constexpr (OP == BinaryOp::subtract) return I::subtract(a, b);
+  else if constexpr (OP == BinaryOp::multiply) return I::multiply(a, b);
+  else if constexpr (OP == BinaryOp::divide) return I::divide(a, b);
+  else if constexpr (OP == BinaryOp::min) return I::min(a, b);
+  else if constexpr (OP == BinaryOp::max) return I::max(a, b);
+  else if constexpr (OP == BinaryOp::less) return I::less(a, b);
+  else if constexpr (OP == BinaryOp::greater) return I::greater(a, b);
+  else if constexpr (OP == BinaryOp::lessEqual) return I::lessEqual(a, b);
+  else if constexpr (OP == BinaryOp::greaterEqual) return I::greaterEqual(a, b);
+  else if constexpr (OP == BinaryOp::equal) return I::equal(a, b);
+  else return I::notEqual(a, b);
+}
+
+// the loops process whole vectors, then the remaining elements one by one
+// using the scalar definition
+
+template <class I, BinaryOp OP> void binarySeriesSeries(const double* a, const double* b, double* out, size_t n) {
+  size_t i = 0;
+  for (; i + I::WIDTH <= n; i += I::WIDTH) {
+    I::store(out + i, vectorOp<I, OP>(I::load(a + i), I::load(b + i)));
+  }
+  for (; i < n; i++) {
+    out[i] = apply(OP, a[i], b[i]);
+  }
+}
+
+template <class I, BinaryOp OP> void binarySeriesValue(const double* a, double value, double* out, size_t n) {
+  const typename I::V v = I::set1(value);
+  size_t i = 0;
+  for (; i + I::WIDTH <= n; i += I::WIDTH) {
+    I::store(out + i, vectorOp<I, OP>(I::load(a + i), v));
+  }
+  for (; i < n; i++) {
+    out[i] = apply(OP, a[i], value);
+  }
+}
+
+template <class I, BinaryOp OP> void binaryValueSeries(double value, const double* a, double* out, size_t n) {
+  const typename I::V v = I::set1(value);
+  size_t i = 0;
+  for (; i + I::WIDTH <= n; i += I::WIDTH) {
+    I::store(out + i, vectorOp<I, OP>(v, I::load(a + i)));
+  }
+  for (; i < n; i++) {
+    out[i] = apply(OP, value, a[i]);
+  }
+}
+
+template <class I> void absSeries(const double* a, double* out, size_t n) {
+  size_t i = 0;
+  for (; i + I::WIDTH <= n; i += I::WIDTH) {
+    I::store(out + i, I::abs(I::load(a + i)));
+  }
+  for (; i < n; i++) {
+    out[i] = std::fabs(a[i]);
+  }
+}
+
+// scalar versions, used when no vector instruction set is available
+
+template <BinaryOp OP> void scalarSeriesSeries(const double* a, const double* b, double* out, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    out[i] = apply(OP, a[i], b[i]);
+  }
+}
+
+template <BinaryOp OP> void scalarSeriesValue(const double* a, double value, double* out, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    out[i] = apply(OP, a[i], value);
+  }
+}
+
+template <BinaryOp OP> void scalarValueSeries(double value, const double* a, double* out, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    out[i] = apply(OP, value, a[i]);
+  }
+}
+
+void scalarAbs(const double* a, double* out, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    out[i] = std::fabs(a[i]);
+  }
+}
+
+constexpr size_t OPS = (size_t)BinaryOp::notEqual + 1;
+
+using SeriesSeriesKernel = void (*)(const double*, const double*, double*, size_t);
+using SeriesValueKernel = void (*)(const double*, double, double*, size_t);
+using ValueSeriesKernel = void (*)(double, const double*, double*, size_t);
+using AbsKernel = void (*)(const double*, double*, size_t);
+
+/**
+ * The kernels for one instruction set, indexed by BinaryOp
+ */
+class KernelTable {
+ public:
+  SeriesSeriesKernel _seriesSeries[OPS];
+  SeriesValueKernel _seriesValue[OPS];
+  ValueSeriesKernel _valueSeries[OPS];
+  AbsKernel _abs;
+};
+
+template <class I, size_t... OP> KernelTable makeKernelTable(std::index_sequence<OP...>) {
+  return KernelTable{ { &binarySeriesSeries<I, (BinaryOp)OP>... },
+                      { &binarySeriesValue<I, (BinaryOp)OP>... },
+                      { &binaryValueSeries<I, (BinaryOp)OP>... },
+                      &absSeries<I> };
+}
+
+template <size_t... OP> KernelTable makeScalarKernelTable(std::index_sequence<OP...>) {
+  return KernelTable{ { &scalarSeriesSeries<(BinaryOp)OP>... },
+                      { &scalarSeriesValue<(BinaryOp)OP>... },
+                      { &scalarValueSeries<(BinaryOp)OP>... },
+                      &scalarAbs };
+}
+
+const KernelTable kernelTables[] = {
+  makeScalarKernelTable(std::make_index_sequence<OPS>()),
+  makeKernelTable<Sse2>(std::make_index_sequence<OPS>()),
+  makeKernelTable<Avx2>(std::make_index_sequence<OPS>()),
+  makeKernelTable<Avx512>(std::make_index_sequence<OPS>())
+};
+
+Isa detectIsa() {
+  int info[4];
+  __cpuid(info, 0);
+  const int maxLeaf = info[0];
+
+  __cpuid(info, 1);
+  const bool sse2 = (info[3] & (1 << 26)) != 0;
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  const bool avx = (info[2] & (1 << 28)) != 0;
+
+  bool avx2 = false;
+  bool avx512 = false;
+  if (maxLeaf >= 7 && osxsave && avx) {
+    // the OS must save the ymm (and for AVX-512 the zmm and opmask) registers
+    const unsigned __int64 xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    avx2 = (info[1] & (1 << 5)) != 0 && (xcr0 & 0x6) == 0x6;
+    avx512 = (info[1] & (1 << 16)) != 0 && (xcr0 & 0xe6) == 0xe6;
+  }
+
+  return avx512 ? Isa::avx512 : avx2 ? Isa::avx2 : sse2 ? Isa::sse2 : Isa::scalar;
+}
+
+std::atomic<const KernelTable*>& currentKernels() {
+  static std::atomic<const KernelTable*> kernels(&kernelTables[(size_t)supportedIsa()]);
+  return kernels;
+}
+
+const KernelTable& activeKernels() { return *currentKernels().load(std::memory_order_relaxed); }
+}  // namespace
+
+CORE_API Isa tradery::kernels::supportedIsa() {
+  static const Isa isa = detectIsa();
+  return isa;
+}
+
+CORE_API Isa tradery::kernels::isa() { return (Isa)(currentKernels().load() - kernelTables); }
+
+CORE_API Isa tradery::kernels::setIsa(Isa isa) {
+  if (isa > supportedIsa()) {
+    isa = supportedIsa();
+  }
+  currentKernels() = &kernelTables[(size_t)isa];
+  return isa;
+}
+
+CORE_API const char* tradery::kernels::isaName(Isa isa) {
+  switch (isa) {
+    case Isa::scalar:
+      return "scalar";
+    case Isa::sse2:
+      return "SSE2";
+    case Isa::avx2:
+      return "AVX2";
+    case Isa::avx512:
+      return "AVX-512";
+    default:
+      return "unknown";
+  }
+}
+
+CORE_API void tradery::kernels::binary(BinaryOp op, const double* a, const double* b, double* out, size_t n) {
+  activeKernels()._seriesSeries[(size_t)op](a, b, out, n);
+}
+
+CORE_API void tradery::kernels::binary(BinaryOp op, const double* a, double value, double* out, size_t n) {
+  activeKernels()._seriesValue[(size_t)op](a, value, out, n);
+}
+
+CORE_API void tradery::kernels::binary(BinaryOp op, double value, const double* a, double* out, size_t n) {
+  activeKernels()._valueSeries[(size_t)op](value, a, out, n);
+}
+
+CORE_API void tradery::kernels::abs(const double* a, double* out, size_t n) { activeKernels()._abs(a, out, n); }
+
+CORE_API void tradery::kernels::copy(const double* a, double* out, size_t n) {
+  // memmove is already vectorized by the CRT and handles overlapping ranges
+  if (n > 0) {
+    std::memmove(out, a, n * sizeof(double));
+  }
+}
@@ -30,9 +30,9 @@ class TicksImpl : public Ticks, public Ideable {
   TicksImpl(const std::string& dataSourceName, const std::string& symbol,
             const Range* range)
       : Ticks(symbol),
-        Ideable(dataSourceName + " - ticks - " + symbol + (range == 0 ? "" : " - range: " + range->getId())),
-        _price(std::make_shared< SeriesImpl >(getId() + " - tick price - ")),
-        _size(std::make_shared< SeriesImpl >(getId() + " - tick size - ")),
+        Ideable(Id::make("ticks", dataSourceName, symbol, range == 0 ? std::string() : range->getId())),
+        _price(std::make_shared< SeriesImpl >(Id::make("tick price", getId()))),
+        _size(std::make_shared< SeriesImpl >(Id::make("tick size", getId()))),
         _type(std::make_shared < TickTypeSeries >()),
         _exchange(std::make_shared< ExchangeSeries >()) {}
 
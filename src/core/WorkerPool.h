@@ -0,0 +1,277 @@
+/*
+   Copyright (C) 2018-2020 Adrian Michel
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "structuredexception.h"
+#include <log.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** @file
+ *  \brief Process wide worker threads, reused by all the runs, and the
+ *  cancellation tokens of the runs
+ */
+
+/**
+ * Cancels one run. Each run has its own token, so canceling a run has no
+ * effect on the runs that follow it, or on other sessions running at the same
+ * time
+ */
+class CancellationToken {
+ private:
+  std::atomic_bool _canceled;
+
+ public:
+  CancellationToken() : _canceled(false) {}
+
+  void cancel() { _canceled = true; }
+  bool isCanceled() const { return _canceled; }
+
+  // true if canceled
+  explicit operator bool() const { return _canceled; }
+};
+
+using CancellationTokenPtr = std::shared_ptr<CancellationToken>;
+
+/**
+ * Long lived threads that run the tasks submitted to them.
+ *
+ * A run starts by submitting its tasks instead of creating its threads, so
+ * short runs start executing immediately. Workers are added when all of them
+ * are busy, so all the submitted tasks run at the same time: the tasks of a
+ * run can wait on each other, and runs of different sessions don't wait for
+ * each other. A worker that has been idle for the idle timeout ends, so the
+ * pool shrinks back after a run with many threads.
+ *
+ * Tasks should not throw - an exception thrown by a task is logged and
+ * dropped
+ *
+ * @see TaskGroup
+ */
+class WorkerPool {
+ public:
+  using Task = std::function<void()>;
+
+ private:
+  mutable std::mutex _mutex;
+  std::condition_variable _condition;
+  std::deque<Task> _tasks;
+  std::map<std::thread::id, std::thread> _workers;
+  // the workers that ended after being idle, to be joined
+  std::vector<std::thread::id> _ended;
+  // the workers waiting for a task
+  size_t _idle;
+  bool _stopped;
+  const std::chrono::milliseconds _idleTimeout;
+
+ private:
+  void work() {
+    StructuredException::install();
+
+    for (;;) {
+      Task task;
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        ++_idle;
+        _condition.wait_for(lock, _idleTimeout, [this]() -> bool { return _stopped || !_tasks.empty(); });
+        --_idle;
+        if (_tasks.empty()) {
+          // stopped, or idle for too long - joined by the next submit
+          if (!_stopped) {
+            _ended.push_back(std::this_thread::get_id());
+          }
+          break;
+        }
+        task = std::move(_tasks.front());
+        _tasks.pop_front();
+      }
+
+      try {
+        task();
+      }
+      catch (const std::exception& e) {
+        LOG(log_error, "Worker task exception: ", e.what());
+      }
+      catch (...) {
+        LOG(log_error, "Worker task unknown exception");
+      }
+    }
+  }
+
+  // takes the workers that ended after being idle, to be joined outside of
+  // the lock
+  std::vector<std::thread> ended() {
+    std::vector<std::thread> ended;
+    for (std::thread::id id : _ended) {
+      auto i = _workers.find(id);
+      ended.push_back(std::move(i->second));
+      _workers.erase(i);
+    }
+    _ended.clear();
+    return ended;
+  }
+
+ public:
+  WorkerPool(std::chrono::milliseconds idleTimeout = std::chrono::seconds(60)) : _idle(0), _stopped(false), _idleTimeout(idleTimeout) {}
+
+  /**
+   * Waits for the tasks already submitted to end, then stops the workers
+   */
+  ~WorkerPool() {
+    {
+      std::scoped_lock lock(_mutex);
+      _stopped = true;
+    }
+    _condition.notify_all();
+    for (auto& worker : _workers) {
+      worker.second.join();
+    }
+  }
+
+  /**
+   * Runs a task on an idle worker, or on a new worker if they are all busy
+   */
+  void submit(Task task) {
+    std::vector<std::thread> joinable;
+    {
+      std::scoped_lock lock(_mutex);
+      assert(!_stopped);
+      joinable = ended();
+      _tasks.push_back(std::move(task));
+      // each task waiting to run has its own idle worker
+      if (_idle < _tasks.size()) {
+        std::thread worker(&WorkerPool::work, this);
+        const std::thread::id id = worker.get_id();
+        _workers.emplace(id, std::move(worker));
+      }
+      else {
+        _condition.notify_one();
+      }
+    }
+    for (std::thread& worker : joinable) {
+      worker.join();
+    }
+  }
+
+  size_t workers() const {
+    std::scoped_lock lock(_mutex);
+    return _workers.size() - _ended.size();
+  }
+};
+
+/**
+ * Initializes the current thread with a ThreadInitializer while in scope.
+ *
+ * The tasks of a run are in scope for the whole run, so each run calls init
+ * and uninit on the worker running each of its tasks, as it did on its own
+ * threads, and the initializer only has to remain valid for the run. A worker
+ * reused by later runs is initialized again by each of them
+ */
+class ThreadInit {
+ private:
+  ThreadInitializer* const _initializer;
+
+ public:
+  ThreadInit(ThreadInitializer* initializer) : _initializer(initializer) {
+    if (_initializer != 0) {
+      _initializer->init();
+    }
+  }
+
+  ~ThreadInit() {
+    if (_initializer != 0) {
+      _initializer->uninit();
+    }
+  }
+};
+
+/**
+ * The worker pool created by tradery::init, or 0 before init and after uninit
+ */
+extern WorkerPool* _workerPool;
+
+/**
+ * A set of tasks run by a WorkerPool, that can be waited for together.
+ *
+ * Without a pool, each task runs on its own thread
+ */
+class TaskGroup {
+ private:
+  WorkerPool* _pool;
+
+  std::mutex _mutex;
+  std::condition_variable _done;
+  size_t _running;
+  // the threads running the tasks if there is no pool
+  std::vector<std::thread> _threads;
+
+ public:
+  TaskGroup(WorkerPool* pool) : _pool(pool), _running(0) {}
+
+  ~TaskGroup() { wait(); }
+
+  void run(WorkerPool::Task task) {
+    if (_pool == 0) {
+      _threads.emplace_back(std::move(task));
+      return;
+    }
+
+    {
+      std::scoped_lock lock(_mutex);
+      ++_running;
+    }
+    _pool->submit([this, task]() {
+      try {
+        task();
+      }
+      catch (...) {
+        LOG(log_error, "Task group task exception");
+      }
+      // notified under the lock, as the group can be destroyed as soon as
+      // wait returns
+      std::scoped_lock lock(_mutex);
+      if (--_running == 0) {
+        _done.notify_all();
+      }
+    });
+  }
+
+  /**
+   * Waits for all the tasks run so far to end
+   */
+  void wait() {
+    for (std::thread& thread : _threads) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+    _threads.clear();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock, [this]() -> bool { return _running == 0; });
+  }
+};
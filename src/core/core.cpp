@@ -120,6 +120,9 @@ std::string Signal::signalTypeAsString(SignalType type) {
 }
 
 extern SeriesCache* _cache;
+extern SynchronizerCache* _synchronizerCache;
+extern PanelCache* _panelCache;
+extern WorkerPool* _workerPool;
 
 CORE_API void tradery::init(unsigned int cacheSize) {
   TA_RetCode retCode;
@@ -132,13 +135,33 @@ CORE_API void tradery::init(unsigned int cacheSize) {
     LOG(log_error, "Error initializing TA-LIB: ", retCode);
   }
 
-  // the data cache is disabled for now
-  _cache = new SeriesCache(100, false);
+  // the cache size is in MB. The data cache gets that budget, and so do the
+  // series cache, the synchronizer cache and the panel cache together: the
+  // synchronizers and panels are small next to the series calculated on the
+  // bars, and each get a sixteenth of the budget
+  // the series cache is disabled unless enabled by enableSeriesCache
+  const uint64_t budget = cacheSize * CACHE_SIZE_UNIT;
+  _cache = new SeriesCache(budget - budget / 8, false);
+  _synchronizerCache = new SynchronizerCache(budget / 16, true);
+  _panelCache = new PanelCache(budget / 16, true);
   _dataManager = new DataManagerImpl(cacheSize);
+  _workerPool = new WorkerPool();
+}
+
+CORE_API void tradery::enableSeriesCache(bool enable) {
+  assert(_cache != 0);
+  _cache->enable(enable);
 }
 
 CORE_API void tradery::uninit() {
+  // waits for the runs still going on
+  delete _workerPool;
+  _workerPool = 0;
   delete _cache;
+  delete _synchronizerCache;
+  _synchronizerCache = 0;
+  delete _panelCache;
+  _panelCache = 0;
   delete _dataManager;
   TA_Shutdown();
 }
@@ -166,6 +189,25 @@ CORE_API void tradery::setDataCacheSize(unsigned int cacheSize) {
   _dataManager->setCacheSize(cacheSize);
 }
 
+CORE_API void tradery::getCacheStats(CacheStats& seriesCacheStats, CacheStats& dataCacheStats) {
+  assert(_cache != 0);
+  assert(_dataManager != 0);
+  _cache->getStats(seriesCacheStats);
+  // the synchronizers are reported with the series they synchronize
+  CacheStats synchronizerCacheStats;
+  _synchronizerCache->getStats(synchronizerCacheStats);
+  for (const CacheStats::value_type& i : synchronizerCacheStats) {
+    seriesCacheStats[i.first] += i.second;
+  }
+  _dataManager->getCacheStats(dataCacheStats);
+  // the panels are reported with the data they are made from
+  CacheStats panelCacheStats;
+  _panelCache->getStats(panelCacheStats);
+  for (const CacheStats::value_type& i : panelCacheStats) {
+    dataCacheStats[i.first] += i.second;
+  }
+}
+
 CORE_API void Session::run(bool asynch, unsigned int threads, bool cpuAffinity, DateTimeRangePtr range, DateTime startTradesDateTime) {
   _defScheduler->run(asynch, threads, cpuAffinity, range, startTradesDateTime);
 }
@@ -215,6 +257,12 @@ CORE_API void Session::cancelAsync() const { _defScheduler->cancelAsync(); }
 
 CORE_API void Session::resetRunnables() { _defScheduler->resetRunnables(); }
 
+CORE_API void Session::setPrefetch(unsigned int depth, unsigned int threads) { _defScheduler->setPrefetch(depth, threads); }
+
+CORE_API void Session::setSymbolMajor(bool symbolMajor) { _defScheduler->setSymbolMajor(symbolMajor); }
+
+CORE_API void Session::setRunProfile(const std::string& fileName) { _defScheduler->setRunProfile(fileName); }
+
 CORE_API const std::string Signal::csvHeaderLine() {
   return "Symbol,Signal date/time,Shares,Side,Type,Price,Name,System id, System name, Position id";
 }
@@ -0,0 +1,132 @@
+/*
+   Copyright (C) 2018-2020 Adrian Michel
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+// dataconverter: converts text data files (formats 1 to 4) into binary
+// columnar files (format 5), which are loaded without parsing.
+//
+// The source directory is walked recursively, and each converted file is
+// written to the same relative path under the destination directory, with the
+// new extension
+
+#include "pch.h"
+
+namespace po = boost::program_options;
+namespace fs = std::filesystem;
+
+enum ExitCode { success, config_error, conversion_error };
+
+// converts the source file found under the source directory into the file at
+// the same relative path under the destination directory
+bool convert(const fs::path& source, const fs::path& sourceDir, const fs::path& destinationDir, const std::string& newExt, Format format, bool compress) {
+  try {
+    fs::path destination = destinationDir / fs::relative(source, sourceDir);
+    destination.replace_extension(newExt);
+
+    std::unique_ptr<FileDataSource> dataSource(FileDataSource::make(Info("dataconverter", ""), source.parent_path().string(), source.extension().string(), format, true, fatal));
+
+    DataInfo dataInfo(dataSource.get(), std::make_shared<Symbol>(source.stem().string()));
+    DataSource::DataXPtr data = dataSource->getData(&dataInfo);
+    BarsPtr bars = data->getDataCollection();
+
+    BinaryBarsColumns columns;
+    columns.reserve(bars->size());
+    for (size_t n = 0; n < bars->size(); ++n) {
+      columns.add(bars->time(n).ticks(), bars->open(n), bars->high(n), bars->low(n), bars->close(n), bars->volume(n), bars->openInterest(n));
+    }
+
+    fs::create_directories(destination.parent_path());
+    std::ofstream file(destination, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    if (!file) {
+      std::cerr << "Could not create " << destination.string() << std::endl;
+      return false;
+    }
+
+    columns.write(file, compress);
+    std::cout << source.string() << " -> " << destination.string() << ", " << columns.size() << " bars" << std::endl;
+    return true;
+  }
+  catch (const DataSourceException& e) {
+    std::cerr << source.string() << ": " << e.message() << std::endl;
+  }
+  catch (const BarException& e) {
+    std::cerr << source.string() << ": " << e.message() << std::endl;
+  }
+  catch (const std::exception& e) {
+    // filesystem and stream errors
+    std::cerr << source.string() << ": " << e.what() << std::endl;
+  }
+  return false;
+}
+
+int main(int argc, char* argv[]) {
+  po::options_description desc("dataconverter options");
+  desc.add_options()
+    ("help,h", "print this help message")
+    ("source,s", po::value<std::string>()->required(), "the directory containing the text data files")
+    ("destination,d", po::value<std::string>()->required(), "the directory where the binary data files will be written")
+    ("format,f", po::value<int>()->default_value(1), "the format of the text data files, 1 to 4")
+    ("ext,e", po::value<std::string>()->default_value("csv"), "the extension of the text data files")
+    ("newext,n", po::value<std::string>()->default_value("tbar"), "the extension of the binary data files")
+    ("compress,c", "delta encode the time column");
+
+  po::variables_map vm;
+  try {
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    if (vm.contains("help")) {
+      std::cout << desc << std::endl;
+      return success;
+    }
+    po::notify(vm);
+  }
+  catch (const po::error& e) {
+    std::cerr << e.what() << std::endl << desc << std::endl;
+    return config_error;
+  }
+
+  const int format = vm["format"].as<int>();
+  if (format < 1 || format > 4) {
+    std::cerr << "The format must be between 1 and 4" << std::endl;
+    return config_error;
+  }
+
+  const fs::path source(vm["source"].as<std::string>());
+  const fs::path destination(vm["destination"].as<std::string>());
+  const std::string ext = "." + vm["ext"].as<std::string>();
+  const std::string newExt = "." + vm["newext"].as<std::string>();
+  const bool compress = vm.contains("compress");
+
+  if (!fs::is_directory(source)) {
+    std::cerr << "Source directory not found: " << source.string() << std::endl;
+    return config_error;
+  }
+
+  size_t converted = 0;
+  size_t failed = 0;
+  for (const fs::directory_entry& entry : fs::recursive_directory_iterator(source)) {
+    if (entry.is_regular_file() && boost::iequals(entry.path().extension().string(), ext)) {
+      if (convert(entry.path(), source, destination, newExt, (Format)(format - 1), compress)) {
+        ++converted;
+      }
+      else {
+        ++failed;
+      }
+    }
+  }
+
+  std::cout << converted << " files converted, " << failed << " failed" << std::endl;
+  return failed == 0 ? success : conversion_error;
+}
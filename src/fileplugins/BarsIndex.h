@@ -0,0 +1,224 @@
+/*
+   Copyright (C) 2018-2020 Adrian Michel
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * A sparse index of a text data file, used to go straight to the bars in a
+ * range instead of searching the file.
+ *
+ * It holds the time and offset of one bar in every INTERVAL, the first and
+ * last times, the number of bars, and what it was built for: the file stamp,
+ * the file size and the data format. An index which doesn't match the data
+ * file is ignored and rebuilt.
+ *
+ * Times are DateTime ticks, offsets are from the start of the file, in bytes
+ */
+class BarsIndex {
+ public:
+  static constexpr char MAGIC[4] = {'T', 'B', 'I', 'X'};
+  static constexpr uint32_t VERSION = 1;
+  static constexpr uint32_t INTERVAL = 256;
+
+  class Entry {
+   public:
+    __int64 ticks;
+    uint64_t offset;
+  };
+
+ private:
+  std::string _stamp;
+  uint64_t _fileSize;
+  int32_t _format;
+  uint64_t _count;
+  __int64 _first;
+  __int64 _last;
+  // false if the times are not in order, in which case the entries can't be
+  // used to find a range
+  bool _sorted;
+  std::vector<Entry> _entries;
+
+  BarsIndex() : _fileSize(0), _format(0), _count(0), _first(0), _last(0), _sorted(true) {}
+
+ public:
+  BarsIndex(const std::string& stamp, uint64_t fileSize, int format)
+      : _stamp(stamp), _fileSize(fileSize), _format(format), _count(0), _first(0), _last(0), _sorted(true) {}
+
+  /**
+   * Adds the next bar of the file - bars must be added in the order they are in
+   * the file
+   *
+   * @param ticks  the bar time
+   * @param offset the offset of the line of the bar
+   */
+  void add(__int64 ticks, uint64_t offset) {
+    if (_count == 0) {
+      _first = ticks;
+    }
+    else if (ticks < _last) {
+      _sorted = false;
+    }
+    if (_count % INTERVAL == 0) {
+      _entries.push_back(Entry{ticks, offset});
+    }
+    _last = ticks;
+    ++_count;
+  }
+
+  bool matches(const std::string& stamp, uint64_t fileSize, int format) const { return _stamp == stamp && _fileSize == fileSize && _format == format; }
+
+  const std::string& stamp() const { return _stamp; }
+  uint64_t fileSize() const { return _fileSize; }
+  uint64_t count() const { return _count; }
+  __int64 first() const { return _first; }
+  __int64 last() const { return _last; }
+  bool sorted() const { return _sorted; }
+  const std::vector<Entry>& entries() const { return _entries; }
+
+  /**
+   * Where to start reading to find the first bar at or after a time: the offset
+   * of a bar before it, at most INTERVAL bars away, or of the first bar
+   */
+  uint64_t startOffset(__int64 from) const {
+    if (_entries.empty()) {
+      return _fileSize;
+    }
+    if (!_sorted) {
+      return _entries.front().offset;
+    }
+
+    auto i = std::lower_bound(_entries.begin(), _entries.end(), from, [](const Entry& entry, __int64 ticks) { return entry.ticks < ticks; });
+    return i == _entries.begin() ? i->offset : std::prev(i)->offset;
+  }
+
+  /**
+   * Where to stop reading to get all the bars up to a time: the offset of a
+   * bar after the last one at or before it, or the file size
+   */
+  uint64_t endOffset(__int64 to) const {
+    if (!_sorted) {
+      return _fileSize;
+    }
+
+    auto i = std::upper_bound(_entries.begin(), _entries.end(), to, [](__int64 ticks, const Entry& entry) { return ticks < entry.ticks; });
+    return i == _entries.end() ? _fileSize : i->offset;
+  }
+
+  /**
+   * Writes the index to a file. The index is written to a temporary file which
+   * is then renamed, so readers never see a partial index
+   *
+   * @return false if the index could not be written, for example if the
+   * directory is read only
+   */
+  bool save(const std::string& fileName) const {
+    const std::string tmp = fileName + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    {
+      std::ofstream os(tmp, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+      if (!os) {
+        return false;
+      }
+
+      const uint32_t stampSize = (uint32_t)_stamp.size();
+      const uint32_t sorted = _sorted;
+      const uint64_t entryCount = _entries.size();
+      os.write(MAGIC, sizeof(MAGIC));
+      write(os, VERSION);
+      write(os, _format);
+      write(os, sorted);
+      write(os, _fileSize);
+      write(os, _count);
+      write(os, _first);
+      write(os, _last);
+      write(os, stampSize);
+      os.write(_stamp.data(), stampSize);
+      write(os, entryCount);
+      os.write(reinterpret_cast<const char*>(_entries.data()), _entries.size() * sizeof(Entry));
+      if (!os) {
+        os.close();
+        std::error_code error;
+        std::filesystem::remove(tmp, error);
+        return false;
+      }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tmp, fileName, error);
+    if (error) {
+      std::filesystem::remove(tmp, error);
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * Reads an index written by save
+   *
+   * @return the index, or 0 if the file doesn't exist or is not a valid index
+   */
+  static std::unique_ptr<BarsIndex> load(const std::string& fileName) {
+    std::ifstream is(fileName, std::ios_base::in | std::ios_base::binary);
+    if (!is) {
+      return 0;
+    }
+
+    std::unique_ptr<BarsIndex> index(new BarsIndex());
+    char magic[sizeof(MAGIC)];
+    uint32_t version;
+    uint32_t sorted;
+    uint32_t stampSize;
+    uint64_t entryCount;
+    if (!is.read(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || !read(is, version) || version != VERSION || !read(is, index->_format) ||
+        !read(is, sorted) || !read(is, index->_fileSize) || !read(is, index->_count) || !read(is, index->_first) || !read(is, index->_last) ||
+        !read(is, stampSize) || stampSize > 1024) {
+      return 0;
+    }
+    index->_sorted = sorted != 0;
+
+    index->_stamp.resize(stampSize);
+    if (!is.read(index->_stamp.data(), stampSize) || !read(is, entryCount) || entryCount != (index->_count + INTERVAL - 1) / INTERVAL) {
+      return 0;
+    }
+
+    index->_entries.resize((size_t)entryCount);
+    if (!is.read(reinterpret_cast<char*>(index->_entries.data()), index->_entries.size() * sizeof(Entry))) {
+      return 0;
+    }
+    return index;
+  }
+
+ private:
+  template <typename T>
+  static void write(std::ostream& os, const T& value) {
+    os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template <typename T>
+  static bool read(std::istream& is, T& value) {
+    return (bool)is.read(reinterpret_cast<char*>(&value), sizeof(T));
+  }
+};
@@ -0,0 +1,191 @@
+/*
+   Copyright (C) 2018-2020 Adrian Michel
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <charconv>
+#include <cstring>
+#include <emmintrin.h>
+#include <intrin.h>
+
+/**
+ * Helpers used to parse bars straight from a data file mapped in memory,
+ * without making strings or Bar objects.
+ *
+ * They only accept the common, well formed cases and return false for
+ * everything else, so the caller can fall back on the string parsers, which
+ * have the final say on what is skipped and what is an error
+ */
+
+/**
+ * The values of a bar parsed from a line
+ */
+class BarFields {
+ public:
+  DateTime time;
+  double open;
+  double high;
+  double low;
+  double close;
+  unsigned long volume;
+};
+
+/**
+ * Returns the first '\n' or '\r' in [p, end), or end. Looks at 16 characters
+ * at a time
+ */
+inline const char* findEol(const char* p, const char* end) {
+  const __m128i nl = _mm_set1_epi8('\n');
+  const __m128i cr = _mm_set1_epi8('\r');
+
+  for (; end - p >= 16; p += 16) {
+    const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chars, nl), _mm_cmpeq_epi8(chars, cr)));
+    if (mask != 0) {
+      unsigned long index;
+      _BitScanForward(&index, mask);
+      return p + index;
+    }
+  }
+
+  for (; p < end && *p != '\n' && *p != '\r'; ++p);
+  return p;
+}
+
+/**
+ * Skips the end of line characters at p, returns the start of the next line
+ */
+inline const char* skipEol(const char* p, const char* end) {
+  for (; p < end && (*p == '\n' || *p == '\r'); ++p);
+  return p;
+}
+
+/**
+ * Returns the start of the line that contains p
+ */
+inline const char* lineStart(const char* begin, const char* p) {
+  for (; p > begin && p[-1] != '\n' && p[-1] != '\r'; --p);
+  return p;
+}
+
+/**
+ * Parses a number that takes exactly [begin, end)
+ */
+template <class T>
+bool parseNumber(const char* begin, const char* end, T& value) {
+  const std::from_chars_result result = std::from_chars(begin, end, value);
+  return result.ec == std::errc() && result.ptr == end;
+}
+
+/**
+ * Iterates over the fields of a line. As with Tokenizer, consecutive
+ * separators are collapsed. Spaces and tabs around a field are ignored
+ */
+class FieldScanner {
+ private:
+  const char* _p;
+  const char* const _end;
+  const char* const _separators;
+
+ private:
+  bool isSeparator(char c) const { return c != 0 && strchr(_separators, c) != 0; }
+  static bool isSpace(char c) { return c == ' ' || c == '\t'; }
+
+ public:
+  FieldScanner(const char* begin, const char* end, const char* separators)
+      : _p(begin), _end(end), _separators(separators) {}
+
+  /**
+   * Gets the next field
+   *
+   * @return false if there are no more fields
+   */
+  bool next(const char*& begin, const char*& end) {
+    for (; _p < _end && isSeparator(*_p); ++_p);
+    begin = _p;
+    for (; _p < _end && !isSeparator(*_p); ++_p);
+    end = _p;
+
+    for (; begin < end && isSpace(*begin); ++begin);
+    for (; end > begin && isSpace(end[-1]); --end);
+    return begin < end;
+  }
+
+  bool next(double& value) {
+    const char* begin;
+    const char* end;
+    return next(begin, end) && parseNumber(begin, end, value);
+  }
+
+  bool next(unsigned long& value) {
+    const char* begin;
+    const char* end;
+    return next(begin, end) && parseNumber(begin, end, value);
+  }
+};
+
+/**
+ * Makes a date with the same rules as Date(const std::string&, DateFormat...):
+ * 2 digit years are in 1950..2049, and years must be in 1800..2100
+ */
+inline bool makeDate(unsigned int year, unsigned int month, unsigned int day, Date& date) {
+  constexpr unsigned int days[] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+  year = year < 50 ? year + 2000 : (year < 100 ? year + 1900 : year);
+  if (year < 1800 || year > 2100 || month < 1 || month > 12 || day < 1 || day > days[month - 1] ||
+      month == 2 && day == 29 && !(year % 4 == 0 && (year % 100 != 0 || year % 400 == 0))) {
+    return false;
+  }
+  date = Date(year, month, day);
+  return true;
+}
+
+/**
+ * m/d/y, with / or - as separators
+ */
+inline bool parseUSDate(const char* begin, const char* end, Date& date) {
+  const char* sep1 = begin;
+  for (; sep1 < end && *sep1 != '/' && *sep1 != '-'; ++sep1);
+  const char* sep2 = sep1 + (sep1 < end);
+  for (; sep2 < end && *sep2 != '/' && *sep2 != '-'; ++sep2);
+
+  unsigned int month;
+  unsigned int day;
+  unsigned int year;
+  return sep2 < end && parseNumber(begin, sep1, month) && parseNumber(sep1 + 1, sep2, day) && parseNumber(sep2 + 1, end, year) &&
+         makeDate(year, month, day, date);
+}
+
+/**
+ * yymmdd or yyyymmdd
+ */
+inline bool parseCompactDate(const char* begin, const char* end, Date& date) {
+  const ptrdiff_t yearLength = end - begin - 4;
+
+  unsigned int year;
+  unsigned int month;
+  unsigned int day;
+  return (yearLength == 2 || yearLength == 4) && parseNumber(begin, begin + yearLength, year) &&
+         parseNumber(begin + yearLength, begin + yearLength + 2, month) && parseNumber(begin + yearLength + 2, end, day) &&
+         makeDate(year, month, day, date);
+}
+
+/**
+ * Makes a time from a date and a time of day, without making a TimeDuration
+ */
+inline DateTime makeDateTime(const Date& date, unsigned int hours = 0, unsigned int minutes = 0, unsigned int seconds = 0) {
+  return DateTime::fromTicks(date.days() * DateTime::TICKS_PER_DAY + ((hours * 60 + minutes) * 60 + seconds) * DateTime::TICKS_PER_SECOND);
+}
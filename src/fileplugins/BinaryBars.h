@@ -0,0 +1,291 @@
+/*
+   Copyright (C) 2018-2020 Adrian Michel
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * The binary columnar bars format (format5).
+ *
+ * A file holds a BinaryBarsHeader followed by one column per bar value, each
+ * starting at an 8 byte aligned offset given in the header:
+ * - time: DateTime ticks (microseconds since 1970-01-01), as int64
+ * - open, high, low, close, volume, open interest: doubles
+ *
+ * Raw columns are used in place from the file mapped in memory. The time column
+ * can also be delta encoded, which makes it several times smaller, at the
+ * cost of decoding it when the file is loaded.
+ *
+ * Values are stored little endian, as in memory on all the supported
+ * platforms
+ */
+class BinaryBarsHeader {
+ public:
+  static constexpr char MAGIC[4] = {'T', 'B', 'A', 'R'};
+  static constexpr uint32_t VERSION = 1;
+
+  enum Column { time, open, high, low, close, volume, openInterest, columnCount };
+
+  enum Encoding : uint32_t {
+    raw,
+    // the differences between consecutive values, as zigzag LEB128 varints.
+    // Only used for the time column
+    delta
+  };
+
+  class ColumnInfo {
+   public:
+    uint32_t encoding;
+    uint32_t reserved;
+    // from the start of the file, in bytes
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  char magic[4];
+  uint32_t version;
+  uint64_t count;
+  ColumnInfo columns[columnCount];
+};
+
+class BinaryBarsException {
+ private:
+  const std::string _message;
+
+ public:
+  BinaryBarsException(const std::string& message) : _message(message) {}
+
+  const std::string& message() const { return _message; }
+};
+
+/**
+ * The columns of a set of bars, as written to a binary bars file
+ */
+class BinaryBarsColumns {
+ public:
+  std::vector<__int64> time;
+  std::vector<double> open;
+  std::vector<double> high;
+  std::vector<double> low;
+  std::vector<double> close;
+  std::vector<double> volume;
+  std::vector<double> openInterest;
+
+ public:
+  void add(__int64 ticks, double o, double h, double l, double c, double v, double oi) {
+    time.push_back(ticks);
+    open.push_back(o);
+    high.push_back(h);
+    low.push_back(l);
+    close.push_back(c);
+    volume.push_back(v);
+    openInterest.push_back(oi);
+  }
+
+  void reserve(size_t count) {
+    time.reserve(count);
+    open.reserve(count);
+    high.reserve(count);
+    low.reserve(count);
+    close.reserve(count);
+    volume.reserve(count);
+    openInterest.reserve(count);
+  }
+
+  size_t size() const { return time.size(); }
+
+  void clear() {
+    time.clear();
+    open.clear();
+    high.clear();
+    low.clear();
+    close.clear();
+    volume.clear();
+    openInterest.clear();
+  }
+
+  const std::vector<double>& column(BinaryBarsHeader::Column column) const {
+    switch (column) {
+      case BinaryBarsHeader::open:
+        return open;
+      case BinaryBarsHeader::high:
+        return high;
+      case BinaryBarsHeader::low:
+        return low;
+      case BinaryBarsHeader::close:
+        return close;
+      case BinaryBarsHeader::volume:
+        return volume;
+      default:
+        assert(column == BinaryBarsHeader::openInterest);
+        return openInterest;
+    }
+  }
+
+  /**
+   * Writes the columns in the binary bars format
+   *
+   * @param os          a binary output stream
+   * @param deltaTime   whether to delta encode the time column
+   */
+  void write(std::ostream& os, bool deltaTime = false) const {
+    std::string encodedTime;
+    if (deltaTime) {
+      __int64 previous = 0;
+      for (__int64 ticks : time) {
+        const uint64_t diff = (uint64_t)ticks - (uint64_t)previous;
+        // zigzag, so small negative differences are small too
+        uint64_t value = (diff << 1) ^ (uint64_t)((__int64)diff >> 63);
+        for (; value >= 0x80; value >>= 7) {
+          encodedTime.push_back((char)(value | 0x80));
+        }
+        encodedTime.push_back((char)value);
+        previous = ticks;
+      }
+    }
+
+    BinaryBarsHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BinaryBarsHeader::MAGIC, sizeof(header.magic));
+    header.version = BinaryBarsHeader::VERSION;
+    header.count = size();
+
+    uint64_t offset = sizeof(BinaryBarsHeader);
+    for (int n = 0; n < BinaryBarsHeader::columnCount; ++n) {
+      BinaryBarsHeader::ColumnInfo& info = header.columns[n];
+      info.encoding = n == BinaryBarsHeader::time && deltaTime ? BinaryBarsHeader::delta : BinaryBarsHeader::raw;
+      info.offset = offset;
+      info.size = info.encoding == BinaryBarsHeader::delta ? encodedTime.size() : size() * sizeof(double);
+      offset = (offset + info.size + 7) & ~(uint64_t)7;
+    }
+
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (int n = 0; n < BinaryBarsHeader::columnCount; ++n) {
+      const BinaryBarsHeader::ColumnInfo& info = header.columns[n];
+      if (n == BinaryBarsHeader::time) {
+        if (deltaTime) {
+          os.write(encodedTime.data(), encodedTime.size());
+        }
+        else {
+          os.write(reinterpret_cast<const char*>(time.data()), info.size);
+        }
+      }
+      else {
+        os.write(reinterpret_cast<const char*>(column((BinaryBarsHeader::Column)n).data()), info.size);
+      }
+
+      static const char padding[8] = {};
+      os.write(padding, (8 - info.size % 8) % 8);
+    }
+  }
+};
+
+/**
+ * Reads a binary bars file from memory, normally a file mapped in memory. The
+ * columns point into that memory, so it must outlive the reader
+ */
+class BinaryBarsReader {
+ private:
+  BinaryBarsHeader _header;
+  const char* const _data;
+  const __int64* _time;
+  std::vector<__int64> _decodedTime;
+
+ private:
+  const char* columnData(BinaryBarsHeader::Column column) const { return _data + _header.columns[column].offset; }
+
+  void decodeTime() {
+    const BinaryBarsHeader::ColumnInfo& info = _header.columns[BinaryBarsHeader::time];
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(columnData(BinaryBarsHeader::time));
+    const unsigned char* const end = p + info.size;
+
+    _decodedTime.reserve((size_t)_header.count);
+    __int64 previous = 0;
+    for (uint64_t n = 0; n < _header.count; ++n) {
+      uint64_t value = 0;
+      for (int shift = 0;; shift += 7) {
+        if (p == end || shift > 63) {
+          throw BinaryBarsException("invalid time column");
+        }
+        value |= (uint64_t)(*p & 0x7f) << shift;
+        if ((*p++ & 0x80) == 0) {
+          break;
+        }
+      }
+      previous = (__int64)((uint64_t)previous + ((value >> 1) ^ (0 - (value & 1))));
+      _decodedTime.push_back(previous);
+    }
+    _time = _decodedTime.data();
+  }
+
+ public:
+  /**
+   * @param data   the file content
+   * @param size   the file size
+   * @exception BinaryBarsException
+   *                   if the data is not a valid binary bars file
+   */
+  BinaryBarsReader(const char* data, size_t size)
+      : _data(data), _time(0) {
+    if (size < sizeof(BinaryBarsHeader)) {
+      throw BinaryBarsException("file too small");
+    }
+
+    memcpy(&_header, data, sizeof(_header));
+    if (memcmp(_header.magic, BinaryBarsHeader::MAGIC, sizeof(_header.magic)) != 0) {
+      throw BinaryBarsException("not a binary bars file");
+    }
+    if (_header.version != BinaryBarsHeader::VERSION) {
+      throw BinaryBarsException(std::string("unsupported version: ") + std::to_string(_header.version));
+    }
+
+    for (int n = 0; n < BinaryBarsHeader::columnCount; ++n) {
+      const BinaryBarsHeader::ColumnInfo& info = _header.columns[n];
+      if (info.offset % 8 != 0 || info.offset > size || info.size > size - info.offset) {
+        throw BinaryBarsException(std::string("invalid column: ") + std::to_string(n));
+      }
+      if (info.encoding == BinaryBarsHeader::raw ? info.size != _header.count * sizeof(double)
+                                                 : info.encoding != BinaryBarsHeader::delta || n != BinaryBarsHeader::time) {
+        throw BinaryBarsException(std::string("invalid column: ") + std::to_string(n));
+      }
+    }
+
+    if (_header.columns[BinaryBarsHeader::time].encoding == BinaryBarsHeader::delta) {
+      decodeTime();
+    }
+    else {
+      _time = reinterpret_cast<const __int64*>(columnData(BinaryBarsHeader::time));
+    }
+  }
+
+  BinaryBarsReader(const BinaryBarsReader&) = delete;
+  BinaryBarsReader& operator=(const BinaryBarsReader&) = delete;
+
+  size_t size() const { return (size_t)_header.count; }
+
+  const __int64* time() const { return _time; }
+
+  const double* column(BinaryBarsHeader::Column column) const {
+    assert(column != BinaryBarsHeader::time);
+    return reinterpret_cast<const double*>(columnData(column));
+  }
+};
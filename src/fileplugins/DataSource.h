@@ -16,10 +16,17 @@
 
 #pragma once
 
+#include <optional>
+
 #include <boost/algorithm/string.hpp>
 
 #include <datasource.h>
 
+#include "MappedFile.h"
+#include "BarsParser.h"
+#include "BinaryBars.h"
+#include "BarsIndex.h"
+
 //#define FILE_DS_DUMP
 
 enum Format {
@@ -27,6 +34,7 @@ enum Format {
   format2,  // yymmdd,hhmm,o,h,l,c,v
   format3,  // mm/dd/yyyy,o,h,l,c,v
   format4,  // yyyymmdd,o,h,l,c,v
+  format5,  // binary columnar, see BinaryBars.h
   no_format
 };
 
@@ -275,8 +283,24 @@ class Header : public Tokenizer {
  * @see DataSource
  */
 class FileDataSource : public tradery::DataSource {
+ public:
+  /**
+   * How the data files are parsed:
+   * - stream: read line by line, each line is split in strings and made into a
+   * Bar
+   * - mapped: the file is mapped in memory and the lines are parsed in place,
+   * adding the values straight to the bars collection. Lines the format
+   * doesn't recognize are parsed as with stream
+   */
+  enum class ParserMode { stream, mapped };
+
  private:
   ErrorHandlingMode _errorHandlingMode;
+  ParserMode _parserMode;
+  // ranged loads use a BarsIndex of the data file, kept in _indexPath, or
+  // next to the data file if _indexPath is empty
+  bool _indexed;
+  std::string _indexPath;
 
   const PosDateTime timeStamp(__int64 pos, std::istream& file) const {
     assert(pos >= 0);
@@ -307,6 +331,41 @@ class FileDataSource : public tradery::DataSource {
     return timeStamp(fileSize(file) - 1, file);
   }
 
+  // parses a line in place, or with parseBarLine if the format doesn't
+  // recognize it. Returns false if the line doesn't contain a bar
+  bool parseLine(const char* begin, const char* end, BarFields& bar) const {
+    if (parseBarFields(begin, end, bar)) {
+      return true;
+    }
+
+    std::unique_ptr<const Bar> parsed(parseBarLine(std::string(begin, end)));
+    if (!parsed) {
+      return false;
+    }
+    bar.time = parsed->time();
+    bar.open = parsed->getOpen();
+    bar.high = parsed->getHigh();
+    bar.low = parsed->getLow();
+    bar.close = parsed->getClose();
+    bar.volume = parsed->getVolume();
+    return true;
+  }
+
+  // the first line in [p, end) that contains a bar, or end
+  const char* findBar(const char* p, const char* end, BarFields& bar) const {
+    for (; p < end; p = skipEol(findEol(p, end), end)) {
+      try {
+        if (parseLine(p, findEol(p, end), bar)) {
+          return p;
+        }
+      }
+      catch (...) {
+        // a line with no data, same as timeStamp
+      }
+    }
+    return end;
+  }
+
   PosDateTime getCandidate(PosDateTime& begin, PosDateTime& end, std::istream& file) const {
     assert(begin);
     assert(end);
@@ -328,6 +387,99 @@ class FileDataSource : public tradery::DataSource {
     return prev ? timeStamp(prev.pos(), file) : PosDateTime();
   }
 
+  std::unique_ptr<BarsIndex> buildIndex(const std::string& stamp, const char* begin, const char* end) const {
+    std::unique_ptr<BarsIndex> index(std::make_unique<BarsIndex>(stamp, end - begin, _format));
+
+    BarFields bar;
+    for (const char* p = findBar(begin, end, bar); p < end; p = findBar(skipEol(findEol(p, end), end), end, bar)) {
+      index->add(bar.time.ticks(), p - begin);
+    }
+    return index;
+  }
+
+  std::unique_ptr<BarsIndex> buildIndex(const std::string& stamp, std::istream& file) const {
+    std::unique_ptr<BarsIndex> index(std::make_unique<BarsIndex>(stamp, fileSize(file), _format));
+
+    file.clear();
+    file.seekg(0);
+    std::string str;
+    for (__int64 pos = 0; std::getline(file, str); pos = file.tellg()) {
+      try {
+        BarPtr bar(parseBarLine(str));
+        if (bar) {
+          index->add(bar->time().ticks(), pos);
+        }
+      }
+      catch (...) {
+        // a line with no data, same as timeStamp
+      }
+    }
+    file.clear();
+    return index;
+  }
+
+  std::string indexFileName(const std::string& fileName) const {
+    if (_indexPath.empty()) {
+      return fileName + ".idx";
+    }
+    else {
+      // data files with the same name can be in different directories
+      const std::filesystem::path path(fileName);
+      return (std::filesystem::path(_indexPath) / (path.filename().string() + "." + std::to_string(std::hash<std::string>()(path.string())) + ".idx")).string();
+    }
+  }
+
+  // the index of a data file, built and saved if there is none, or if it was
+  // built for a different version of the file. Returns 0 if indexing is off
+  template <typename Build>
+  std::unique_ptr<BarsIndex> barsIndex(const std::string& fileName, uint64_t fileSize, Build build) const {
+    if (!_indexed) {
+      return 0;
+    }
+
+    const std::string stamp(getFileStamp(fileName));
+    const std::string indexFile(indexFileName(fileName));
+    std::unique_ptr<BarsIndex> index(BarsIndex::load(indexFile));
+    if (!index || !index->matches(stamp, fileSize, _format)) {
+      index = build(stamp);
+      // not being able to save the index only means it will be built again
+      index->save(indexFile);
+    }
+    return index;
+  }
+
+  // the start of the first line with a time >= td, or end if there is none
+  const char* findStart(const DateTime td, const char* begin, const char* end) const {
+    BarFields bar;
+
+    const char* first = findBar(begin, end, bar);
+    // couldn't find any dates at all, so probably the data is in the wrong
+    // format
+    if (first == end) {
+      throw DataFileException();
+    }
+
+    // the bars before low are < td, the bars starting at or after high are >=
+    // td. Both are always at the start of a line
+    const char* low = first;
+    const char* high = end;
+    while (low < high) {
+      const char* middle = lineStart(low, low + (high - low) / 2);
+      const char* candidate = findBar(middle, high, bar);
+
+      if (candidate == high) {
+        high = middle;
+      }
+      else if (bar.time < td) {
+        low = skipEol(findEol(candidate, high), high);
+      }
+      else {
+        high = middle;
+      }
+    }
+    return low;
+  }
+
   // returns -1 if td > end time in the file
   __int64 findStart(const DateTime td, std::istream& file) const {
 
@@ -405,6 +557,27 @@ class FileDataSource : public tradery::DataSource {
   //  void parseTicks( tradery::Addable< Tick >* ticks, t_ifstream& _file, const
   //  Range* range ) const throw ( BarException );
 
+  // the number of bars parsed before they are appended to the bars
+  static constexpr size_t APPEND_CHUNK = 4096;
+
+  // reserves room for the bars in the bars collection once the first bar
+  // is parsed, estimating their number from the length of its line
+  class Reserver {
+   private:
+    BarsAppender* _appender;
+    __int64 _bytes;
+
+   public:
+    Reserver(tradery::Addable<Bar>* bars, __int64 bytes) : _appender(dynamic_cast<BarsAppender*>(bars)), _bytes(bytes) {}
+
+    void reserve(size_t lineLength) {
+      if (_appender) {
+        _appender->reserve((size_t)(_bytes / (lineLength + 1)) + 1);
+        _appender = 0;
+      }
+    }
+  };
+
   /**
    * Parse the file and populate the BarsIAddable with bars
    *
@@ -413,61 +586,155 @@ class FileDataSource : public tradery::DataSource {
    * @param range
    * @exception BarException
    */
-  inline FilePositionInfo FileDataSource::parseBars(tradery::Addable<Bar>* bars, std::istream& _file, DateTimeRangePtr range, const std::string& symbol) const {
+  inline FilePositionInfo FileDataSource::parseBars(tradery::Addable<Bar>* bars, std::istream& _file, DateTimeRangePtr range, const std::string& symbol,
+                                                  const BarsIndex* index = 0) const {
     std::string str;
 
     __int64 startPos = 0;
     __int64 endPos = fileSize(_file);
 
     if (range) {
-      // todo - this shouldn't be a dynamic cast, should work for all ranges
-      startPos = findStart(range->from(), _file);
-
-      if (startPos < 0) {
-        return FilePositionInfo();
+      // bars from stopPos on are after the range
+      __int64 stopPos = endPos;
+      if (index) {
+        if (index->count() == 0) {
+          throw DataFileException();
+        }
+        startPos = index->startOffset(range->from().ticks());
+        stopPos = index->endOffset(range->to().ticks());
       }
       else {
+        // todo - this shouldn't be a dynamic cast, should work for all ranges
+        startPos = findStart(range->from(), _file);
+
+        if (startPos < 0) {
+          return FilePositionInfo();
+        }
         assert(timeStamp(startPos, _file) >= range->from());
-        _file.clear();
-        _file.seekg(startPos);
-
-        do {
-          endPos = _file.tellg();
-          std::getline(_file, str);
-          BarPtr pBar;
-
-          if ((pBar = BarPtr(parseBarLine(str))).get()) {
-            if (*range > *pBar) {
-              continue;
-            }
-            else if (*range < *pBar) {
-              break;
-            }
-            else {
-              bars->add(*pBar);
-            }
+      }
+
+      _file.clear();
+      _file.seekg(startPos);
+      Reserver reserver(bars, stopPos - startPos);
+
+      do {
+        endPos = _file.tellg();
+        if (endPos >= stopPos) {
+          break;
+        }
+        std::getline(_file, str);
+        BarPtr pBar;
+
+        if ((pBar = BarPtr(parseBarLine(str))).get()) {
+          if (*range > *pBar) {
+            continue;
+          }
+          else if (*range < *pBar) {
+            break;
           }
-        } while (!_file.eof());
+          else {
+            reserver.reserve(str.size());
+            bars->add(*pBar);
+          }
+        }
+      } while (!_file.eof());
 
-        // we only need to get if it's not eof - if it's eof, we alreay have
-        // that value from the top of the function and besides, tellg returns -1
-        // for eof
-        //	  COUT << _T( "endpos2: " ) << endPos << std::endl;
-      }
+      // we only need to get if it's not eof - if it's eof, we alreay have
+      // that value from the top of the function and besides, tellg returns -1
+      // for eof
+      //	  COUT << _T( "endpos2: " ) << endPos << std::endl;
     }
     else {
+      Reserver reserver(bars, endPos);
       do {
         std::getline(_file, str);
         BarPtr pBar;
-        size_t count = 0;
 
         if ((pBar = BarPtr(parseBarLine(str))).get()) {
+          reserver.reserve(str.size());
           bars->add(*pBar);
         }
       } while (!_file.eof());
     }
     return FilePositionInfo(startPos, endPos - startPos);
   }
+
+  /**
+   * Parse a file mapped in memory and populate the bars. If the bars are a
+   * BarsAppender, the values are added directly, without making Bar objects
+   *
+   * @param bars
+   * @param file
+   * @param range
+   * @param index  the index of the file, used instead of searching it for the
+   *               range if not 0
+   * @exception BarException
+   */
+  FilePositionInfo parseBars(tradery::Addable<Bar>* bars, const MappedFile& file, DateTimeRangePtr range, const BarsIndex* index = 0) const {
+    const char* const begin = file.begin();
+    const char* end = file.end();
+    const char* start = begin;
+    if (range) {
+      if (index) {
+        if (index->count() == 0) {
+          throw DataFileException();
+        }
+        start = begin + index->startOffset(range->from().ticks());
+        end = begin + index->endOffset(range->to().ticks());
+      }
+      else {
+        start = findStart(range->from(), begin, end);
+      }
+    }
+    BarsAppender* appender = dynamic_cast<BarsAppender*>(bars);
+    bool reserved = false;
+    // the bars are parsed into a chunk, which is appended to the bars in bulk
+    BinaryBarsColumns chunk;
+    if (appender) {
+      chunk.reserve(APPEND_CHUNK);
+    }
+    auto append = [appender, &chunk]() {
+      appender->add(chunk.size(), chunk.time.data(), chunk.open.data(), chunk.high.data(), chunk.low.data(), chunk.close.data(), chunk.volume.data(),
+                    chunk.openInterest.data());
+      chunk.clear();
+    };
+
+    const char* p = start;
+    for (BarFields bar; p < end; p = skipEol(findEol(p, end), end)) {
+      const char* eol = findEol(p, end);
+      if (!parseLine(p, eol, bar)) {
+        continue;
+      }
+      if (range) {
+        if (bar.time < range->from()) {
+          continue;
+        }
+        else if (range->to() < bar.time) {
+          break;
+        }
+      }
+
+      if (appender) {
+        if (!reserved) {
+          // estimate the number of bars from the length of the first one
+          appender->reserve((end - p) / (eol - p + 1) + 1);
+          reserved = true;
+        }
+        chunk.add(bar.time.ticks(), bar.open, bar.high, bar.low, bar.close, bar.volume, 0);
+        if (chunk.size() == APPEND_CHUNK) {
+          append();
+        }
+      }
+      else {
+        bars->add(Bar(bar.time, bar.open, bar.high, bar.low, bar.close, bar.volume));
+      }
+    }
+    if (chunk.size() > 0) {
+      append();
+    }
+    return FilePositionInfo(start - begin, p - start);
+  }
+
   static bool isCommentLine(const std::string& str) {
     return str.at(0) == '$' || str.at(0) == '#' || str.length() > 1 && str.at(0) == '/' && str.at(1) == '/';
   }
@@ -485,6 +752,54 @@ class FileDataSource : public tradery::DataSource {
    */
   virtual const tradery::Bar* parseBarLine(const std::string& str) const = 0;
 
+  /**
+   * Opens the data file and adds its bars to the collection
+   *
+   * @param bars     the collection of bars
+   * @param fileName the data file
+   * @param range    the range to read, or all the data if 0
+   * @param symbol   the symbol
+   * @return the location of the data read in the file, or no value if the file
+   *         could not be opened
+   */
+  virtual std::optional<FilePositionInfo> readBars(tradery::Addable<Bar>* bars, const std::string& fileName, DateTimeRangePtr range, const std::string& symbol) const {
+    if (_parserMode == ParserMode::mapped) {
+      MappedFile mappedFile(fileName);
+      if (!mappedFile) {
+        return std::nullopt;
+      }
+
+      std::unique_ptr<BarsIndex> index;
+      if (range) {
+        index = barsIndex(fileName, mappedFile.size(), [&](const std::string& stamp) { return buildIndex(stamp, mappedFile.begin(), mappedFile.end()); });
+      }
+      return parseBars(bars, mappedFile, range, index.get());
+    }
+    else {
+      std::ifstream file(fileName.c_str(), ios_base::in | ios_base::binary);
+      if (!file) {
+        return std::nullopt;
+      }
+
+      std::unique_ptr<BarsIndex> index;
+      if (range) {
+        index = barsIndex(fileName, fileSize(file), [&](const std::string& stamp) { return buildIndex(stamp, file); });
+      }
+      return parseBars(bars, file, range, symbol, index.get());
+    }
+  }
+
+ protected:
+  /**
+   * Parses a line in place, without allocating. Only called by the mapped
+   * parser
+   *
+   * @return false if the line is not a bar in the layout the format expects.
+   * The line is then parsed by parseBarLine, which decides whether it is
+   * skipped or it's an error
+   */
+  virtual bool parseBarFields(const char* begin, const char* end, BarFields& bar) const { return false; }
+
  private:
   // the root to which we add the relative path
   const std::string _path;
@@ -502,7 +817,9 @@ class FileDataSource : public tradery::DataSource {
         _ext(ext),
         _format(format),
         _flatData(flatData),
-        _errorHandlingMode(errorHandlingMode) {}
+        _errorHandlingMode(errorHandlingMode),
+        _parserMode(ParserMode::mapped),
+        _indexed(true) {}
 
  public:
   static FileDataSource* make(const Info& info, const std::string& path, const std::string& ext, Format format, bool flatData = true, ErrorHandlingMode errorHandlingMode = fatal);
@@ -520,9 +837,63 @@ class FileDataSource : public tradery::DataSource {
     return getFileStamp(FileName(_flatData).makePath(_path, symbol.symbol(), addExtension(symbol.symbol(), _ext))) == stamp;
   }
 
+  // the part of the data file between the offsets of the range in its index,
+  // if there is one for the current version of the file (none is built here),
+  // or else the part of the time between the first and last bars of the file
+  // that is in the range, which reads only those two bars
+  double rangeFraction(const DataInfo* dataInfo, const DateTimeRange& range) const override {
+    assert(dataInfo != 0);
+
+    const std::string& symbol(dataInfo->symbol().symbol());
+    const std::string fileName(FileName(_flatData).makePath(_path, symbol, addExtension(symbol, _ext)));
+    std::error_code error;
+    const uintmax_t size = std::filesystem::file_size(fileName, error);
+    if (error || size == 0) {
+      return -1;
+    }
+
+    if (_indexed) {
+      std::unique_ptr<BarsIndex> index(BarsIndex::load(indexFileName(fileName)));
+      if (index && index->matches(getFileStamp(fileName), size, _format)) {
+        const uint64_t start = index->startOffset(range.from().ticks());
+        const uint64_t end = index->endOffset(range.to().ticks());
+        return end > start ? (double)(end - start) / size : 0;
+      }
+    }
+
+    std::ifstream file(fileName.c_str(), ios_base::in | ios_base::binary);
+    if (!file) {
+      return -1;
+    }
+    const PosDateTime first(firstTimeStamp(file));
+    const PosDateTime last(lastTimeStamp(file));
+    if (!first || !last || !(last.dateTime() > first.dateTime())) {
+      return -1;
+    }
+
+    const DateTime from((std::max)(range.from(), first.dateTime()));
+    const DateTime to((std::min)(range.to(), last.dateTime()));
+    return to > from ? (double)(to.ticks() - from.ticks()) / (last.dateTime().ticks() - first.dateTime().ticks()) : 0;
+  }
+
   const std::string& dataPath() const { return _path; }
   const std::string& extension() const { return _ext; }
   Format format() const { return _format; }
+  ParserMode parserMode() const { return _parserMode; }
+  void setParserMode(ParserMode parserMode) { _parserMode = parserMode; }
+  bool indexed() const { return _indexed; }
+  // turns the BarsIndex used by ranged loads on or off
+  void setIndexed(bool indexed) { _indexed = indexed; }
+  const std::string& indexPath() const { return _indexPath; }
+  // the directory where index files are kept, instead of next to the data
+  // files, for example if the data directory is read only
+  void setIndexPath(const std::string& indexPath) {
+    _indexPath = indexPath;
+    if (!_indexPath.empty()) {
+      std::error_code error;
+      std::filesystem::create_directories(_indexPath, error);
+    }
+  }
 };
 
 // base for file data sources which have 7 fields: "date, time, open, high, low,
@@ -534,7 +905,11 @@ class FileDataSourceFormat7FieldsBase : public FileDataSource {
 
  protected:
   virtual DateTime parseDate(const std::string& date, const std::string& time) const = 0;
+  // parses the date and time fields in place, returns false if they are not in
+  // the expected format
+  virtual bool parseDateInPlace(const char* date, const char* dateEnd, const char* time, const char* timeEnd, DateTime& dateTime) const = 0;
   const tradery::Bar* parseBarLine(const std::string& str) const override;
+  bool parseBarFields(const char* begin, const char* end, BarFields& bar) const override;
 };
 
 // format 1 has 7 fields, date, time: m/d/y, h:m:s
@@ -545,6 +920,7 @@ class FileDataSourceFormat1 : public FileDataSourceFormat7FieldsBase {
 
  protected:
   DateTime parseDate(const std::string& date, const std::string& time) const;
+  bool parseDateInPlace(const char* date, const char* dateEnd, const char* time, const char* timeEnd, DateTime& dateTime) const override;
 };
 
 // format 2 has 7 fields, date, time: yymmdd, hhmm
@@ -555,6 +931,7 @@ class FileDataSourceFormat2 : public FileDataSourceFormat7FieldsBase {
 
  protected:
   DateTime parseDate(const std::string& date, const std::string& time) const;
+  bool parseDateInPlace(const char* date, const char* dateEnd, const char* time, const char* timeEnd, DateTime& dateTime) const override;
 };
 
 // base for file data sources which have 6 fields: "date, open, high, low,
@@ -567,7 +944,11 @@ class FileDataSourceFormat6FieldsBase : public FileDataSource {
 
  protected:
   virtual DateTime parseDate(const std::string& date) const = 0;
+  // parses the date field in place, returns false if it's not in the expected
+  // format
+  virtual bool parseDateInPlace(const char* date, const char* dateEnd, DateTime& dateTime) const = 0;
   const tradery::Bar* parseBarLine(const std::string& str) const override;
+  bool parseBarFields(const char* begin, const char* end, BarFields& bar) const override;
 };
 
 // format has 5 fields, and data is: m/d/y, time is implied to be 0:0:0
@@ -578,6 +959,7 @@ class FileDataSourceFormat3 : public FileDataSourceFormat6FieldsBase {
 
  protected:
   DateTime parseDate(const std::string& date) const override;
+  bool parseDateInPlace(const char* date, const char* dateEnd, DateTime& dateTime) const override;
 };
 
 class FileDataSourceFormat4 : public FileDataSourceFormat6FieldsBase {
@@ -587,6 +969,57 @@ class FileDataSourceFormat4 : public FileDataSourceFormat6FieldsBase {
 
  protected:
   DateTime parseDate(const std::string& date) const override;
+  bool parseDateInPlace(const char* date, const char* dateEnd, DateTime& dateTime) const override;
+};
+
+// format 5 is the binary columnar format written by the dataconverter tool,
+// see BinaryBars.h. The data is read directly from the mapped file, and there
+// are no lines to parse
+class FileDataSourceFormat5 : public FileDataSource {
+ public:
+  FileDataSourceFormat5(const Info& info, const std::string& path, const std::string& ext, bool flatData, ErrorHandlingMode errorHandlingMode)
+      : FileDataSource(info, path, ext, format5, flatData, errorHandlingMode) {}
+
+ protected:
+  const tradery::Bar* parseBarLine(const std::string& str) const override { return 0; }
+
+  // the position info is in bars, not bytes: the index of the first bar read
+  // and the number of bars
+  std::optional<FilePositionInfo> readBars(tradery::Addable<Bar>* bars, const std::string& fileName, DateTimeRangePtr range, const std::string& symbol) const override {
+    MappedFile file(fileName);
+    if (!file) {
+      return std::nullopt;
+    }
+
+    BinaryBarsReader reader(file.begin(), file.size());
+
+    const __int64* time = reader.time();
+    size_t first = 0;
+    size_t last = reader.size();
+    if (range) {
+      first = std::lower_bound(time, time + last, range->from().ticks()) - time;
+      last = std::upper_bound(time + first, time + last, range->to().ticks()) - time;
+    }
+
+    const size_t count = last - first;
+    const double* open = reader.column(BinaryBarsHeader::open) + first;
+    const double* high = reader.column(BinaryBarsHeader::high) + first;
+    const double* low = reader.column(BinaryBarsHeader::low) + first;
+    const double* close = reader.column(BinaryBarsHeader::close) + first;
+    const double* volume = reader.column(BinaryBarsHeader::volume) + first;
+    const double* openInterest = reader.column(BinaryBarsHeader::openInterest) + first;
+
+    if (BarsAppender* appender = dynamic_cast<BarsAppender*>(bars)) {
+      appender->add(count, time + first, open, high, low, close, volume, openInterest);
+    }
+    else {
+      for (size_t n = 0; n < count; ++n) {
+        bars->add(Bar(DateTime::fromTicks(time[first + n]), open[n], high[n], low[n], close[n], (unsigned long)volume[n], (unsigned long)openInterest[n]));
+      }
+    }
+
+    return FilePositionInfo(first, count);
+  }
 };
 
 inline FileDataSource* FileDataSource::make(const Info& info, const std::string& path, const std::string& ext, Format format, bool flatData, ErrorHandlingMode errorHandlingMode) {
@@ -603,6 +1036,9 @@ inline FileDataSource* FileDataSource::make(const Info& info, const std::string&
     case format4:
       return new FileDataSourceFormat4(info, path, ext, flatData, errorHandlingMode);
       break;
+    case format5:
+      return new FileDataSourceFormat5(info, path, ext, flatData, errorHandlingMode);
+      break;
     default:
       throw DataSourceException(DATA_SOURCE_FORMAT_ERROR, "Unknown data format", info.name());
       break;
@@ -703,6 +1139,74 @@ inline DateTime FileDataSourceFormat4::parseDate(const std::string& date) const
   return DateTime(Date(date, iso, ""), TimeDuration(0, 0, 0, 0));
 }
 
+// h:m:s
+inline bool FileDataSourceFormat1::parseDateInPlace(const char* date, const char* dateEnd, const char* time, const char* timeEnd, DateTime& dateTime) const {
+  const char* sep1 = std::find(time, timeEnd, ':');
+  const char* sep2 = sep1 == timeEnd ? timeEnd : std::find(sep1 + 1, timeEnd, ':');
+
+  unsigned int hour;
+  unsigned int min;
+  unsigned int sec;
+  Date d;
+  if (sep2 == timeEnd || !parseNumber(time, sep1, hour) || !parseNumber(sep1 + 1, sep2, min) || !parseNumber(sep2 + 1, timeEnd, sec) ||
+      hour > 23 || min > 59 || sec > 59 || !parseUSDate(date, dateEnd, d)) {
+    return false;
+  }
+  dateTime = makeDateTime(d, hour, min, sec);
+  return true;
+}
+
+// hhmm
+inline bool FileDataSourceFormat2::parseDateInPlace(const char* date, const char* dateEnd, const char* time, const char* timeEnd, DateTime& dateTime) const {
+  unsigned int hour;
+  unsigned int min;
+  Date d;
+  if (timeEnd - time != 4 || !parseNumber(time, time + 2, hour) || !parseNumber(time + 2, timeEnd, min) || hour > 23 || min > 59 ||
+      !parseCompactDate(date, dateEnd, d)) {
+    return false;
+  }
+  dateTime = makeDateTime(d, hour, min);
+  return true;
+}
+
+inline bool FileDataSourceFormat3::parseDateInPlace(const char* date, const char* dateEnd, DateTime& dateTime) const {
+  Date d;
+  if (!parseUSDate(date, dateEnd, d)) {
+    return false;
+  }
+  dateTime = makeDateTime(d);
+  return true;
+}
+
+inline bool FileDataSourceFormat4::parseDateInPlace(const char* date, const char* dateEnd, DateTime& dateTime) const {
+  Date d;
+  if (!parseCompactDate(date, dateEnd, d)) {
+    return false;
+  }
+  dateTime = makeDateTime(d);
+  return true;
+}
+
+inline bool FileDataSourceFormat7FieldsBase::parseBarFields(const char* begin, const char* end, BarFields& bar) const {
+  FieldScanner fields(begin, end, ", \t");
+
+  const char* date;
+  const char* dateEnd;
+  const char* time;
+  const char* timeEnd;
+  return fields.next(date, dateEnd) && fields.next(time, timeEnd) && parseDateInPlace(date, dateEnd, time, timeEnd, bar.time) &&
+         fields.next(bar.open) && fields.next(bar.high) && fields.next(bar.low) && fields.next(bar.close) && fields.next(bar.volume);
+}
+
+inline bool FileDataSourceFormat6FieldsBase::parseBarFields(const char* begin, const char* end, BarFields& bar) const {
+  FieldScanner fields(begin, end, ",");
+
+  const char* date;
+  const char* dateEnd;
+  return fields.next(date, dateEnd) && parseDateInPlace(date, dateEnd, bar.time) && fields.next(bar.open) && fields.next(bar.high) &&
+         fields.next(bar.low) && fields.next(bar.close) && fields.next(bar.volume);
+}
+
 inline DataSource::DataXPtr FileDataSource::makeBars(const std::string& symbol, const std::string& ext, DateTimeRangePtr range) const {
 // create an empty collection of bars
 // use a smart pointer (BarsIPtr) in case there is an exception, and the
@@ -713,48 +1217,48 @@ inline DataSource::DataXPtr FileDataSource::makeBars(const std::string& symbol,
 
   std::string fileName(FileName(_flatData).makePath(_path, symbol, addExtension(symbol, ext)));
 
-  std::ifstream _file;
-  _file.open(fileName.c_str(), ios_base::in | ios_base::binary);
-  if (!_file) {
-    // error opening the file - throw exception
-    fileNotFoundErrorHandler(symbol, fileName);
-    return 0;
-  }
-  else {
-    try {
-      // parse the file and populate the bars collection with bars
-      FilePositionInfo p = parseBars(bars.get(), _file, range, symbol);
-      bars->setDataLocationInfo(tradery::makeDataFileLocationInfo(fileName, p.start(), p.count()));
+  try {
+    // parse the file and populate the bars collection with bars
+    std::optional<FilePositionInfo> p = readBars(bars.get(), fileName, range, symbol);
+    if (!p) {
+      // error opening the file - throw exception
+      fileNotFoundErrorHandler(symbol, fileName);
+      return 0;
+    }
 
-      if ( bars->size() == 0) {
-        DataSourceException e = DataSourceException(DATA_ERROR, "No data available in the requested range for symbol: \""s + symbol + "\"", name());
-        throw e;
-      }
+    bars->setDataLocationInfo(tradery::makeDataFileLocationInfo(fileName, p->start(), p->count()));
 
-      //		parseBars( bars.get(), _file, range, symbol );
-      // release and return the pointer
-      // have to release so it won't be deleted by the smart pointer
-      return DataXPtr(std::make_shared< DataX >(bars, getFileStamp(fileName)));
-    }
-    catch (const DataFileException) {
-      throw DataSourceException(DATA_SOURCE_ERROR, "Could not find any valid date in data file, likely due to data wrong format ", name());
-    }
-    catch (const BarException&) {
-      // retthrow bar exception, it will be caught in scheduler
-      throw;
-    }
-    catch (const DateException& e) {
-      throw DataSourceException(DATE_STRING_ERROR, symbol + " - " + e.message(), name());
-    }
-    catch (const TimeException& e) {
-      throw DataSourceException(TIME_STRING_ERROR, symbol + ", " + e.time(), name());
-    }
-    catch (const DataSourceException & e) {
+    if ( bars->size() == 0) {
+      DataSourceException e = DataSourceException(DATA_ERROR, "No data available in the requested range for symbol: \""s + symbol + "\"", name());
       throw e;
     }
-    catch (...) {
-      throw DataSourceException(DATA_SOURCE_FORMAT_ERROR, symbol, name());
-    }
+
+    //		parseBars( bars.get(), _file, range, symbol );
+    // release and return the pointer
+    // have to release so it won't be deleted by the smart pointer
+    return DataXPtr(std::make_shared< DataX >(bars, getFileStamp(fileName)));
+  }
+  catch (const DataFileException) {
+    throw DataSourceException(DATA_SOURCE_ERROR, "Could not find any valid date in data file, likely due to data wrong format ", name());
+  }
+  catch (const BarException&) {
+    // retthrow bar exception, it will be caught in scheduler
+    throw;
+  }
+  catch (const DateException& e) {
+    throw DataSourceException(DATE_STRING_ERROR, symbol + " - " + e.message(), name());
+  }
+  catch (const TimeException& e) {
+    throw DataSourceException(TIME_STRING_ERROR, symbol + ", " + e.time(), name());
+  }
+  catch (const BinaryBarsException& e) {
+    throw DataSourceException(DATA_SOURCE_FORMAT_ERROR, symbol + ", " + e.message(), name());
+  }
+  catch (const DataSourceException & e) {
+    throw e;
+  }
+  catch (...) {
+    throw DataSourceException(DATA_SOURCE_FORMAT_ERROR, symbol, name());
   }
 }
 
@@ -763,7 +1267,7 @@ inline const std::string FileDataSource::getFileStamp(const std::string& fileNam
 
   ob << "File data source: " << name() << ", session: " << sessionName() << ", getting file stamp";
   //  outputSink().printLine( ob );
-  HANDLE file = CreateFile(s2ws(fileName).c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+  HANDLE file = CreateFile(s2ws(fileName).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
   FILETIME creation;
   FILETIME lastAccess;
   FILETIME lastWrite;
@@ -0,0 +1,84 @@
+/*
+   Copyright (C) 2018-2020 Adrian Michel
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+/**
+ * A read only view of a whole file, mapped in memory.
+ *
+ * Empty files can't be mapped, so they are open but have no data
+ */
+class MappedFile {
+ private:
+  HANDLE _file;
+  HANDLE _mapping;
+  const char* _data;
+  size_t _size;
+
+ private:
+  void close() {
+    if (_data != 0) {
+      UnmapViewOfFile(_data);
+      _data = 0;
+    }
+    if (_mapping != 0) {
+      CloseHandle(_mapping);
+      _mapping = 0;
+    }
+    if (_file != INVALID_HANDLE_VALUE) {
+      CloseHandle(_file);
+      _file = INVALID_HANDLE_VALUE;
+    }
+    _size = 0;
+  }
+
+ public:
+  MappedFile(const std::string& fileName)
+      : _file(INVALID_HANDLE_VALUE), _mapping(0), _data(0), _size(0) {
+    // shared as the stream parser shares the file, so the data files can be
+    // updated or replaced while they are being read
+    _file = CreateFile(s2ws(fileName).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, 0);
+    if (_file == INVALID_HANDLE_VALUE) {
+      return;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(_file, &size)) {
+      close();
+      return;
+    }
+
+    _size = (size_t)size.QuadPart;
+    if (_size > 0) {
+      _mapping = CreateFileMapping(_file, 0, PAGE_READONLY, 0, 0, 0);
+      _data = _mapping == 0 ? 0 : static_cast<const char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+      if (_data == 0) {
+        close();
+      }
+    }
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ~MappedFile() { close(); }
+
+  operator bool() const { return _file != INVALID_HANDLE_VALUE; }
+
+  const char* begin() const { return _data; }
+  const char* end() const { return _data + _size; }
+  size_t size() const { return _size; }
+};
@@ -24,6 +24,7 @@
 
 constexpr auto DATASOURCE_FORMAT1_NAME = "Data source plugin format 1";
 constexpr auto DATASOURCE_FORMAT3_NAME = "Data source plugin format 3";
+constexpr auto DATASOURCE_FORMAT5_NAME = "Data source plugin format 5 (binary)";
 
 // Cfileplugins1App
 // See fileplugins1.cpp for the implementation of this class
@@ -35,6 +36,8 @@ const Info dataSourceInfoFormat1("6188C38F-78FB-470c-A90D-C03FE37D5DEC", DATASOU
 const Info dataSourceInfoFormat1NewId(DATASOURCE_FORMAT1_NAME, "");
 const Info dataSourceInfoFormat3("3F8D0DAA-C11E-452c-A097-20127C0673E0", DATASOURCE_FORMAT3_NAME, "");
 const Info dataSourceInfoFormat3NewId(DATASOURCE_FORMAT3_NAME, "");
+const Info dataSourceInfoFormat5("9D5A4E21-7C3B-4f0e-B6A2-51E8C0F47D93", DATASOURCE_FORMAT5_NAME, "");
+const Info dataSourceInfoFormat5NewId(DATASOURCE_FORMAT5_NAME, "");
 const Info symbolsSourceInfo("E32C975A-ECE1-4e7f-BB49-A604F2EE8083", "Symbols Source plugin - symbols file specified dynamically", "");
 const Info statsInfo("4B6632DE-CD7B-43c6-932B-13D098E1E287", "Stats plugin", "Implemented as a signal handler plugin, using only the session notifications to calculate the stats");
 
@@ -484,6 +487,18 @@ class FileDataSourceFormat3ForWeb : public FileDataSourceFormat3 {
       : FileDataSourceFormat3(dataSourceInfoFormat3NewId, createString, "csv", flatData, errorHandlingMode) {}
 };
 
+class FileDataSourceFormat5ForWeb : public FileDataSourceFormat5 {
+ private:
+  // this is to show a "sanitized" error message in a web environment
+  virtual void fileNotFoundErrorHandler(const std::string& symbol, const std::string& fileName) const {
+    throw DataSourceException(OPENING_BARS_FILE_ERROR, "No data for symbol \""s + symbol + "\"", name());
+  }
+
+ public:
+  FileDataSourceFormat5ForWeb(const std::string& createString, bool flatData, ErrorHandlingMode errorHandlingMode)
+      : FileDataSourceFormat5(dataSourceInfoFormat5NewId, createString, "tbar", flatData, errorHandlingMode) {}
+};
+
 class FileDataSourcePlugin : public DataSourcePlugin {
  private:
   std::vector<std::shared_ptr<Info> > _configs;
@@ -494,6 +509,7 @@ class FileDataSourcePlugin : public DataSourcePlugin {
       : DataSourcePlugin(Info("C44EB64E-42A6-48ed-8C6C-3604C5B468DA", "", "")) {
     _configs.push_back(std::make_shared< Info >(dataSourceInfoFormat1));
     _configs.push_back(std::make_shared< Info >(dataSourceInfoFormat3));
+    _configs.push_back(std::make_shared< Info >(dataSourceInfoFormat5));
   }
 
   InfoPtr first() const override {
@@ -530,17 +546,39 @@ class FileDataSourcePlugin : public DataSourcePlugin {
       }
     }
 
+    FileDataSource::ParserMode parserMode(FileDataSource::ParserMode::mapped);
+
+    if ((*createStrings).size() > 2) {
+      // third element of vector is the parser mode
+      if ((*createStrings)[2] == PARSER_MODE_MAPPED) {
+        parserMode = FileDataSource::ParserMode::mapped;
+      }
+      else if ((*createStrings)[2] == PARSER_MODE_STREAM) {
+        parserMode = FileDataSource::ParserMode::stream;
+      }
+      else {
+        throw PluginException("File data source plugin 1", "Unknown parser mode string");
+      }
+    }
+
     // passing false, indicating that the data files are in various
     // subdirectories, not all in one dir (flat)
+    std::shared_ptr<FileDataSource> dataSource;
     if (id == dataSourceInfoFormat1.id()) {
-      return std::make_shared< FileDataSourceFormat1ForWeb >((*createStrings)[0], false, mode);
+      dataSource = std::make_shared< FileDataSourceFormat1ForWeb >((*createStrings)[0], false, mode);
     }
     else if (id == dataSourceInfoFormat3.id()) {
-      return std::make_shared< FileDataSourceFormat3ForWeb >((*createStrings)[0], false, mode);
+      dataSource = std::make_shared< FileDataSourceFormat3ForWeb >((*createStrings)[0], false, mode);
+    }
+    else if (id == dataSourceInfoFormat5.id()) {
+      dataSource = std::make_shared< FileDataSourceFormat5ForWeb >((*createStrings)[0], false, mode);
     }
     else {
       return 0;
     }
+
+    dataSource->setParserMode(parserMode);
+    return dataSource;
   }
 
   bool canCreate() const override { return false; }
@@ -319,11 +319,16 @@ using ErrorEventSinkPtr = std::shared_ptr<ErrorEventSink>;
 //@}
 
 /**
- * does per thread init/uninit, before and after each system run
+ * does per thread init/uninit for the threads that run the systems and load
+ * their data
  * the implementation of init and uninit may need to be synchronized (made
  * thread safe) as the same initializer object is used for all threads in the
  * same SchedulerI object
  *
+ * init is called on each thread before a run and uninit on the same thread
+ * after it, so the initializer must remain valid for the run. The threads are
+ * reused by the runs, so a thread can be initialized again by a later run
+ *
  * @see SchedulerI::setThreadInitializer
  */
 class ThreadInitializer {
@@ -357,6 +362,8 @@ class RunnableRunInfo {
   const bool _errors;
   const std::string& _threadName;
   const unsigned int _cpuNumber;
+  // time spent loading the data in the background, 0 if it wasn't prefetched
+  const double _prefetchDuration;
 
  public:
   /**
@@ -364,15 +371,20 @@ class RunnableRunInfo {
    *
    * @param status
    * @param symbol
-   * @param dataDuration
+   * @param dataDuration  the time the runnable thread spent getting the data.
+   *                      If the data was prefetched, this is only the time it
+   *                      waited for it
    * @param runnableDuration
    * @param errors
+   * @param prefetchDuration
+   *                      the time it took to load the data in the background,
+   *                      overlapped with other runs. 0 if it wasn't prefetched
    */
   RunnableRunInfo(const std::string& status, const std::string& symbol, double dataDuration, double runnableDuration,
-                  unsigned __int64 dataUnitCount, bool errors, const std::string& threadName)
+                  unsigned __int64 dataUnitCount, bool errors, const std::string& threadName, double prefetchDuration = 0)
       : _status(status), _symbol(symbol), _dataDuration(dataDuration),
         _runnableDuration(runnableDuration), _errors(errors),
-        _dataUnitCount(dataUnitCount), _threadName(threadName), _cpuNumber(getCurrentCPUNumber()) {}
+        _dataUnitCount(dataUnitCount), _threadName(threadName), _cpuNumber(getCurrentCPUNumber()), _prefetchDuration(prefetchDuration) {}
 
   /**
    *
@@ -382,6 +394,7 @@ class RunnableRunInfo {
   const std::string& symbol() const { return _symbol; }
   double dataDuration() const { return _dataDuration; }
   double runnableDuration() const { return _runnableDuration; }
+  double prefetchDuration() const { return _prefetchDuration; }
   const std::string& threadName() const { return _threadName; }
   unsigned long cpuNumber() const { return _cpuNumber; }
   unsigned __int64 dataUnitCount() const { return _dataUnitCount; }
@@ -421,6 +434,11 @@ class RunnableRunInfoHandler {
  * @see Runnable
  * @see Simulator
  */
+// the default number of symbols loaded ahead of the runnables, and of threads
+// loading them. See Scheduler::setPrefetch
+constexpr unsigned int DEFAULT_PREFETCH_DEPTH = 4;
+constexpr unsigned int DEFAULT_PREFETCH_THREADS = 1;
+
 class CORE_API Scheduler {
  public:
   virtual ~Scheduler() {}
@@ -500,6 +518,10 @@ class CORE_API Scheduler {
    *
    * @param asynch runs in asynchrnous mode if true, or synchronous mode if
    * false
+   * @param cpuAffinity
+   *               if true, each run thread is pinned to its own logical
+   * processor: one per physical core first, the cores of a NUMA node next to
+   * each other, then the SMT siblings
    * @param range  The range on which the runnables will be run on. The range
    * can be a time range or bar range. If 0, it will run on all available data.
    * @exception SchedulerReentrantRunCallException
@@ -569,6 +591,58 @@ class CORE_API Scheduler {
    */
   virtual void cancelAsync() = 0;
   virtual void resetRunnables() = 0;
+
+  /**
+   * Sets how the data is loaded during a run: the data for the next depth
+   * symbols of each symbols iterator is loaded on dedicated threads, while the
+   * runnables run on the current symbols.
+   *
+   * Takes effect on the next call to run
+   *
+   * @param depth   the maximum number of symbols loaded ahead. If 0, the data
+   *                is loaded by the runnable threads, before running on each
+   *                symbol
+   * @param threads the number of threads loading the data, per symbols
+   *                iterator
+   */
+  virtual void setPrefetch(unsigned int depth, unsigned int threads = DEFAULT_PREFETCH_THREADS) = 0;
+
+  /**
+   * Sets the order in which the runnables are run on the symbols.
+   *
+   * By default each runnable goes through its list of symbols. In
+   * symbol-major mode, the data of each symbol is loaded once and all the
+   * systems are run on it back to back before moving to the next symbol, so
+   * the bars the systems have in common are reused while still cached, and
+   * so are their common indicators if the series cache is enabled (see
+   * enableSeriesCache). Each system is still run only on the symbols of its own
+   * iterator, and a symbol in several iterators is loaded once for all their
+   * systems. The runnables go through their symbols only once (again is not
+   * called)
+   *
+   * Takes effect on the next call to run
+   *
+   * @param symbolMajor true for symbol-major mode
+   */
+  virtual void setSymbolMajor(bool symbolMajor) = 0;
+
+  /**
+   * Sets the file keeping how long each system took to run on each symbol in
+   * previous runs.
+   *
+   * When set, the symbols of each run are all taken from their iterators
+   * before the run starts and run longest first (symbols never run before
+   * first), so the last symbols to run are short ones and the threads finish
+   * at about the same time. The durations of the run are saved to the file
+   * at the end of the run. Symbols iterators that block waiting for symbols
+   * should not be used with a run profile
+   *
+   * Takes effect on the next call to run
+   *
+   * @param fileName the run profile file, or empty to run the symbols in the
+   *                 order of their iterators
+   */
+  virtual void setRunProfile(const std::string& fileName) = 0;
 };
 
 /**
@@ -732,6 +806,27 @@ class CORE_API Session {
   void cancelAsync() const;
 
   void resetRunnables();
+
+  /**
+   * Sets how the data is loaded during a run
+   *
+   * @see Scheduler::setPrefetch
+   */
+  void setPrefetch(unsigned int depth, unsigned int threads = DEFAULT_PREFETCH_THREADS);
+
+  /**
+   * Sets the order in which the runnables are run on the symbols
+   *
+   * @see Scheduler::setSymbolMajor
+   */
+  void setSymbolMajor(bool symbolMajor);
+
+  /**
+   * Sets the file used to run the longest symbols first
+   *
+   * @see Scheduler::setRunProfile
+   */
+  void setRunProfile(const std::string& fileName);
 };
 
 /**
@@ -754,5 +849,63 @@ CORE_API bool unregisterDataSource(const UniqueId& dataSourceId);
 
 CORE_API void init(unsigned int cacheSize);
 CORE_API void uninit();
+/**
+ * Enables or disables the cache of the indicator series, disabled by default.
+ *
+ * With the cache disabled, each call to an indicator calculates a new series.
+ * The batch versions (SMAs, EMAs etc) then calculate their periods at once
+ * but don't share them with the single period calls, and the indicators of
+ * data that extends shorter data are calculated from the start, as both find
+ * the series to share or extend in this cache.
+ *
+ * The cached series are shared by all the systems that use them, and must not
+ * be modified
+ *
+ * @param enable true to enable the cache
+ */
+CORE_API void enableSeriesCache(bool enable);
 CORE_API void setDataCacheSize(unsigned int cacheSize);
+
+/**
+ * Cache usage counters for one type of cached object (an indicator, bars etc)
+ */
+class CacheTypeStats {
+ public:
+  // lookups that found the object in the cache, or already being made by
+  // another thread
+  unsigned __int64 hits = 0;
+  // lookups that had to make the object
+  unsigned __int64 misses = 0;
+  // objects found in the cache, but that had to be reloaded because they were
+  // no longer consistent with their source
+  unsigned __int64 inconsistent = 0;
+  unsigned __int64 evictions = 0;
+  // estimated memory currently used by objects of this type
+  unsigned __int64 bytes = 0;
+  // cumulative time spent making objects of this type, in microseconds
+  unsigned __int64 makeTime = 0;
+
+  CacheTypeStats& operator+=(const CacheTypeStats& stats) {
+    hits += stats.hits;
+    misses += stats.misses;
+    inconsistent += stats.inconsistent;
+    evictions += stats.evictions;
+    bytes += stats.bytes;
+    makeTime += stats.makeTime;
+    return *this;
+  }
+};
+
+// cache stats by type name
+using CacheStats = std::map<std::string, CacheTypeStats>;
+
+/**
+ * Retrieves the current usage counters of the internal series and data caches
+ *
+ * @param seriesCacheStats
+ *               receives the series (indicators) cache counters
+ * @param dataCacheStats
+ *               receives the data cache counters
+ */
+CORE_API void getCacheStats(CacheStats& seriesCacheStats, CacheStats& dataCacheStats);
 }  // namespace tradery
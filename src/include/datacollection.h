@@ -87,9 +87,13 @@ namespace tradery {
 /**
  * \brief A series of XTime values, implemented as a vector
  *
+ * DateTime is a plain 64 bit tick count, so the values are stored contiguously
+ * and can be scanned or searched without chasing pointers
+ *
  * @see XTime
  */
 using TimeSeriesImpl = std::vector<DateTime>;
+static_assert(sizeof(DateTime) == sizeof(__int64), "DateTime must be stored inline");
 using TimeSeriesPtr = std::shared_ptr<TimeSeriesImpl>;
 
 class TimeSeries {
@@ -108,6 +112,23 @@ class TimeSeries {
 
   void push_back(const DateTime& dt) { _ts->push_back(dt); }
 
+  void reserve(size_t count) { _ts->reserve(count); }
+
+  // no reserve here, as reserving each chunk would defeat the geometric growth
+  // of the vector - the total size is reserved once, by reserve
+  void append(const __int64* ticks, size_t count) {
+    for (size_t n = 0; n < count; ++n) {
+      _ts->push_back(DateTime::fromTicks(ticks[n]));
+    }
+  }
+
+  void append(const DateTime* times, size_t count) { _ts->insert(_ts->end(), times, times + count); }
+
+  /**
+   * The unsynchronized values, as a contiguous array of size() elements
+   */
+  const DateTime* data() const { return _ts->data(); }
+
   const DateTime& at(size_t index) const {
     assert(_ts);
     if (index < _ts->size()) {
@@ -134,12 +155,65 @@ class TimeSeries {
 };
 
 /**
- * \brief A series of BarExtraInfo objects, implemented as a vector of constant
- * pointers (CosntPtrVector) BarExtraInfo objects
+ * \brief A series of BarExtraInfo objects, one for each bar
  *
- * @see ConstPtrVector
+ * Most bars don't have extra info, so only the objects of the bars that have
+ * one are stored, by bar index. The other bars have a null BarExtraInfoPtr
  */
-using ExtraInfoSeries = ConstPtrVector<BarExtraInfo>;
+class ExtraInfoSeries {
+ private:
+  using InfoMap = std::map<size_t, BarExtraInfoPtr>;
+
+  size_t _size;
+  InfoMap _infos;
+
+ public:
+  ExtraInfoSeries() : _size(0) {}
+
+  size_t size() const { return _size; }
+
+  /**
+   * The number of bars that have extra info
+   */
+  size_t count() const { return _infos.size(); }
+
+  void push_back(BarExtraInfoPtr info) {
+    if (info) {
+      _infos[_size] = info;
+    }
+    ++_size;
+  }
+
+  /**
+   * Adds bars with no extra info, or removes the last bars
+   */
+  void resize(size_t size) {
+    _infos.erase(_infos.lower_bound(size), _infos.end());
+    _size = size;
+  }
+
+  /**
+   * Adds the extra info of count bars of series, starting at first
+   */
+  void append(const ExtraInfoSeries& series, size_t first, size_t count) {
+    assert(first + count <= series.size());
+    for (InfoMap::const_iterator i = series._infos.lower_bound(first); i != series._infos.end() && i->first < first + count; ++i) {
+      _infos.insert(_infos.end(), InfoMap::value_type(_size + i->first - first, i->second));
+    }
+    _size += count;
+  }
+
+  /**
+   * The extra info of a bar
+   *
+   * @param index  the bar index
+   * @return the extra info, or null if the bar doesn't have any
+   */
+  BarExtraInfoPtr operator[](size_t index) const {
+    InfoMap::const_iterator i = _infos.find(index);
+    return i != _infos.end() ? i->second : BarExtraInfoPtr{};
+  }
+};
 
 /**
  * \brief A bar - specialized and concrete type of data unit
@@ -162,6 +236,7 @@ using ExtraInfoSeries = ConstPtrVector<BarExtraInfo>;
  * @see Bars
  */
 class Bar : public DataUnit {
+ public:
   enum BarStatus {
     valid,
     empty,
@@ -184,8 +259,13 @@ class Bar : public DataUnit {
 
   BarStatus _status;
 
- private:
-  BarStatus status(const DateTime& time, double open, double high, double low, double close, unsigned long volume) {
+ public:
+  /**
+   * Checks the bar values, without making a Bar
+   *
+   * @return valid, or the reason why the values don't make a valid bar
+   */
+  static BarStatus status(double open, double high, double low, double close, unsigned long volume) {
     if (open == 0 && high == 0 && low == 0 && close == 0 && volume == 0) {
       return empty;
     }
@@ -250,7 +330,7 @@ class Bar : public DataUnit {
         DataUnit(time),
         _openInterest(openInterest),
         _barExtraInfo(barExtraInfo),
-        _status(status(time, open, high, low, close, volume)) {}
+        _status(status(open, high, low, close, volume)) {}
 
   Bar(DateTime& time)
       : _open(0),
@@ -325,9 +405,11 @@ class Bar : public DataUnit {
   */
   bool isValid() const { return _status == valid; }
   BarStatus getStatus() const { return _status; }
-  std::string getStatusAsString() const {
-    std::string str = date().toString() + ": ";
-    switch (_status) {
+  std::string getStatusAsString() const { return statusAsString(time(), _status); }
+
+  static std::string statusAsString(const DateTime& time, BarStatus status) {
+    std::string str = time.date().toString() + ": ";
+    switch (status) {
       case valid:
         return str + "valid";
       case empty:
@@ -358,6 +440,35 @@ class Bar : public DataUnit {
  */
 using BarPtr = std::shared_ptr<const Bar>;
 
+/**
+ * Implemented by bars collections that can take the values of a bar directly,
+ * so data sources that parse large amounts of data don't have to make a Bar
+ * object for each of them.
+ *
+ * The values are checked the same way as those of a Bar added with
+ * Addable<Bar>::add
+ */
+class BarsAppender {
+ public:
+  virtual ~BarsAppender() {}
+
+  /**
+   * Reserves space for count bars, if the data source can estimate it
+   */
+  virtual void reserve(size_t count) = 0;
+  virtual void add(const DateTime& time, double open, double high, double low, double close, unsigned long volume, unsigned long openInterest = 0) = 0;
+  /**
+   * Adds count bars at once, from columns of values such as those of a binary
+   * data file. The times are DateTime ticks.
+   *
+   * If a bar is not valid and the error handling mode is fatal, the bars
+   * before it are added before the exception is thrown, the same as when
+   * they are added one at a time
+   */
+  virtual void add(size_t count, const __int64* time, const double* open, const double* high, const double* low, const double* close, const double* volume,
+                   const double* openInterest) = 0;
+};
+
 /**
  * Different tick types.
  *
@@ -538,13 +649,13 @@ class DataCollection {
     _locationInfo = locationInfo;
   }
 
+  DataLocationInfoPtr dataLocationInfo() const { return _locationInfo; }
+
   const std::string locationInfoToXML() const {
     return _locationInfo ? _locationInfo->toXML() : std::string();
   }
 };
 
-using DataManagedPtr = std::shared_ptr<const DataCollection>;
-
 /**
  * SymbolInfo class - contains information associated with a symbol:
  *
@@ -618,28 +729,6 @@ class DataInfo {
 
 using DataInfoConstPtr = std::shared_ptr<const DataInfo>;
 
-// used to request a set of data elements from a data source
-// it handles cashing etc
-class DataRequester {
- public:
-  virtual ~DataRequester() {}
-
-  /**
-   * Returns a pointer to a collection of data elements, given a SymbolInfo
-   * descriptor object and a range.
-   *
-   * The returned pointer is still owned by and its lifecycle controlled by the
-   * DataManagerI object and should not be deleted by the application.
-   *
-   * @param symbol pointer to a SymbolInfo object - describes the data to be
-   * loaded
-   * @param range  The range, either time or bar index to be used
-   * @return pointer to a barsI object - should not be deleted by the
-   * application
-   */
-  virtual DataManagedPtr getData(const DataInfo* dataInfo, DateTimeRangePtr range) = 0;
-};
-
 /**
  * A template abstract class derived from DataCollection, which defines data
  * specific method such as add and forEach
@@ -900,6 +989,10 @@ constexpr auto ERROR_HANDLING_MODE_FATAL = "fatal";
 constexpr auto ERROR_HANDLING_MODE_WARNING = "warning";
 constexpr auto ERROR_HANDLING_MODE_IGNORE = "ignore";
 
+// how the file data sources parse their data files
+constexpr auto PARSER_MODE_MAPPED = "mapped";
+constexpr auto PARSER_MODE_STREAM = "stream";
+
 inline std::string errorHandlingModeAsString(
     ErrorHandlingMode errorHandlingMode) {
   switch (errorHandlingMode) {
@@ -915,6 +1008,40 @@ inline std::string errorHandlingModeAsString(
   }
 }
 
+/**
+ * \brief A reference to a bar in a collection of bars
+ *
+ * Has the same accessors as Bar, but doesn't copy anything: each value is read
+ * from the collection when requested. It is meant for loops over many bars that
+ * only need a few of their values, and is valid only as long as the
+ * collection it refers to
+ *
+ * @see BarsAbstr::getBarRef
+ * @see Bar
+ */
+class BarRef {
+ private:
+  const BarsAbstr* _bars;
+  size_t _index;
+
+ public:
+  BarRef(const BarsAbstr& bars, size_t index) : _bars(&bars), _index(index) {}
+
+  size_t index() const { return _index; }
+
+  DateTime time() const;
+  double getOpen() const;
+  double getHigh() const;
+  double getLow() const;
+  double getClose() const;
+  unsigned long getVolume() const;
+  unsigned long getOpenInterest() const;
+  /**
+   * The extra info of the bar, owned by the collection, or 0 if none
+   */
+  const BarExtraInfo* getBarExtraInfo() const;
+};
+
 /**
  * Abstract class - base class to a collection of bars associated with a symbol
  *
@@ -1034,6 +1161,16 @@ class BarsAbstr : public BarIndicators {
   virtual const BarExtraInfoPtr getBarExtraInfo(size_t barIndex) const = 0;
 
   virtual const Bar getBar(size_t index) const = 0;
+  /**
+   * Returns a lightweight reference to the bar at index, which reads its
+   * values from the collection as they are requested, instead of copying them
+   * into a Bar object
+   *
+   * @param index  the bar index
+   * @return the reference, valid as long as the collection
+   * @see BarRef
+   */
+  BarRef getBarRef(size_t index) const;
   /**
    * The possible types of bars collections: so far stocks and futures
    */
@@ -1129,6 +1266,17 @@ class BarsAbstr : public BarIndicators {
   //@}
 };
 
+inline BarRef BarsAbstr::getBarRef(size_t index) const { return BarRef(*this, index); }
+
+inline DateTime BarRef::time() const { return _bars->time(_index); }
+inline double BarRef::getOpen() const { return _bars->open(_index); }
+inline double BarRef::getHigh() const { return _bars->high(_index); }
+inline double BarRef::getLow() const { return _bars->low(_index); }
+inline double BarRef::getClose() const { return _bars->close(_index); }
+inline unsigned long BarRef::getVolume() const { return _bars->volume(_index); }
+inline unsigned long BarRef::getOpenInterest() const { return _bars->openInterest(_index); }
+inline const BarExtraInfo* BarRef::getBarExtraInfo() const { return _bars->getBarExtraInfo(_index).get(); }
+
 class Bars : private BarsAbstr {
  private:
   const BarsAbstr* _bars;
@@ -1197,6 +1345,11 @@ class Bars : private BarsAbstr {
 
   Bars(const BarsAbstr* bars) : _bars(bars) {}
 
+  /**
+   * The bars collection, or 0 if there is none
+   */
+  const BarsAbstr* getBarsAbstr() const { return _bars; }
+
   ErrorHandlingMode getErrorHandlingMode() const override {
     validate();
     return _bars->getErrorHandlingMode();
@@ -1223,6 +1376,10 @@ class Bars : private BarsAbstr {
     validate();
     return _bars->getBar(index);
   }
+  BarRef getBarRef(Index index) const {
+    validate();
+    return _bars->getBarRef(index);
+  }
   void forEach(tradery::BarHandler& barHandler, size_t startBar = 0) const override {
     validate();
     _bars->forEach(barHandler, startBar);
@@ -1642,8 +1799,32 @@ class Bars : private BarsAbstr {
 };
 
 using BarsPtr = std::shared_ptr<BarsBase>;
+using DataManagedPtr = BarsPtr;
 using TicksPtr = std::shared_ptr<Ticks>;
 
+// used to request a set of data elements from a data source
+// it handles cashing etc
+class DataRequester {
+ public:
+  virtual ~DataRequester() {}
+
+  /**
+   * Returns a pointer to a collection of data elements, given a SymbolInfo
+   * descriptor object and a range.
+   *
+   * The data is loaded once and kept in the cache, and each requester gets its
+   * own copy, which it can synchronize or modify. It is loaded again if
+   * the data source reports that the cached copy is no longer consistent
+   * with its source (for example a data file has changed)
+   *
+   * @param symbol pointer to a SymbolInfo object - describes the data to be
+   * loaded
+   * @param range  The range, either time or bar index to be used
+   * @return a shared pointer to the data
+   */
+  virtual DataManagedPtr getData(const DataInfo* dataInfo, DateTimeRangePtr range) = 0;
+};
+
 /**
  * Data source event base class
  *
@@ -150,6 +150,20 @@ class DATASOURCE_API DataSource : public PluginConfiguration {
    */
   virtual DataXPtr getData(const DataInfo* dataInfo, DateTimeRangePtr = 0) const = 0;
   virtual bool isConsistent(const std::string& stamp, const Symbol& si, DateTimeRangePtr range = 0) const = 0;
+
+  /**
+   * Estimates the fraction of the data of a symbol that is in a range,
+   * without loading the data
+   *
+   * The data manager uses it to decide whether to load the bars in a range
+   * on their own, or to make them from the full history of the symbol
+   *
+   * @param dataInfo the symbol
+   * @param range    the range
+   * @return a value between 0 and 1, or a negative value if the data source
+   * can't tell without loading the data (the default)
+   */
+  virtual double rangeFraction(const DataInfo* dataInfo, const DateTimeRange& range) const { return -1; }
 };
 
 /**
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <limits>
 #include <memory>
 #include "strings.h"
 
@@ -120,6 +121,8 @@ class DateAbstr {
   virtual std::string to_simple_string() const = 0;
   virtual std::string to_iso_string() const = 0;
   virtual std::string to_iso_extended_string() const = 0;
+  // days since 1970-01-01, or one of the Date special values
+  virtual int days() const = 0;
 
   // make special values
   MISC_API static DateAbstrPtr makePosInfinity();
@@ -127,6 +130,7 @@ class DateAbstr {
   MISC_API static DateAbstrPtr makeMaxDate();
   MISC_API static DateAbstrPtr makeMinDate();
   MISC_API static DateAbstrPtr makeNotADate();
+  MISC_API static DateAbstrPtr makeFromDays(int days);
 };
 
 class DateTimeAbstr;
@@ -138,6 +142,9 @@ class DateTimeAbstr {
   virtual std::string to_simple_string() const = 0;
   virtual std::string to_iso_string() const = 0;
   virtual __int64 to_epoch_time() const = 0;
+  // microseconds since 1970-01-01 00:00:00, or one of the DateTime special
+  // values
+  virtual __int64 ticks() const = 0;
   virtual bool operator<(const DateTimeAbstr& xtime) const = 0;
   virtual bool operator>(const DateTimeAbstr& xtime) const = 0;
   virtual bool operator>=(const DateTimeAbstr& xtime) const = 0;
@@ -154,6 +161,7 @@ class DateTimeAbstr {
   MISC_API static DateTimeAbstrPtr make(const DateAbstr& date);
   MISC_API static DateTimeAbstrPtr make(const DateTimeAbstr& time);
   MISC_API static DateTimeAbstrPtr make(__int64 time);
+  MISC_API static DateTimeAbstrPtr makeFromTicks(__int64 ticks);
   MISC_API static DateTimeAbstrPtr makeFromIsoString(const std::string& iso_string);
   MISC_API static DateTimeAbstrPtr makeFromDelimitedString(const std::string& delimitedString);
   MISC_API static DateTimeAbstrPtr makeFromNonDelimitedString(const std::string& delimitedString);
@@ -812,15 +820,78 @@ inline std::string dateFormatToString(DateFormat dateFormat, const std::string&
 class Date {
   friend class DateTime;
 
+ public:
+  /**
+   * The special values. They are ordered as in boost::gregorian::date:
+   * negative infinity is before all dates and positive infinity after all
+   * dates. As with gregorian::date, comparisons with not a date using < and >
+   * are always false, so not a date doesn't sort among the other dates
+   */
+  static constexpr int NEG_INFINITY_DAYS = (std::numeric_limits<int>::min)();
+  static constexpr int NOT_A_DATE_DAYS = (std::numeric_limits<int>::max)() - 1;
+  static constexpr int POS_INFINITY_DAYS = (std::numeric_limits<int>::max)();
+
  private:
-  DateAbstrPtr _date;
+  // days since 1970-01-01, or one of the special values
+  int _days;
 
  private:
+  static bool less(int a, int b) {
+    return a != NOT_A_DATE_DAYS && b != NOT_A_DATE_DAYS && a < b;
+  }
+
   void parse(const std::string& xdate, DateFormat format, const std::string& sep);
 
+  static bool isLeapYear(unsigned int year) {
+    return year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+  }
+
+  static unsigned int lastDayOfMonth(unsigned int year, unsigned int month) {
+    constexpr unsigned int days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return month == 2 && isLeapYear(year) ? 29 : days[month - 1];
+  }
+
+  /**
+   * Days since 1970-01-01 of a date in the proleptic gregorian calendar
+   */
+  static constexpr int daysFromCivil(int year, unsigned int month, unsigned int day) {
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned int yearOfEra = (unsigned int)(year - era * 400);
+    const unsigned int dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const unsigned int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + (int)dayOfEra - 719468;
+  }
+
+  /**
+   * The year, month and day of a number of days since 1970-01-01
+   */
+  static void civilFromDays(int days, unsigned short& year, unsigned short& month, unsigned short& day) {
+    days += 719468;
+    const int era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned int dayOfEra = (unsigned int)(days - era * 146097);
+    const unsigned int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const unsigned int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const unsigned int mp = (5 * dayOfYear + 2) / 153;
+    day = (unsigned short)(dayOfYear - (153 * mp + 2) / 5 + 1);
+    month = (unsigned short)(mp < 10 ? mp + 3 : mp - 9);
+    year = (unsigned short)((int)yearOfEra + era * 400 + (month <= 2));
+  }
+
+  static int fromYearMonthDay(unsigned int year, unsigned int month, unsigned int day) {
+    // the range supported by boost::gregorian::date
+    if (year < 1400 || year > 9999 || month < 1 || month > 12 || day < 1 || day > lastDayOfMonth(year, month)) {
+      // throws the same exception as before
+      DateAbstr::make(year, month, day);
+    }
+    return daysFromCivil(year, month, day);
+  }
+
+  DateAbstrPtr abstr() const { return DateAbstr::makeFromDays(_days); }
+
  protected:
   Date(DateAbstrPtr date)
-      : _date(date) {
+      : _days(date->days()) {
   }
 
  public:
@@ -832,7 +903,7 @@ class Date {
    * @param day    The day
    */
   Date(unsigned int year, unsigned int month, unsigned int day)
-      : _date(DateAbstr::make(year, month, day)) {
+      : _days(fromYearMonthDay(year, month, day)) {
   }
 
   /**
@@ -842,9 +913,7 @@ class Date {
    *
    * @param date   The source date
    */
-  Date(const Date& date)
-      : _date(DateAbstrPtr(DateAbstr::make(*(date._date)))) {
-  }
+  Date(const Date& date) = default;
 
   /**
    * Default constructor
@@ -853,7 +922,7 @@ class Date {
    *
    */
   Date()
-      : _date(DateAbstrPtr(DateAbstr::make())) {
+      : _days(NOT_A_DATE_DAYS) {
   }
 
     // if year is xx < 100, the year will be considered to be 20xx, for ex 06
@@ -867,62 +936,94 @@ class Date {
       const std::string& separator = DEF_DATE_SEP);
 
   MISC_API Date(const std::string& date, const std::string& format);
+
+  /**
+   * Makes a date from the number of days since 1970-01-01, or one of the
+   * special values
+   *
+   * @param days   the number of days
+   * @return the date
+   */
+  static Date fromDays(int days) {
+    Date date;
+    date._days = days;
+    return date;
+  }
+
+  /**
+   * The number of days since 1970-01-01, or one of the special values
+   *
+   * @return the number of days
+   */
+  int days() const { return _days; }
   /**
    * Get the year part of the date
    *
    * @return the year
    */
-  unsigned short year() const { return _date->year(); }
+  unsigned short year() const {
+    unsigned short year, month, day;
+    civilFromDays(_days, year, month, day);
+    return year;
+  }
   /**
    * Get the month part of the date
    *
    * @return the month
    */
-  unsigned short month() const { return _date->month(); }
+  unsigned short month() const {
+    unsigned short year, month, day;
+    civilFromDays(_days, year, month, day);
+    return month;
+  }
   /**
    * Get the day part of the date
    *
    * @return the day
    */
-  unsigned short day() const { return _date->day(); }
+  unsigned short day() const {
+    unsigned short year, month, day;
+    civilFromDays(_days, year, month, day);
+    return day;
+  }
   /**
    * Returns true if date is either positive or negative infinity
    *
    * @return true if positive or negative infinity
    */
-  bool is_infinity() const { return _date->is_infinity(); }
-  bool isInfinity() const { return _date->is_infinity(); }
+  bool is_infinity() const { return is_neg_infinity() || is_pos_infinity(); }
+  bool isInfinity() const { return is_infinity(); }
   /**
    * Returns true if date is negative infinity
    *
    * @return true if negative infinity
    */
-  bool is_neg_infinity() const { return _date->is_neg_infinity(); }
-  bool isNegInfinity() const { return _date->is_neg_infinity(); }
+  bool is_neg_infinity() const { return _days == NEG_INFINITY_DAYS; }
+  bool isNegInfinity() const { return is_neg_infinity(); }
   /**
    * Returns true if date is positive infinity
    *
    * @return true if date is positive infinity
    */
-  bool is_pos_infinity() const { return _date->is_pos_infinity(); }
-  bool isPosInfinity() const { return _date->is_pos_infinity(); }
+  bool is_pos_infinity() const { return _days == POS_INFINITY_DAYS; }
+  bool isPosInfinity() const { return is_pos_infinity(); }
   /**
    * Returns true if date is not a valid date
    *
    * @return true if date is not a valid date
    */
-  bool is_not_a_date() const { return _date->is_not_a_date(); }
-  bool isNotADate() const { return _date->is_not_a_date(); }
+  bool is_not_a_date() const { return _days == NOT_A_DATE_DAYS; }
+  bool isNotADate() const { return is_not_a_date(); }
   /**
    * returns the ISO 8601 week number for date
    *
    * @return the ISO 8601 week number for date
    */
-  int week_number() const { return _date->week_number(); }
-  int weekNumber() const { return _date->week_number(); }
+  int week_number() const { return abstr()->week_number(); }
+  int weekNumber() const { return week_number(); }
 
-  bool is_special() const { return _date->is_special(); }
-  bool isSpecial() const { return _date->is_special(); }
+  bool is_special() const { return is_infinity() || is_not_a_date(); }
+  bool isSpecial() const { return is_special(); }
   /**
    * Operator ==
    *
@@ -933,7 +1034,7 @@ class Date {
    * @return true if ==, false otherwise
    */
   bool operator==(const Date& date) const {
-    return *_date == *date._date;
+    return _days == date._days;
   }
   /**
    * Operator !=
@@ -945,7 +1046,7 @@ class Date {
    * @return true if !=, false otherwise
    */
   bool operator!=(const Date& date) const {
-    return *_date != *date._date;
+    return _days != date._days;
   }
   /**
    * Operator >
@@ -957,7 +1058,7 @@ class Date {
    * @return true if >, false otherwise
    */
   bool operator>(const Date& date) const {
-    return *_date > *date._date;
+    return less(date._days, _days);
   }
   /**
    * Operator <
@@ -969,7 +1070,7 @@ class Date {
    * @return true if <, false otherwise
    */
   bool operator<(const Date& date) const {
-    return *_date < *date._date;
+    return less(_days, date._days);
   }
   /**
    * Operator >=
@@ -981,7 +1082,7 @@ class Date {
    * @return true if >=, false otherwise
    */
   bool operator>=(const Date& date) const {
-    return *_date >= *date._date;
+    return !less(_days, date._days);
   }
   /**
    * Operator <=
@@ -993,7 +1094,7 @@ class Date {
    * @return true if <=, false otherwise
    */
   bool operator<=(const Date& date) const {
-    return *_date <= *date._date;
+    return !less(date._days, _days);
   }
 
   /**
@@ -1004,7 +1105,7 @@ class Date {
    * @return The new date
    */
   Date operator+(const DateDuration& duration) const {
-    return *_date + *duration._duration;
+    return *abstr() + *duration._duration;
   }
   /**
    * Subtracts a DateDuration from the current Date
@@ -1014,7 +1115,7 @@ class Date {
    * @return The new date
    */
   Date operator-(const DateDuration& duration) const {
-    return *_date - *duration._duration;
+    return *abstr() - *duration._duration;
   }
   /**
    * Subtracts a Date from the current Date. The result is a DateDuration
@@ -1024,7 +1125,7 @@ class Date {
    * @return The difference between the two dates
    */
   DateDuration operator-(const Date& date) const {
-    return *_date - *date._date;
+    return is_special() || date.is_special() ? DateDuration(*abstr() - *date.abstr()) : DateDuration(_days - date._days);
   }
 
   /**
@@ -1035,7 +1136,7 @@ class Date {
    * @return The new date
    */
   Date operator+=(const DateDuration& duration) {
-    return *_date += *duration._duration;
+    return *this = *this + duration;
   }
   /**
    * Subtracts a DateDuration from the current Date
@@ -1045,33 +1146,34 @@ class Date {
    * @return The new date
    */
   Date operator-=(const DateDuration& duration) {
-    return *_date -= *duration._duration;
+    return *this = *this - duration;
   }
   /**
    * assignment operator
    */
-  const Date& operator=(const Date& date) {
-    if (this != &date) {
-      _date = DateAbstr::make(*(date._date));
-    }
-    return *this;
-  }
+  Date& operator=(const Date& date) = default;
+
+  // special dates stay the same, as when adding days to them
   const Date& operator++() {
-    *this += Days(1);
+    if (!is_special()) {
+      ++_days;
+    }
     return *this;
   }
   const Date& operator--() {
-    *this -= Days(1);
+    if (!is_special()) {
+      --_days;
+    }
     return *this;
   }
   const Date operator++(int) {
     Date temp = *this;
-    *this += Days(1);
+    ++*this;
     return temp;
   }
   const Date operator--(int) {
     Date temp = *this;
-    *this -= Days(1);
+    --*this;
     return temp;
   }
 
@@ -1081,21 +1183,21 @@ class Date {
    *
    * @return The string representation of the date
    */
-  std::string to_simple_string() const { return _date->to_simple_string(); }
-  std::string toString() const { return _date->to_simple_string(); }
+  std::string to_simple_string() const { return abstr()->to_simple_string(); }
+  std::string toString() const { return abstr()->to_simple_string(); }
   /**
    * To YYYYMMDD where all components are integers. ex: 20020131
    *
    * @return The string representation of the date
    */
-  std::string to_iso_string() const { return _date->to_iso_string(); }
+  std::string to_iso_string() const { return abstr()->to_iso_string(); }
   /**
    * To YYYY-MM-DD where all components are integers. Ex: 2002-01-31
    *
    * @return The string representation of the date
    */
   std::string to_iso_extended_string() const {
-    return _date->to_iso_extended_string();
+    return abstr()->to_iso_extended_string();
   }
 
   MISC_API std::string toString(DateFormat format, const std::string& separator = "/") const;
@@ -1103,12 +1205,12 @@ class Date {
 
 class PosInfinityDate : public Date {
  public:
-  PosInfinityDate() : Date(DateAbstr::makePosInfinity()) {}
+  PosInfinityDate() : Date(fromDays(POS_INFINITY_DAYS)) {}
 };
 
 class NegInfinityDate : public Date {
  public:
-  NegInfinityDate() : Date(DateAbstr::makeNegInfinity()) {}
+  NegInfinityDate() : Date(fromDays(NEG_INFINITY_DAYS)) {}
 };
 
 class MinDate : public Date {
@@ -1132,11 +1234,58 @@ class NotADate : public Date {};
  * A time can be interpreted as a date + time of day
  */
 class DateTime {
+ public:
+  /**
+   * The special values. They are ordered as in boost::posix_time::ptime:
+   * negative infinity is before all times, not a date time is after all times
+   * and before positive infinity. As with ptime, comparisons with not a date
+   * time using < and > are always false
+   */
+  static constexpr __int64 NEG_INFINITY_TICKS = (std::numeric_limits<__int64>::min)();
+  static constexpr __int64 NOT_A_DATE_TIME_TICKS = (std::numeric_limits<__int64>::max)() - 1;
+  static constexpr __int64 POS_INFINITY_TICKS = (std::numeric_limits<__int64>::max)();
+
+  static constexpr __int64 TICKS_PER_SECOND = 1000000;
+  static constexpr __int64 TICKS_PER_DAY = TICKS_PER_SECOND * 24 * 60 * 60;
+
  private:
-  DateTimeAbstrPtr _date_time;
+  // microseconds since 1970-01-01 00:00:00, or one of the special values
+  __int64 _ticks;
+
+ private:
+  DateTimeAbstrPtr abstr() const { return DateTimeAbstr::makeFromTicks(_ticks); }
+
+  static bool less(__int64 a, __int64 b) {
+    return a != NOT_A_DATE_TIME_TICKS && b != NOT_A_DATE_TIME_TICKS && a < b;
+  }
+
+  static __int64 fromDate(const Date& date) {
+    switch (date._days) {
+      case Date::NEG_INFINITY_DAYS:
+        return NEG_INFINITY_TICKS;
+      case Date::NOT_A_DATE_DAYS:
+        return NOT_A_DATE_TIME_TICKS;
+      case Date::POS_INFINITY_DAYS:
+        return POS_INFINITY_TICKS;
+      default:
+        return date._days * TICKS_PER_DAY;
+    }
+  }
+
+  static __int64 fromDate(const Date& date, const TimeDuration& duration) {
+    return date.is_special()
+               ? fromDate(date)
+               : date._days * TICKS_PER_DAY + (__int64)duration._duration->total_seconds() * TICKS_PER_SECOND +
+                     duration._duration->fractional_seconds();
+  }
+
+  // floor division, so times before the epoch have the right day
+  __int64 days() const {
+    return _ticks >= 0 ? _ticks / TICKS_PER_DAY : (_ticks - TICKS_PER_DAY + 1) / TICKS_PER_DAY;
+  }
 
  protected:
-  DateTime(DateTimeAbstrPtr date_time) : _date_time(date_time) {}
+  DateTime(DateTimeAbstrPtr date_time) : _ticks(date_time->ticks()) {}
 
  public:
   /**
@@ -1144,7 +1293,7 @@ class DateTime {
    * not_a_date_time
    */
   DateTime()
-      : _date_time(DateTimeAbstrPtr(DateTimeAbstr::make())) {
+      : _ticks(NOT_A_DATE_TIME_TICKS) {
   }
   /**
    * Constructor that takes a date and a duration as parameters
@@ -1153,8 +1302,7 @@ class DateTime {
    * @param duration The duration
    */
   DateTime(const Date& date, const TimeDuration& duration)
-      : _date_time(DateTimeAbstrPtr(
-            DateTimeAbstr::make(*date._date, *duration._duration))) {
+      : _ticks(fromDate(date, duration)) {
   }
 
   /**
@@ -1165,7 +1313,7 @@ class DateTime {
    * @param date
    */
   DateTime(const Date& date)
-      : _date_time(DateTimeAbstrPtr(DateTimeAbstr::make(*date._date))) {
+      : _ticks(fromDate(date)) {
   }
 
   /**
@@ -1175,14 +1323,38 @@ class DateTime {
    *
    * @param time   The source DateTime
    */
-  DateTime(const DateTime& time)
-      : _date_time(DateTimeAbstrPtr(DateTimeAbstr::make(*(time._date_time)))) {
-  }
+  DateTime(const DateTime& time) = default;
 
+  /**
+   * Constructs a time from the number of seconds since 1970-01-01 00:00:00
+   *
+   * @param time   The number of seconds
+   */
   DateTime(__int64 time)
-      : _date_time(DateTimeAbstrPtr(DateTimeAbstr::make(time))) {
+      : _ticks(time * TICKS_PER_SECOND) {
   }
 
+  /**
+   * Makes a time from the number of microseconds since 1970-01-01 00:00:00, or
+   * one of the special values
+   *
+   * @param ticks  the number of microseconds
+   * @return the time
+   */
+  static DateTime fromTicks(__int64 ticks) {
+    DateTime time;
+    time._ticks = ticks;
+    return time;
+  }
+
+  /**
+   * The number of microseconds since 1970-01-01 00:00:00, or one of the
+   * special values
+   *
+   * @return the number of microseconds
+   */
+  __int64 ticks() const { return _ticks; }
+
   /**
    * Operator <
    *
@@ -1193,7 +1365,7 @@ class DateTime {
    * @return true if <, false otherwise
    */
   bool operator<(const DateTime& other) const {
-    return *_date_time < *other._date_time;
+    return less(_ticks, other._ticks);
   }
   /**
    * Operator >
@@ -1205,7 +1377,7 @@ class DateTime {
    * @return true if >, false otherwise
    */
   bool operator>(const DateTime& other) const {
-    return *_date_time > *other._date_time;
+    return less(other._ticks, _ticks);
   }
   /**
    * Operator >=
@@ -1217,7 +1389,7 @@ class DateTime {
    * @return true if >=, false otherwise
    */
   bool operator>=(const DateTime& xtime) const {
-    return *_date_time >= *xtime._date_time;
+    return !less(_ticks, xtime._ticks);
   }
   /**
    * Operator <=
@@ -1229,7 +1401,7 @@ class DateTime {
    * @return true if <, false otherwise
    */
   bool operator<=(const DateTime& xtime) const {
-    return *_date_time <= *xtime._date_time;
+    return !less(xtime._ticks, _ticks);
   }
   /**
    * Operator ==
@@ -1241,7 +1413,7 @@ class DateTime {
    * @return true if ==, false otherwise
    */
   bool operator==(const DateTime& xtime) const {
-    return *_date_time == *xtime._date_time;
+    return _ticks == xtime._ticks;
   }
   /**
    * Operator !=
@@ -1253,7 +1425,7 @@ class DateTime {
    * @return true if !=, false otherwise
    */
   bool operator!=(const DateTime& xtime) const {
-    return *_date_time != *xtime._date_time;
+    return _ticks != xtime._ticks;
   }
 
   /**
@@ -1267,11 +1439,13 @@ class DateTime {
    * @return The string representation
    */
   std::string to_simple_string() const {
-    return _date_time->to_simple_string();
+    return abstr()->to_simple_string();
+  }
+  std::string toString() const { return abstr()->to_simple_string(); }
+  std::string to_iso_string() const { return abstr()->to_iso_string(); }
+  __int64 to_epoch_time() const {
+    return is_special() ? abstr()->to_epoch_time() : _ticks / TICKS_PER_SECOND;
   }
-  std::string toString() const { return _date_time->to_simple_string(); }
-  std::string to_iso_string() const { return _date_time->to_iso_string(); }
-  __int64 to_epoch_time() const { return _date_time->to_epoch_time(); }
 
   /**
    * accesor methods
@@ -1280,27 +1454,36 @@ class DateTime {
   /**
    * Gets the date component of the time
    */
-  const Date date() const { return Date(_date_time->date()); }
+  const Date date() const {
+    switch (_ticks) {
+      case NEG_INFINITY_TICKS:
+        return Date::fromDays(Date::NEG_INFINITY_DAYS);
+      case NOT_A_DATE_TIME_TICKS:
+        return Date::fromDays(Date::NOT_A_DATE_DAYS);
+      case POS_INFINITY_TICKS:
+        return Date::fromDays(Date::POS_INFINITY_DAYS);
+      default:
+        return Date::fromDays((int)days());
+    }
+  }
 
   /**
    * gets the "time of day" component of the time
    */
   const TimeDuration time_of_day() const {
-    return TimeDuration(_date_time->time_of_day());
-  }
-  const TimeDuration timeOfDay() const {
-    return TimeDuration(_date_time->time_of_day());
+    if (is_special()) {
+      return TimeDuration(abstr()->time_of_day());
+    }
+    const __int64 ticks = _ticks - days() * TICKS_PER_DAY;
+    const __int64 seconds = ticks / TICKS_PER_SECOND;
+    return TimeDuration(seconds / 3600, seconds / 60 % 60, seconds % 60, ticks % TICKS_PER_SECOND);
   }
+  const TimeDuration timeOfDay() const { return time_of_day(); }
 
   /**
    * assignment operator
    */
-  const DateTime& operator=(const DateTime& time) {
-    if (this != &time) {
-      _date_time = DateTimeAbstr::make(*(time._date_time));
-    }
-    return *this;
-  }
+  DateTime& operator=(const DateTime& time) = default;
 
   /**
    * Indicatas whether the current DateTime is a not_a_date_time
@@ -1310,38 +1493,38 @@ class DateTime {
    *
    * @return true if it is not a valid DateTime
    */
-  bool is_not_a_date_time() const { return _date_time->is_not_a_date_time(); }
-  bool isNotADateTime() const { return _date_time->is_not_a_date_time(); }
+  bool is_not_a_date_time() const { return _ticks == NOT_A_DATE_TIME_TICKS; }
+  bool isNotADateTime() const { return is_not_a_date_time(); }
   /**
    * Indicates whether the curerent DateTime is one of positive or negative
    * infinity
    *
    * @return true if it is a positive or negative infinity
    */
-  bool is_infinity() const { return _date_time->is_infinity(); }
-  bool isInfinity() const { return _date_time->is_infinity(); }
+  bool is_infinity() const { return is_pos_infinity() || is_neg_infinity(); }
+  bool isInfinity() const { return is_infinity(); }
   /**
    * Indicates whether the current DateTime is a positive infinity
    *
    * @return true if positive infinity
    */
-  bool is_pos_infinity() const { return _date_time->is_pos_infinity(); }
-  bool isPosInfinity() const { return _date_time->is_pos_infinity(); }
+  bool is_pos_infinity() const { return _ticks == POS_INFINITY_TICKS; }
+  bool isPosInfinity() const { return is_pos_infinity(); }
   /**
    * Indicates whether the current DateTime is a negative infinity
    *
    * @return true if negative infinity
    */
-  bool is_neg_infinity() const { return _date_time->is_neg_infinity(); }
-  bool isNegInfinity() const { return _date_time->is_neg_infinity(); }
+  bool is_neg_infinity() const { return _ticks == NEG_INFINITY_TICKS; }
+  bool isNegInfinity() const { return is_neg_infinity(); }
   /**
    * Indicates whether the current DateTime is either an infinity or not a valid
    * value
    *
    * @return true if infinity (positive or negative) or not a valid value
    */
-  bool is_special() const { return _date_time->is_special(); }
-  bool isSpecial() const { return _date_time->is_special(); }
+  bool is_special() const { return is_infinity() || is_not_a_date_time(); }
+  bool isSpecial() const { return is_special(); }
   /**
    * Subtracts a DateTime from the current DateTime and returns the
    * resulting time duration
@@ -1351,7 +1534,8 @@ class DateTime {
    * @return The resulting TimeDuration
    */
   TimeDuration operator-(const DateTime& time) const {
-    return *_date_time - *time._date_time;
+    return is_special() || time.is_special() ? TimeDuration(*abstr() - *time.abstr())
+                                             : TimeDuration(0, 0, 0, _ticks - time._ticks);
   }
   /**
    * Adds a DateDuration to the current DateTime and returns the resulting
@@ -1362,7 +1546,7 @@ class DateTime {
    * @return The resulting DateTime
    */
   DateTime operator+(const DateDuration& dd) const {
-    return *_date_time + *dd._duration;
+    return *abstr() + *dd._duration;
   }
   /**
    * Adds a DateDuration to the current DateTime, assigns the result to the
@@ -1373,7 +1557,7 @@ class DateTime {
    * @return The resulting DateTime
    */
   DateTime operator+=(const DateDuration& dd) {
-    return *_date_time += *dd._duration;
+    return *this = *this + dd;
   }
   /**
    * Subtracts a DateDuration from the current DateTime and returns the
@@ -1384,7 +1568,7 @@ class DateTime {
    * @return The resulting DateTime
    */
   DateTime operator-(const DateDuration& dd) const {
-    return *_date_time - *dd._duration;
+    return *abstr() - *dd._duration;
   }
   /**
    * Subtracts a DateDuration from the current DateTime, assigns the result to
@@ -1395,7 +1579,7 @@ class DateTime {
    * @return The resulting DateTime
    */
   DateTime operator-=(const DateDuration& dd) {
-    return *_date_time -= *dd._duration;
+    return *this = *this - dd;
   }
   /**
    * Adds a TimeDuration to the current DateTime and returns the resulting
@@ -1406,7 +1590,7 @@ class DateTime {
    * @return The resulting DateTime
    */
   DateTime operator+(const TimeDuration& td) const {
-    return *_date_time + *td._duration;
+    return *abstr() + *td._duration;
   }
   /**
    * Adds a TimeDuration to the current DateTime, assigns the result to the
@@ -1417,7 +1601,7 @@ class DateTime {
    * @return The resulting DateTime
    */
   DateTime operator+=(const TimeDuration& td) {
-    return *_date_time += *td._duration;
+    return *this = *this + td;
   }
   /**
    * Subtracts a TimeDuration from the current DateTime and returns the
@@ -1428,7 +1612,7 @@ class DateTime {
    * @return The resulting DateTime
    */
   DateTime operator-(const TimeDuration& td) const {
-    return *_date_time - *td._duration;
+    return *abstr() - *td._duration;
   }
   /**
    * Subtracts a TimeDuration from the current DateTime, assigns the result to
@@ -1439,18 +1623,18 @@ class DateTime {
    * @return The resulting DateTime
    */
   DateTime operator-=(const TimeDuration& td) {
-    return *_date_time -= *td._duration;
+    return *this = *this - td;
   }
 };
 
 class PosInfinityDateTime : public DateTime {
  public:
-  PosInfinityDateTime() : DateTime(DateTimeAbstr::makePosInfinity()) {}
+  PosInfinityDateTime() : DateTime(fromTicks(POS_INFINITY_TICKS)) {}
 };
 
 class NegInfinityDateTime : public DateTime {
  public:
-  NegInfinityDateTime() : DateTime(DateTimeAbstr::makeNegInfinity()) {}
+  NegInfinityDateTime() : DateTime(fromTicks(NEG_INFINITY_TICKS)) {}
 };
 
 class MinDateTime : public DateTime {
@@ -1465,7 +1649,7 @@ class MaxDateTime : public DateTime {
 
 class NotADateTime : public DateTime {
  public:
-  NotADateTime() : DateTime(DateTimeAbstr::makeNotADateTime()) {}
+  NotADateTime() : DateTime(fromTicks(NOT_A_DATE_TIME_TICKS)) {}
 };
 
 class DateTimeFromIsoString : public DateTime {
@@ -20,7 +20,8 @@ constexpr auto DEFAULT_SYMBOL_TIMEOUT = 10;
 constexpr auto DEFAULT_HEARTBEAT_TIMEOUT = 10;
 constexpr auto DEFAULT_REVERSE_HEARTBEAT_PERIOD = 10;
 constexpr auto DEFAULT_INITIAL_CAPITAL = 100000.00;
-constexpr auto DEFAULT_CACHE_SIZE = 200;
+constexpr auto DEFAULT_CACHE_SIZE = 1024; // MB
+constexpr auto DEFAULT_SERIES_CACHE = false;
 constexpr auto DEFAULT_SLIPPAGE_VALUE = 0;
 constexpr auto DEFAULT_COMMISION_VALUE = 0;
 constexpr auto DEFAULT_MAX_LINES_PER_FILE = 200;
@@ -35,7 +36,9 @@ constexpr auto DEFAULT_LINES_PER_PAGE = 25;
 constexpr auto DEFAULT_CPU_COUNT = 2;
 constexpr auto DEFAULT_THREAD_COUNT = 2;
 constexpr auto DEFAULT_THREADING_ALGORITHM = 1; // default is one system will be run on multiple threads if possible
+constexpr auto DEFAULT_SYMBOL_MAJOR = false;
 #define DEFAULT_DATA_ERROR_HANDLING_MODE ErrorHandlingMode::fatal
+constexpr auto DEFAULT_DATA_PARSER_MODE = "mapped";
 constexpr auto DEFAULT_RUN_AS_USER = false;
 constexpr auto DEFAULT_TRADES_FILE = "trades.htm";
 constexpr auto DEFAULT_STATS_FILE = "stats.htm";
@@ -23,4 +23,12 @@
 #endif
 
 MISCWIN_API void setCurrentThreadIdealProcessor(unsigned int processor);
+// pins the current thread to the logical processor of rank index in the
+// order: one per physical core first, grouped by NUMA node, then the SMT
+// siblings. Wraps around if there are more threads than logical processors.
+// This keeps the thread on one processor, it doesn't move the memory the
+// thread uses to its NUMA node
+MISCWIN_API void setCurrentThreadAffinity(unsigned int index);
+// restores the affinity the current thread had before setCurrentThreadAffinity
+MISCWIN_API void resetCurrentThreadAffinity();
 MISCWIN_API unsigned long getCurrentCPUNumber();
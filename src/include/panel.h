@@ -0,0 +1,132 @@
+/*
+   Copyright (C) 2018-2020 Adrian Michel
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+/** @file
+ *  \brief Multi-symbol data aligned to a common calendar, for cross-sectional
+ *  systems (ranking, relative strength, breadth)
+ */
+
+#include "datacollection.h"
+
+/* @cond */
+namespace tradery {
+/* @endcond */
+
+/**
+ * Cross-sectional operations on n values, one per symbol, of which only those
+ * with a non-zero valid flag are used. The results of invalid values are NaN
+ */
+namespace crossSection {
+/**
+ * The ascending rank of each value among the valid values, starting at 0.
+ * Equal values get the average of their ranks
+ */
+CORE_API void rank(const double* values, const unsigned char* valid, size_t n, double* out);
+
+/**
+ * The rank of each value divided by the number of valid values - 1, between 0
+ * (lowest) and 1 (highest). The only valid value has a percentile of 0.5
+ */
+CORE_API void percentile(const double* values, const unsigned char* valid, size_t n, double* out);
+
+/**
+ * The number of standard deviations (population) of each value from the mean
+ * of the valid values. All the values are 0 if the standard deviation is 0
+ */
+CORE_API void zScore(const double* values, const unsigned char* valid, size_t n, double* out);
+
+/**
+ * The indexes of the k highest valid values, highest first. Equal values are
+ * in index order. Returns fewer than k indexes if there are fewer valid values
+ */
+CORE_API std::vector<size_t> topK(const double* values, const unsigned char* valid, size_t n, size_t k);
+}  // namespace crossSection
+
+/**
+ * The close and volume values of a list of symbols aligned to the dates of a
+ * master calendar, in one pass per symbol.
+ *
+ * The values are stored date by date: the values of all the symbols at a date
+ * are contiguous, so the cross-sectional operations run on contiguous arrays.
+ * A symbol is valid at a date only if it has a bar with that exact time stamp,
+ * otherwise its values are NaN.
+ *
+ * Panels are cached by the ids of the master and symbol bars, so systems of a
+ * run that use the same universe share them
+ */
+class CORE_API Panel {
+ public:
+  using PanelPtr = std::shared_ptr<const Panel>;
+
+  enum Field { CLOSE, VOLUME };
+
+  /**
+   * Aligns bars to the dates of master. Bars without data are never valid
+   *
+   * @param master  the bars whose dates are the panel dates
+   * @param symbols the panel symbols
+   * @param bars    the bars of each symbol, in the same order
+   */
+  static PanelPtr create(Bars master, const std::vector<std::string>& symbols, const std::vector<Bars>& bars);
+
+  virtual ~Panel() {}
+
+  /**
+   * The number of dates, which is the number of master bars
+   */
+  virtual size_t dates() const = 0;
+  /**
+   * The number of symbols
+   */
+  virtual size_t symbols() const = 0;
+  virtual const std::string& symbol(size_t symbolIndex) const = 0;
+  /**
+   * The master calendar
+   */
+  virtual TimeSeries timeSeries() const = 0;
+
+  /**
+   * The symbols() values of a field at a date
+   */
+  virtual const double* values(Field field, size_t date) const = 0;
+  /**
+   * The symbols() valid flags at a date
+   */
+  virtual const unsigned char* valid(size_t date) const = 0;
+  /**
+   * The number of valid symbols at a date
+   */
+  virtual size_t validCount(size_t date) const = 0;
+
+  double close(size_t date, size_t symbolIndex) const { return values(CLOSE, date)[symbolIndex]; }
+  double volume(size_t date, size_t symbolIndex) const { return values(VOLUME, date)[symbolIndex]; }
+  bool isValid(size_t date, size_t symbolIndex) const { return valid(date)[symbolIndex] != 0; }
+
+  /**
+   * The cross-sectional operations applied to a field at a date
+   *
+   * @see crossSection
+   */
+  std::vector<double> rank(Field field, size_t date) const;
+  std::vector<double> percentile(Field field, size_t date) const;
+  std::vector<double> zScore(Field field, size_t date) const;
+  std::vector<size_t> topK(Field field, size_t date, size_t k) const;
+};
+
+/* @cond */
+}  // namespace tradery
+/* @endcond */
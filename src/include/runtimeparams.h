@@ -22,6 +22,10 @@ class RuntimeParams {
  private:
   unsigned long _threads;
   ThreadAlgorithm _threadAlgorithm;
+  unsigned int _prefetchDepth;
+  unsigned int _prefetchThreads;
+  bool _symbolMajor;
+  std::string _runProfile;
   DateTime _startTradesDateTime;
   DateTimeRangePtr _range;
   PositionSizingParams _posSizing;
@@ -35,7 +39,7 @@ class RuntimeParams {
 
  public:
    RuntimeParams()
-      : _threads(DEFAULT_THREADS), _range(std::make_shared< DateTimeRange >(LocalTimeSec() - Days(30), LocalTimeSec())) {}
+      : _threads(DEFAULT_THREADS), _prefetchDepth(DEFAULT_PREFETCH_DEPTH), _prefetchThreads(DEFAULT_PREFETCH_THREADS), _symbolMajor(false), _range(std::make_shared< DateTimeRange >(LocalTimeSec() - Days(30), LocalTimeSec())) {}
 
   void setRange(DateTimeRangePtr range) {
     _range = range;
@@ -60,6 +64,14 @@ class RuntimeParams {
 
   void setThreadAlgorithm(ThreadAlgorithm ta) { _threadAlgorithm = ta; }
 
+  void setPrefetch(unsigned int depth, unsigned int threads) {
+    _prefetchDepth = depth;
+    _prefetchThreads = threads;
+  }
+
+  void setSymbolMajor(bool symbolMajor) { _symbolMajor = symbolMajor; }
+  void setRunProfile(const std::string& runProfile) { _runProfile = runProfile; }
+
   bool chartsEnabled() const { return _chartsEnabled; }
   bool equityCurveEnabled() const { return _equityEnabled; }
   bool statsEnabled() const { return _statsEnabled; }
@@ -71,6 +83,10 @@ class RuntimeParams {
 
   unsigned long getThreads() const { return _threads; }
   ThreadAlgorithm getThreadAlgorithm() const { return _threadAlgorithm; }
+  unsigned int getPrefetchDepth() const { return _prefetchDepth; }
+  unsigned int getPrefetchThreads() const { return _prefetchThreads; }
+  bool getSymbolMajor() const { return _symbolMajor; }
+  const std::string& getRunProfile() const { return _runProfile; }
   DateTimeRangePtr getRange() const {
     return _range;
   }
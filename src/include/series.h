@@ -27,6 +27,7 @@
 
 #include "misc.h"
 #include "synchronizer.h"
+#include "serieskernels.h"
 
 /* @cond */
 namespace tradery {
@@ -236,6 +237,12 @@ class SeriesAbstr {
   virtual SeriesAbstrPtr LinearRegIntercept(unsigned int period) const = 0;
   virtual SeriesAbstrPtr StdDev(unsigned int period, double nbDev) const = 0;
   virtual SeriesAbstrPtr Variance(unsigned int period, double nbDev) const = 0;
+  // batch versions, calculating all the periods at once
+  virtual std::vector<SeriesAbstrPtr> SMAs(const std::vector<unsigned int>& periods) const = 0;
+  virtual std::vector<SeriesAbstrPtr> EMAs(const std::vector<unsigned int>& periods) const = 0;
+  virtual std::vector<SeriesAbstrPtr> StdDevs(const std::vector<unsigned int>& periods, double nbDev) const = 0;
+  virtual std::vector<SeriesAbstrPtr> Mins(const std::vector<unsigned int>& periods) const = 0;
+  virtual std::vector<SeriesAbstrPtr> Maxs(const std::vector<unsigned int>& periods) const = 0;
   virtual SeriesAbstrPtr Correlation(SeriesAbstrPtr series, unsigned int period) const = 0;
   virtual SeriesAbstrPtr Beta(SeriesAbstrPtr series, unsigned int period) const = 0;
   virtual SeriesAbstrPtr TSF(unsigned int period) const = 0;
@@ -276,6 +283,129 @@ class SeriesAbstr {
   virtual SeriesAbstrPtr Log10() const = 0;
 };
 
+/**
+ * Creates a lazily evaluated series representing series1 op series2.
+ *
+ * Nothing is calculated until the values are needed, and expressions built on
+ * other expressions are calculated in one pass, without intermediate series.
+ * The result is cached, so equal expressions are only calculated once.
+ *
+ * The Series arithmetic operators use these, there is normally no need to call
+ * them directly
+ *
+ * @exception OperationOnUnequalSizeSeriesException
+ *                   Thrown if the two series are of different sizes
+ * @exception OperationOnSeriesSyncedToDifferentSynchronizers
+ *                   Thrown if the two series are synchronized differently
+ */
+CORE_API SeriesAbstrPtr makeSeriesExpression(kernels::BinaryOp op, SeriesAbstrPtr series1, SeriesAbstrPtr series2);
+/**
+ * Creates a lazily evaluated series representing series op value
+ */
+CORE_API SeriesAbstrPtr makeSeriesExpression(kernels::BinaryOp op, SeriesAbstrPtr series, double value);
+/**
+ * Creates a lazily evaluated series representing value op series
+ */
+CORE_API SeriesAbstrPtr makeSeriesExpression(kernels::BinaryOp op, double value, SeriesAbstrPtr series);
+
+/**
+ * Read only view of the values of a series, for tight loops over the bars in
+ * BarSystem::run or onBar.
+ *
+ * Indexing a Series goes through virtual calls, and through the synchronizer
+ * if the series is synchronized, and checks every index. A SeriesView checks
+ * once, when it is created, that every bar has a value, after which the values
+ * are read directly from the series data, with no virtual calls and no checks.
+ *
+ * Creating a view of a synchronized series goes over all the bars, so views
+ * should be created once, before the loop over the bars, not for each bar.
+ *
+ * The view keeps the series alive, but the series must not be changed while
+ * the view is in use, as this may move its data.
+ *
+ * The Series API remains the safe default - the index passed to operator[] must
+ * be less than size(), which is not checked. Use at() for checked access
+ */
+class SeriesView {
+ private:
+  SeriesAbstrPtr _series;
+  Synchronizer::SynchronizerPtr _synchronizer;
+  // the unsynchronized values
+  const double* _values;
+  // the index in _values of the value of each bar if synchronized, otherwise
+  // null
+  const int* _indexes;
+  size_t _size;
+
+ public:
+  SeriesView() : _values(nullptr), _indexes(nullptr), _size(0) {}
+
+  /**
+   * Creates a view of series
+   *
+   * @param series the series
+   * @exception SeriesIndexOutOfRangeException
+   *                   Thrown if the series is synchronized and some bars
+   *                   don't have a value
+   */
+  explicit SeriesView(SeriesAbstrPtr series)
+      : _series(series),
+        _synchronizer(series->synchronizer()),
+        _values(series->unsyncSize() > 0 ? series->getArray() : nullptr),
+        _indexes(nullptr),
+        _size(series->unsyncSize()) {
+    if (_synchronizer) {
+      const std::vector<int>& indexes = _synchronizer->indexes();
+      for (size_t n = 0; n < indexes.size(); n++) {
+        if (indexes[n] < 0 || (size_t)indexes[n] >= _size) {
+          throw SeriesIndexOutOfRangeException(_size, indexes[n]);
+        }
+      }
+      _indexes = indexes.data();
+      _size = indexes.size();
+    }
+  }
+
+  /**
+   * The value at bar index, not checked
+   */
+  double operator[](size_t index) const {
+    return _indexes == nullptr ? _values[index] : _values[_indexes[index]];
+  }
+
+  /**
+   * The value at bar index
+   *
+   * @exception SeriesIndexOutOfRangeException
+   *                   Thrown if index is not less than size()
+   */
+  double at(size_t index) const {
+    if (index >= _size) {
+      throw SeriesIndexOutOfRangeException(_size, index);
+    }
+    return (*this)[index];
+  }
+
+  /**
+   * The number of bars, the same as the size of the series
+   */
+  size_t size() const { return _size; }
+
+  bool isSynchronized() const { return _indexes != nullptr; }
+
+  /**
+   * The unsynchronized values of the series, contiguous. If the series is not
+   * synchronized, these are the values of the bars
+   */
+  const double* data() const { return _values; }
+
+  /**
+   * The index in data() of the value of each bar if the series is
+   * synchronized, otherwise null
+   */
+  const int* indexes() const { return _indexes; }
+};
+
 /**
  * Interface (abstract class) for a Series of double values.
  *
@@ -297,6 +427,18 @@ class CORE_API Series : public SeriesIndicatorsAbstr {
 
   Series(const Series& series) : _series(series._series) {}
 
+  friend CORE_API Series operator+(double value, const Series& series);
+  friend CORE_API Series operator-(double value, const Series& series);
+  friend CORE_API Series operator*(double value, const Series& series);
+  friend CORE_API Series operator/(double value, const Series& series);
+
+ private:
+  static std::vector<Series> toSeries(const std::vector<SeriesAbstrPtr>& series) {
+    return std::vector<Series>(series.begin(), series.end());
+  }
+
+ public:
+
   virtual Synchronizer::SynchronizerPtr synchronizer() const {
     return _series->synchronizer();
   }
@@ -343,6 +485,14 @@ class CORE_API Series : public SeriesIndicatorsAbstr {
     assert(_series);
     return *_series;
   }
+
+  /**
+   * Returns an unchecked view of the values, for tight loops over the bars
+   *
+   * @return the view
+   * @see SeriesView
+   */
+  SeriesView view() const { return SeriesView(_series); }
   /**
    * Returns a reference to an element in a series, allowint it to
    * be read and/or modified
@@ -461,7 +611,7 @@ class CORE_API Series : public SeriesIndicatorsAbstr {
    *                   thrown if index is outside the Series
    */
   Series operator*(const Series& series) const {
-    return Series((*_series) * series._series);
+    return Series(makeSeriesExpression(kernels::BinaryOp::multiply, _series, series._series));
   }
   /**
    * Multiplication operator - multiplies the values in the current series with
@@ -478,7 +628,7 @@ class CORE_API Series : public SeriesIndicatorsAbstr {
    *                   thrown if index is outside the Series
    */
   Series& operator*=(const Series& series) {
-    (*_series) *= series._series;
+    _series = makeSeriesExpression(kernels::BinaryOp::multiply, _series, series._series);
     return *this;
   }
   /**
@@ -495,7 +645,7 @@ class CORE_API Series : public SeriesIndicatorsAbstr {
    * @return The new series containing the result of the multiplication
    * @exception OperationOnUnequalSizeSeriesException
    */
-  Series operator*(double value) const { return Series((*_series) * value); }
+  Series operator*(double value) const { return Series(makeSeriesExpression(kernels::BinaryOp::multiply, _series, value)); }
   /**
    * \brief Multiplication operator - multiplies the elements of the current
    * series with a constant value and stores the result in the current series
@@ -509,7 +659,7 @@ class CORE_API Series : public SeriesIndicatorsAbstr {
    * @exception OperationOnUnequalSizeSeriesException
    */
   Series& operator*=(double value) {
-    (*_series) *= value;
+    _series = makeSeriesExpression(kernels::BinaryOp::multiply, _series, value);
     return *this;
   }
   /**
@@ -530,7 +680,7 @@ class CORE_API Series : public SeriesIndicatorsAbstr {
    *                   thrown if index is outside the Series
    */
   Series operator+(const Series& series) const {
-    return Series((*_series) + series._series);
+    return Series(makeSeriesExpression(kernels::BinaryOp::add, _series, series._series));
   }
   /**
    * Addition operator - adds the values in the current series with the
@@ -547,7 +697,7 @@ class CORE_API Series : public SeriesIndicatorsAbstr {
    *                   thrown if index is outside the Series
    */
   Series& operator+=(const Series& series) {
-    (*_series) += series._series;
+    _series = makeSeriesExpression(kernels::BinaryOp::add, _series, series._series);
     return *this;
   }
   /**
@@ -583,7 +733,7 @@ class CORE_API Series : public SeriesIndicatorsAbstr {
    * @return The new series containing the result of the add
    * @exception OperationOnUnequalSizeSeriesException
    */
-  Series operator+(double value) const { return Series((*_series) + value); }
+  Series operator+(double value) const { return Series(makeSeriesExpression(kernels::BinaryOp::add, _series, value)); }
   /**
    * \brief Addition operator - adds the elements of the current series with a
    * constant value and stores the result in the current series
@@ -616,7 +766,7 @@ class CORE_API Series : public SeriesIndicatorsAbstr {
    * @exception OperationOnUnequalSizeSeriesException
    */
   Series& operator+=(double value) {
-    (*_series) += value;
+    _series = makeSeriesExpression(kernels::BinaryOp::add, _series, value);
     return *this;
   }
   /**
@@ -648,7 +798,7 @@ class CORE_API Series : public SeriesIndicatorsAbstr {
    * @exception OperationOnUnequalSizeSeriesException
    */
   Series operator-(const Series& series) const {
-    return Series((*_series) - series._series);
+    return Series(makeSeriesExpression(kernels::BinaryOp::subtract, _series, series._series));
   }
   /**
    * \brief Subtraction operator -= subtracts the elements of a series from the
@@ -680,7 +830,7 @@ class CORE_API Series : public SeriesIndicatorsAbstr {
    * @exception OperationOnUnequalSizeSeriesException
    */
   Series& operator-=(const Series& series) {
-    (*_series) -= series._series;
+    _series = makeSeriesExpression(kernels::BinaryOp::subtract, _series, series._series);
     return *this;
   }
   /**
@@ -715,7 +865,7 @@ class CORE_API Series : public SeriesIndicatorsAbstr {
    * @return The new series containing the result of the subtraction
    * @exception OperationOnUnequalSizeSeriesException
    */
-  Series operator-(double value) const { return Series((*_series) - value); }
+  Series operator-(double value) const { return Series(makeSeriesExpression(kernels::BinaryOp::subtract, _series, value)); }
   /**
    * \brief Subtraction operator -= sbutracts a value from the elements of the
    * current series and stores the result in the current series
@@ -743,7 +893,7 @@ class CORE_API Series : public SeriesIndicatorsAbstr {
    * @exception OperationOnUnequalSizeSeriesException
    */
   Series& operator-=(double value) {
-    (*_series) -= value;
+    _series = makeSeriesExpression(kernels::BinaryOp::subtract, _series, value);
     return *this;
   }
   /**
@@ -783,7 +933,7 @@ class CORE_API Series : public SeriesIndicatorsAbstr {
    *                   Thrown if the argument series has one or more 0 elements
    */
   Series operator/(const Series& series) const {
-    return Series((*_series) / series._series);
+    return Series(makeSeriesExpression(kernels::BinaryOp::divide, _series, series._series));
   }
   /**
    * \brief Operator /= divides the current Series by the corresponding values
@@ -819,7 +969,7 @@ class CORE_API Series : public SeriesIndicatorsAbstr {
    *                   Thrown if the argument series has one or more 0 elements
    */
   virtual Series& operator/=(const Series& series) {
-    (*_series) /= series._series;
+    _series = makeSeriesExpression(kernels::BinaryOp::divide, _series, series._series);
     return *this;
   }
   /**
@@ -851,7 +1001,7 @@ class CORE_API Series : public SeriesIndicatorsAbstr {
    *                   Thrown if the value is 0
    */
   Series operator/(double value) const {
-    return Series((*_series) / value);
+    return Series(makeSeriesExpression(kernels::BinaryOp::divide, _series, value));
   }
   /**
    * \brief Operator /= divides the current Series by a value. The result is
@@ -880,7 +1030,7 @@ class CORE_API Series : public SeriesIndicatorsAbstr {
    *                   Thrown if the value is 0
    */
   Series& operator/=(double value) {
-    (*_series) /= value;
+    _series = makeSeriesExpression(kernels::BinaryOp::divide, _series, value);
     return *this;
   }
   /**
@@ -1110,6 +1260,35 @@ class CORE_API Series : public SeriesIndicatorsAbstr {
   const Series Variance(unsigned int period, double nbDev) const override {
     return Series(_series->Variance(period, nbDev));
   }
+  /**
+   * \name Batch indicators
+   *
+   * Calculate an indicator for several periods at once, which is much faster
+   * than one period at a time, for example when optimizing a system. Each of
+   * the results is the same as the one returned by the single period
+   * version, and is shared with it if the series cache is enabled (see
+   * enableSeriesCache)
+   *
+   * @param periods the periods
+   * @return the series for each of the periods, in the same order
+   * @{
+   */
+  std::vector<Series> SMAs(const std::vector<unsigned int>& periods) const {
+    return toSeries(_series->SMAs(periods));
+  }
+  std::vector<Series> EMAs(const std::vector<unsigned int>& periods) const {
+    return toSeries(_series->EMAs(periods));
+  }
+  std::vector<Series> StdDevs(const std::vector<unsigned int>& periods, double nbDev) const {
+    return toSeries(_series->StdDevs(periods, nbDev));
+  }
+  std::vector<Series> Mins(const std::vector<unsigned int>& periods) const {
+    return toSeries(_series->Mins(periods));
+  }
+  std::vector<Series> Maxs(const std::vector<unsigned int>& periods) const {
+    return toSeries(_series->Maxs(periods));
+  }
+  /** @} */
   virtual const Series Correlation(const Series& series, unsigned int period) const {
     return Series(_series->Correlation(series._series, period));
   }
@@ -0,0 +1,149 @@
+/*
+   Copyright (C) 2018-2020 Adrian Michel
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+/** @file
+ *  \brief Vectorized element wise operations on arrays of doubles, used by
+ *  the series arithmetic
+ */
+
+#ifdef SIMLIB_EXPORTS
+#define CORE_API __declspec(dllexport)
+#else
+#define CORE_API __declspec(dllimport)
+#endif
+
+#include <cmath>
+#include <cstddef>
+
+/* @cond */
+namespace tradery {
+namespace kernels {
+/* @endcond */
+
+/**
+ * Element wise binary operations.
+ *
+ * Comparisons return 1.0 if true and 0.0 if false, with the same NaN
+ * semantics as the C++ comparison operators. min and max return the second
+ * operand if either operand is NaN, which is what a < b ? a : b does
+ */
+enum class BinaryOp {
+  add,
+  subtract,
+  multiply,
+  divide,
+  min,
+  max,
+  less,
+  greater,
+  lessEqual,
+  greaterEqual,
+  equal,
+  notEqual
+};
+
+/**
+ * The instruction sets the kernels are implemented for, in increasing order
+ */
+enum class Isa { scalar, sse2, avx2, avx512 };
+
+/**
+ * The scalar definition of each operation - the vectorized kernels return
+ * exactly the same results
+ */
+inline double apply(BinaryOp op, double a, double b) {
+  switch (op) {
+    case BinaryOp::add:
+      return a + b;
+    case BinaryOp::subtract:
+      return a - b;
+    case BinaryOp::multiply:
+      return a * b;
+    case BinaryOp::divide:
+      return a / b;
+    case BinaryOp::min:
+      return a < b ? a : b;
+    case BinaryOp::max:
+      return a > b ? a : b;
+    case BinaryOp::less:
+      return a < b ? 1.0 : 0.0;
+    case BinaryOp::greater:
+      return a > b ? 1.0 : 0.0;
+    case BinaryOp::lessEqual:
+      return a <= b ? 1.0 : 0.0;
+    case BinaryOp::greaterEqual:
+      return a >= b ? 1.0 : 0.0;
+    case BinaryOp::equal:
+      return a == b ? 1.0 : 0.0;
+    case BinaryOp::notEqual:
+      return a != b ? 1.0 : 0.0;
+    default:
+      return a;
+  }
+}
+
+/**
+ * The best instruction set supported by the processor, detected once
+ */
+CORE_API Isa supportedIsa();
+
+/**
+ * The instruction set currently used by the kernels. Defaults to supportedIsa
+ */
+CORE_API Isa isa();
+
+/**
+ * Forces the kernels to use a specific instruction set - used for testing and
+ * benchmarking. Instruction sets not supported by the processor are replaced
+ * with the best supported one
+ *
+ * @param isa    the instruction set
+ * @return the instruction set that will be used
+ */
+CORE_API Isa setIsa(Isa isa);
+
+CORE_API const char* isaName(Isa isa);
+
+/**
+ * out[i] = a[i] op b[i], for i in [0, n). out can be the same as a or b
+ */
+CORE_API void binary(BinaryOp op, const double* a, const double* b, double* out, size_t n);
+
+/**
+ * out[i] = a[i] op value, for i in [0, n). out can be the same as a
+ */
+CORE_API void binary(BinaryOp op, const double* a, double value, double* out, size_t n);
+
+/**
+ * out[i] = value op a[i], for i in [0, n). out can be the same as a
+ */
+CORE_API void binary(BinaryOp op, double value, const double* a, double* out, size_t n);
+
+/**
+ * out[i] = |a[i]|, for i in [0, n). out can be the same as a
+ */
+CORE_API void abs(const double* a, double* out, size_t n);
+
+/**
+ * Copies n values from a to out. The ranges can overlap
+ */
+CORE_API void copy(const double* a, double* out, size_t n);
+
+/* @cond */
+}  // namespace kernels
+}  // namespace tradery
+/* @endcond */
@@ -1266,7 +1266,7 @@ class EquityCurve : public EquityCurveBase {
     // for positions opened and closed on the same bar, use the close of the
     // same bar,
     // for others, use the close of the previous bar
-    Bar b = bars->getBar(LAST_BAR_INDEX(pos));
+    BarRef b = bars->getBarRef(LAST_BAR_INDEX(pos));
     Equity& ec = get(pos.getCloseDate());
     ec.adjustExit(pos, b.getClose());
   }
@@ -1295,7 +1295,7 @@ class EquityCurve : public EquityCurveBase {
       for( size_t n = pos.getEntryBar(); n <= endBar; n++ )
       {
         // get current bar
-        Bar b = bars->getBar(n);
+        BarRef b = bars->getBarRef(n);
         // get current bar time stamp
         Date d = b.time().date();
 
@@ -29,6 +29,8 @@ public:
   static SynchronizerPtr create(Bars ref, Bars syncd);
   virtual ~Synchronizer() {}
   virtual int index(size_t ix) const = 0;
+  // the index of the synced bar for each bar of the reference bars
+  virtual const std::vector<int>& indexes() const = 0;
   virtual size_t size() const = 0;
   virtual bool modified() const = 0;
   virtual bool operator==(const Synchronizer& synchronizer) const = 0;
@@ -28,6 +28,7 @@
 #include <math.h>
 #include <minmax.h>
 #include "explicittrades.h"
+#include "panel.h"
 
 using tradery::chart::Pane;
 
@@ -756,10 +757,11 @@ class BarSystem : public Runnable,
    * Gets bars data for a symbol that can be different than the current symbol
    *
    * The pointer to bars gets stored in a vector data member, to ensure that it
-   * will be there for the duration of the system and it won't be removed from
-   * the cache by the data manager
+   * will be there for the duration of the system
    *
-   * When the system class gets destroyed, the data gets uncached
+   * The bars are the system's own copy of the cached bars (see
+   * DataRequester::getData), so they can be synchronized to the system's bars
+   * while other systems use the same symbol
    */
   Bars getBars(const std::string& symbol) const {
     BarsPtr data = getData(symbol);
@@ -780,6 +782,26 @@ class BarSystem : public Runnable,
     return getBars(symbol);
   }
 
+  /**
+   * Aligns the close and volume values of a list of symbols to the dates of
+   * the default bars, for cross-sectional operations such as ranking
+   *
+   * The bars of the symbols are kept for the duration of the system, as with
+   * getBars
+   *
+   * @param symbols the symbols
+   * @return the panel
+   * @see Panel
+   */
+  Panel::PanelPtr getPanel(const std::vector<std::string>& symbols) const {
+    std::vector<Bars> panelBars;
+    panelBars.reserve(symbols.size());
+    for (const std::string& symbol : symbols) {
+      panelBars.push_back(getBars(symbol));
+    }
+    return Panel::create(bars(), symbols, panelBars);
+  }
+
   Bars getDefaultBars() const { return bars(); }
 
   /**
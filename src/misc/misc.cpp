@@ -225,6 +225,21 @@ public:
   bool is_special() const override { return _date.is_special(); }
 
   int week_number() const { return _date.week_number(); }
+
+  int days() const override {
+    if (_date.is_neg_infinity()) {
+      return Date::NEG_INFINITY_DAYS;
+    }
+    else if (_date.is_pos_infinity()) {
+      return Date::POS_INFINITY_DAYS;
+    }
+    else if (_date.is_not_a_date()) {
+      return Date::NOT_A_DATE_DAYS;
+    }
+    else {
+      return (_date - EPOCH.date()).days();
+    }
+  }
   bool operator==(const DateAbstr& date) const override {
     try {
       return _date == dynamic_cast<const DateImpl&>(date)._date;
@@ -332,7 +347,8 @@ public:
   }
 };
 
-MISC_API Date::Date(const std::string& xdate, DateFormat format, const std::string& sep) {
+MISC_API Date::Date(const std::string& xdate, DateFormat format, const std::string& sep)
+    : _days(NOT_A_DATE_DAYS) {
   parse(xdate, format, sep);
 }
 
@@ -460,7 +476,7 @@ void Date::parse(const std::string& xdate, DateFormat format, const std::string&
 
     day = atoi(tokens[0].c_str());
   }
-  _date = DateAbstr::make(year, month, day);
+  _days = fromYearMonthDay(year, month, day);
 }
 
 class TimeDurationImpl : public TimeDurationAbstr {
@@ -712,6 +728,21 @@ class DateTimeImpl : public DateTimeAbstr {
     return diff.total_seconds();
   }
 
+  __int64 ticks() const override {
+    if (_time.is_neg_infinity()) {
+      return DateTime::NEG_INFINITY_TICKS;
+    }
+    else if (_time.is_pos_infinity()) {
+      return DateTime::POS_INFINITY_TICKS;
+    }
+    else if (_time.is_not_a_date_time()) {
+      return DateTime::NOT_A_DATE_TIME_TICKS;
+    }
+    else {
+      return (_time - EPOCH).total_microseconds();
+    }
+  }
+
   DateAbstrPtr date() const override {
     return std::make_shared< DateImpl >(_time.date());
   }
@@ -909,6 +940,32 @@ DateTimeAbstrPtr DateTimeAbstr::make(__int64 time) {
   return std::make_shared< DateTimeImpl >(t);
 }
 
+DateAbstrPtr DateAbstr::makeFromDays(int days) {
+  switch (days) {
+    case Date::NEG_INFINITY_DAYS:
+      return makeNegInfinity();
+    case Date::POS_INFINITY_DAYS:
+      return makePosInfinity();
+    case Date::NOT_A_DATE_DAYS:
+      return makeNotADate();
+    default:
+      return std::make_shared< DateImpl >(EPOCH.date() + boost::gregorian::days(days));
+  }
+}
+
+DateTimeAbstrPtr DateTimeAbstr::makeFromTicks(__int64 ticks) {
+  switch (ticks) {
+    case DateTime::NEG_INFINITY_TICKS:
+      return makeNegInfinity();
+    case DateTime::POS_INFINITY_TICKS:
+      return makePosInfinity();
+    case DateTime::NOT_A_DATE_TIME_TICKS:
+      return makeNotADateTime();
+    default:
+      return std::make_shared< DateTimeImpl >(EPOCH + boost::posix_time::microseconds(ticks));
+  }
+}
+
 // make special values
 MISC_API DateAbstrPtr DateAbstr::makePosInfinity() {
   return std::make_shared< DateImpl >(boost::gregorian::date(boost::date_time::pos_infin));
@@ -23,6 +23,8 @@
 #include <sys/stat.h>   // For stat().
 
 #include <boost/shared_array.hpp>
+#include <algorithm>
+#include <vector>
 #include <wininet.h>
 #include <Processthreadsapi.h>
 #include <WinBase.h>
@@ -111,6 +113,118 @@ MISCWIN_API void setCurrentThreadIdealProcessor(unsigned int processor) {
   //	::SetThreadAffinityMask( GetCurrentThread(), 1 >> processor );
 }
 
+namespace {
+struct LogicalProcessor {
+  WORD group;
+  BYTE number;
+  DWORD node;
+};
+
+bool contains(const GROUP_AFFINITY& affinity, WORD group, BYTE number) {
+  return affinity.Group == group && (affinity.Mask & (KAFFINITY(1) << number)) != 0;
+}
+
+// the logical processors in the order the threads are pinned to them: one
+// logical processor of each physical core first, the cores of a NUMA node
+// next to each other, then the second logical processor of each core (SMT) etc.
+// Threads with consecutive indexes are on the same node, and a pinned thread
+// keeps its processor caches. Only the memory the thread itself allocates and
+// first touches is on its node: the bars loaded by the prefetch threads, which
+// are not pinned, or shared through the data and series caches can be on any
+// node
+std::vector<LogicalProcessor> affinityOrder() {
+  DWORD size = 0;
+  ::GetLogicalProcessorInformationEx(RelationAll, 0, &size);
+  std::vector<BYTE> buffer(size);
+  if (size == 0 || !::GetLogicalProcessorInformationEx(RelationAll, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()), &size)) {
+    LOG(log_error, "GetLogicalProcessorInformationEx failed: ", GetLastError());
+    return std::vector<LogicalProcessor>();
+  }
+
+  std::vector<std::pair<DWORD, GROUP_AFFINITY> > nodes;
+  std::vector<std::vector<LogicalProcessor> > cores;
+  for (DWORD offset = 0; offset < size;) {
+    const auto info = reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+    if (info->Relationship == RelationNumaNode) {
+      nodes.push_back(std::make_pair(info->NumaNode.NodeNumber, info->NumaNode.GroupMask));
+    }
+    else if (info->Relationship == RelationProcessorCore) {
+      std::vector<LogicalProcessor> core;
+      for (WORD n = 0; n < info->Processor.GroupCount; ++n) {
+        const GROUP_AFFINITY& affinity = info->Processor.GroupMask[n];
+        for (BYTE number = 0; number < sizeof(KAFFINITY) * 8; ++number) {
+          if (contains(affinity, affinity.Group, number)) {
+            core.push_back(LogicalProcessor{affinity.Group, number, 0});
+          }
+        }
+      }
+      if (!core.empty()) {
+        cores.push_back(core);
+      }
+    }
+    offset += info->Size;
+  }
+
+  size_t smt = 0;
+  for (auto& core : cores) {
+    for (auto& processor : core) {
+      for (const auto& node : nodes) {
+        if (contains(node.second, processor.group, processor.number)) {
+          processor.node = node.first;
+        }
+      }
+    }
+    smt = (std::max)(smt, core.size());
+  }
+  // stable, so the cores of a node stay in the system order
+  std::stable_sort(cores.begin(), cores.end(), [](const auto& a, const auto& b) { return a.front().node < b.front().node; });
+
+  std::vector<LogicalProcessor> order;
+  for (size_t n = 0; n < smt; ++n) {
+    for (const auto& core : cores) {
+      if (n < core.size()) {
+        order.push_back(core[n]);
+      }
+    }
+  }
+  return order;
+}
+
+// the affinity of the current thread before it was pinned
+thread_local bool pinned = false;
+thread_local GROUP_AFFINITY unpinnedAffinity;
+}  // namespace
+
+MISCWIN_API void setCurrentThreadAffinity(unsigned int index) {
+  static const std::vector<LogicalProcessor> order(affinityOrder());
+  if (order.empty()) {
+    setCurrentThreadIdealProcessor(index);
+    return;
+  }
+
+  const LogicalProcessor& processor = order[index % order.size()];
+  GROUP_AFFINITY affinity;
+  ZeroMemory(&affinity, sizeof(affinity));
+  affinity.Group = processor.group;
+  affinity.Mask = KAFFINITY(1) << processor.number;
+  // fails if the processor is not in the process affinity
+  if (!::SetThreadGroupAffinity(GetCurrentThread(), &affinity, pinned ? 0 : &unpinnedAffinity)) {
+    LOG(log_error, "SetThreadGroupAffinity failed for group ", processor.group, ", processor ", (unsigned int)processor.number, ": ", GetLastError());
+    setCurrentThreadIdealProcessor(index);
+  }
+  else {
+    pinned = true;
+    LOG(log_debug, "thread ", index, " pinned to group ", processor.group, ", processor ", (unsigned int)processor.number, ", NUMA node ", processor.node);
+  }
+}
+
+MISCWIN_API void resetCurrentThreadAffinity() {
+  if (pinned) {
+    ::SetThreadGroupAffinity(GetCurrentThread(), &unpinnedAffinity, 0);
+    pinned = false;
+  }
+}
+
 MISCWIN_API unsigned long getCurrentCPUNumber() {
   return GetCurrentProcessorNumber();
   // this api is not supported on XP
@@ -0,0 +1,81 @@
+/*
+	 Copyright (C) 2018-2020 Adrian Michel
+
+	 Licensed under the Apache License, Version 2.0 (the "License");
+	 you may not use this file except in compliance with the License.
+	 You may obtain a copy of the License at
+
+			 http://www.apache.org/licenses/LICENSE-2.0
+
+	 Unless required by applicable law or agreed to in writing, software
+	 distributed under the License is distributed on an "AS IS" BASIS,
+	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	 See the License for the specific language governing permissions and
+	 limitations under the License.
+*/
+
+#include "pch.h"
+#include <CppUnitTest.h>
+#include "..\fileplugins\BarsIndex.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace BarsIndexTests {
+	// one bar a minute, 40 bytes per line
+	BarsIndex makeIndex(size_t count) {
+		BarsIndex index("stamp", count * 40, 1);
+		for (size_t n = 0; n < count; ++n) {
+			index.add((__int64)n * 60000000, n * 40);
+		}
+		return index;
+	}
+
+	TEST_CLASS(BarsIndexTests) {
+		TEST_METHOD(Offsets) {
+			const BarsIndex index = makeIndex(10000);
+			Assert::AreEqual((uint64_t)10000, index.count());
+			Assert::AreEqual((size_t)(10000 + BarsIndex::INTERVAL - 1) / BarsIndex::INTERVAL, index.entries().size());
+
+			for (__int64 bar : { 0, 1, 255, 256, 257, 5000, 9999 }) {
+				const uint64_t start = index.startOffset(bar * 60000000);
+				Assert::IsTrue(start <= (uint64_t)bar * 40);
+				Assert::IsTrue((uint64_t)bar * 40 - start <= BarsIndex::INTERVAL * 40);
+
+				const uint64_t end = index.endOffset(bar * 60000000);
+				Assert::IsTrue(end > (uint64_t)bar * 40);
+				Assert::IsTrue(end - bar * 40 <= BarsIndex::INTERVAL * 40);
+			}
+
+			Assert::AreEqual((uint64_t)0, index.startOffset(-1));
+			Assert::AreEqual(index.fileSize(), index.endOffset((__int64)10000 * 60000000));
+		}
+
+		TEST_METHOD(Unsorted) {
+			BarsIndex index = makeIndex(1000);
+			index.add(0, 1000 * 40);
+			Assert::IsFalse(index.sorted());
+			Assert::AreEqual((uint64_t)0, index.startOffset((__int64)500 * 60000000));
+			Assert::AreEqual(index.fileSize(), index.endOffset((__int64)500 * 60000000));
+		}
+
+		TEST_METHOD(SaveLoad) {
+			const std::string fileName((std::filesystem::temp_directory_path() / "BarsIndexTests.idx").string());
+			const BarsIndex index = makeIndex(1000);
+			Assert::IsTrue(index.save(fileName));
+
+			std::unique_ptr<BarsIndex> loaded(BarsIndex::load(fileName));
+			Assert::IsTrue((bool)loaded);
+			Assert::IsTrue(loaded->matches("stamp", 1000 * 40, 1));
+			Assert::IsFalse(loaded->matches("other stamp", 1000 * 40, 1));
+			Assert::IsFalse(loaded->matches("stamp", 1000 * 40, 2));
+			Assert::AreEqual(index.count(), loaded->count());
+			Assert::AreEqual(index.first(), loaded->first());
+			Assert::AreEqual(index.last(), loaded->last());
+			Assert::AreEqual(index.entries().size(), loaded->entries().size());
+			Assert::AreEqual(index.startOffset(123456789), loaded->startOffset(123456789));
+
+			std::filesystem::remove(fileName);
+			Assert::IsFalse((bool)BarsIndex::load(fileName));
+		}
+	};
+}
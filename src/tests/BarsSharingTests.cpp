@@ -0,0 +1,116 @@
+/*
+	 Copyright (C) 2018-2020 Adrian Michel
+
+	 Licensed under the Apache License, Version 2.0 (the "License");
+	 you may not use this file except in compliance with the License.
+	 You may obtain a copy of the License at
+
+			 http://www.apache.org/licenses/LICENSE-2.0
+
+	 Unless required by applicable law or agreed to in writing, software
+	 distributed under the License is distributed on an "AS IS" BASIS,
+	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	 See the License for the specific language governing permissions and
+	 limitations under the License.
+*/
+
+#include "pch.h"
+#include <CppUnitTest.h>
+#include <atomic>
+#include <thread>
+#include "TestDataPath.h"
+#include "..\fileplugins\DataSource.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace tradery;
+
+namespace BarsSharingTests {
+	BarsAbstr& abstr(BarsPtr bars) {
+		Assert::IsNotNull(bars.get());
+		BarsAbstr* abstr = dynamic_cast<BarsAbstr*>(bars.get());
+		Assert::IsNotNull(abstr);
+		return *abstr;
+	}
+
+	TEST_CLASS(BarsSharingTests) {
+		TEST_METHOD_INITIALIZE(Init) {
+			tradery::init(100);
+		}
+
+		TEST_METHOD_CLEANUP(Uninit) {
+			tradery::uninit();
+		}
+
+		// two threads synchronize the same cached symbol to different reference
+		// bars at the same time, each on its own copy
+		TEST_METHOD(SynchronizeOnTwoThreads) {
+			std::unique_ptr<FileDataSource> dataSource(FileDataSource::make(Info("test", ""), TestDataPath{}.makePath("data"), ".csv", format3, false, fatal));
+			const DataInfo symbol(dataSource.get(), std::make_shared<Symbol>("AA"));
+			const DataInfo refs[] = { DataInfo(dataSource.get(), std::make_shared<Symbol>("AAPL")), DataInfo(dataSource.get(), std::make_shared<Symbol>("ABC")) };
+
+			const size_t size = abstr(getDataRequester()->getData(&symbol, 0)).size();
+			std::atomic<int> failed = 0;
+			std::vector<std::thread> threads;
+			for (const DataInfo& ref : refs) {
+				threads.emplace_back([&symbol, &ref, &failed]() {
+					for (int n = 0; n < 20; ++n) {
+						// no asserts on this thread, the failures are counted
+						BarsPtr refBars = getDataRequester()->getData(&ref, 0);
+						BarsPtr bars = getDataRequester()->getData(&symbol, 0);
+						BarsAbstr* synced = dynamic_cast<BarsAbstr*>(bars.get());
+						const BarsAbstr* r = dynamic_cast<const BarsAbstr*>(refBars.get());
+						if (synced == 0 || r == 0) {
+							++failed;
+							continue;
+						}
+						synced->synchronize(Bars(r));
+
+						if (!synced->isSynchronized() || synced->size() != r->size() || !(synced->time(0) == r->time(0)) || !(synced->time(r->size() - 1) == r->time(r->size() - 1))) {
+							++failed;
+						}
+					}
+				});
+			}
+			for (std::thread& thread : threads) {
+				thread.join();
+			}
+			Assert::AreEqual(0, (int)failed);
+
+			// the cached bars are not synchronized
+			const BarsPtr bars = getDataRequester()->getData(&symbol, 0);
+			Assert::IsFalse(abstr(bars).isSynchronized());
+			Assert::AreEqual(size, abstr(bars).size());
+		}
+
+		// the same indicator on two copies, one of them synchronized, is cached
+		// separately for each, with the values calculated the same way
+		TEST_METHOD(IndicatorOnSynchronizedCopy) {
+			tradery::enableSeriesCache(true);
+			std::unique_ptr<FileDataSource> dataSource(FileDataSource::make(Info("test", ""), TestDataPath{}.makePath("data"), ".csv", format3, false, fatal));
+			const DataInfo symbol(dataSource.get(), std::make_shared<Symbol>("AA"));
+			const DataInfo ref(dataSource.get(), std::make_shared<Symbol>("AAPL"));
+
+			const BarsPtr refBars = getDataRequester()->getData(&ref, 0);
+			const BarsPtr syncedBars = getDataRequester()->getData(&symbol, 0);
+			const BarsPtr bars = getDataRequester()->getData(&symbol, 0);
+			abstr(syncedBars).synchronize(Bars(&abstr(refBars)));
+
+			const Series syncedSMA = abstr(syncedBars).closeSeries().SMA(10);
+			const Series sma = abstr(bars).closeSeries().SMA(10);
+			// and again in the other order, from the cache
+			const Series sma2 = abstr(bars).closeSeries().SMA(10);
+			const Series syncedSMA2 = abstr(syncedBars).closeSeries().SMA(10);
+
+			Assert::IsTrue(syncedSMA.isSynchronized());
+			Assert::AreEqual(abstr(refBars).size(), syncedSMA.size());
+			Assert::IsFalse(sma.isSynchronized());
+			Assert::AreEqual(abstr(bars).size(), sma.size());
+			Assert::IsTrue(syncedSMA2.isSynchronized());
+			Assert::AreEqual(abstr(refBars).size(), syncedSMA2.size());
+			Assert::IsFalse(sma2.isSynchronized());
+			Assert::AreEqual(abstr(bars).size(), sma2.size());
+
+			Assert::IsTrue(sma.getVector() == syncedSMA.getVector());
+		}
+	};
+}
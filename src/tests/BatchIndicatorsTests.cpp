@@ -0,0 +1,129 @@
+/*
+	 Copyright (C) 2018-2020 Adrian Michel
+
+	 Licensed under the Apache License, Version 2.0 (the "License");
+	 you may not use this file except in compliance with the License.
+	 You may obtain a copy of the License at
+
+			 http://www.apache.org/licenses/LICENSE-2.0
+
+	 Unless required by applicable law or agreed to in writing, software
+	 distributed under the License is distributed on an "AS IS" BASIS,
+	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	 See the License for the specific language governing permissions and
+	 limitations under the License.
+*/
+
+#include "pch.h"
+#include <CppUnitTest.h>
+#include <cstring>
+#include "TestDataPath.h"
+#include "..\fileplugins\DataSource.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace tradery;
+
+namespace BatchIndicatorsTests {
+	const double NB_DEV = 2;
+
+	bool same(double a, double b) {
+		return std::memcmp(&a, &b, sizeof(double)) == 0 || (a != a && b != b);
+	}
+
+	void assertSame(const Series& expected, const Series& actual) {
+		Assert::AreEqual(expected.size(), actual.size());
+		for (size_t n = 0; n < expected.size(); ++n) {
+			Assert::IsTrue(same(expected.getSeries()[n], actual.getSeries()[n]));
+		}
+	}
+
+	TEST_CLASS(BatchIndicatorsTests) {
+		std::unique_ptr<FileDataSource> _dataSource;
+		BarsPtr _data;
+
+		// the close series of AA, 12055 bars
+		Series close() {
+			const BarsAbstr* bars = dynamic_cast<const BarsAbstr*>(_data.get());
+			Assert::IsNotNull(bars);
+			return bars->closeSeries();
+		}
+
+		// short and long periods, and periods at and past the size of the
+		// series, which are not calculated in the batch
+		std::vector<unsigned int> periods() {
+			const unsigned int size = (unsigned int)close().size();
+			return { 1, 2, 3, 10, 14, 50, 200, 1000, size - 1, size, size + 10 };
+		}
+
+		TEST_METHOD_INITIALIZE(Init) {
+			tradery::init(100);
+			_dataSource.reset(FileDataSource::make(Info("test", ""), TestDataPath{}.makePath("data"), ".csv", format3, false, fatal));
+			const DataInfo symbol(_dataSource.get(), std::make_shared<Symbol>("AA"));
+			_data = getDataRequester()->getData(&symbol, 0);
+		}
+
+		TEST_METHOD_CLEANUP(Uninit) {
+			_data.reset();
+			tradery::uninit();
+			_dataSource.reset();
+		}
+
+		// with the series cache disabled each single period series is calculated
+		// on its own, and has the same values as the batch one
+		TEST_METHOD(BatchEqualsSinglePeriod) {
+			const Series series = close();
+			const std::vector<unsigned int> p = periods();
+
+			const std::vector<Series> smas = series.SMAs(p);
+			const std::vector<Series> emas = series.EMAs(p);
+			const std::vector<Series> stdDevs = series.StdDevs(p, NB_DEV);
+			const std::vector<Series> mins = series.Mins(p);
+			const std::vector<Series> maxs = series.Maxs(p);
+			Assert::AreEqual(p.size(), smas.size());
+			Assert::AreEqual(p.size(), emas.size());
+			Assert::AreEqual(p.size(), stdDevs.size());
+			Assert::AreEqual(p.size(), mins.size());
+			Assert::AreEqual(p.size(), maxs.size());
+
+			for (size_t n = 0; n < p.size(); ++n) {
+				assertSame(series.SMA(p[n]), smas[n]);
+				assertSame(series.EMA(p[n]), emas[n]);
+				assertSame(series.StdDev(p[n], NB_DEV), stdDevs[n]);
+				assertSame(series.Min(p[n]), mins[n]);
+				assertSame(series.Max(p[n]), maxs[n]);
+			}
+		}
+
+		// with the series cache enabled, a single period series looked up after a
+		// batch is the one the batch added to the cache, and a batch after a
+		// single period series returns the cached one
+		TEST_METHOD(SinglePeriodHitsBatchEntry) {
+			enableSeriesCache(true);
+
+			const Series series = close();
+			const std::vector<unsigned int> p = { 5, 20, 100 };
+
+			const std::vector<Series> smas = series.SMAs(p);
+			const std::vector<Series> emas = series.EMAs(p);
+			const std::vector<Series> stdDevs = series.StdDevs(p, NB_DEV);
+			const std::vector<Series> mins = series.Mins(p);
+			const std::vector<Series> maxs = series.Maxs(p);
+
+			for (size_t n = 0; n < p.size(); ++n) {
+				Assert::IsTrue(&smas[n].getSeries() == &series.SMA(p[n]).getSeries());
+				Assert::IsTrue(&emas[n].getSeries() == &series.EMA(p[n]).getSeries());
+				Assert::IsTrue(&stdDevs[n].getSeries() == &series.StdDev(p[n], NB_DEV).getSeries());
+				Assert::IsTrue(&mins[n].getSeries() == &series.Min(p[n]).getSeries());
+				Assert::IsTrue(&maxs[n].getSeries() == &series.Max(p[n]).getSeries());
+			}
+
+			// the same periods with another number of deviations are other series
+			Assert::IsFalse(&stdDevs[0].getSeries() == &series.StdDev(p[0], NB_DEV + 1).getSeries());
+
+			const Series sma = series.SMA(30);
+			const std::vector<Series> again = series.SMAs({ 5, 30 });
+			Assert::IsTrue(&smas[0].getSeries() == &again[0].getSeries());
+			Assert::IsTrue(&sma.getSeries() == &again[1].getSeries());
+		}
+	};
+}
@@ -0,0 +1,76 @@
+/*
+	 Copyright (C) 2018-2020 Adrian Michel
+
+	 Licensed under the Apache License, Version 2.0 (the "License");
+	 you may not use this file except in compliance with the License.
+	 You may obtain a copy of the License at
+
+			 http://www.apache.org/licenses/LICENSE-2.0
+
+	 Unless required by applicable law or agreed to in writing, software
+	 distributed under the License is distributed on an "AS IS" BASIS,
+	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	 See the License for the specific language governing permissions and
+	 limitations under the License.
+*/
+
+#include "pch.h"
+#include <CppUnitTest.h>
+#include "..\fileplugins\BinaryBars.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace BinaryBarsTests {
+	BinaryBarsColumns makeColumns(size_t count) {
+		BinaryBarsColumns columns;
+		for (size_t n = 0; n < count; ++n) {
+			const double price = 100 + n % 17;
+			columns.add(1000000000000 + (__int64)n * 60000000, price, price + 1, price - 1, price + 0.5, (double)(n * 100), (double)n);
+		}
+		return columns;
+	}
+
+	void roundTrip(bool deltaTime) {
+		const BinaryBarsColumns columns = makeColumns(1000);
+		std::ostringstream os(std::ios_base::out | std::ios_base::binary);
+		columns.write(os, deltaTime);
+		const std::string data = os.str();
+
+		BinaryBarsReader reader(data.data(), data.size());
+		Assert::AreEqual(columns.size(), reader.size());
+		for (size_t n = 0; n < reader.size(); ++n) {
+			Assert::AreEqual(columns.time[n], reader.time()[n]);
+			for (int column = BinaryBarsHeader::open; column < BinaryBarsHeader::columnCount; ++column) {
+				Assert::AreEqual(columns.column((BinaryBarsHeader::Column)column)[n], reader.column((BinaryBarsHeader::Column)column)[n]);
+			}
+		}
+	}
+
+	TEST_CLASS(BinaryBarsTests) {
+		TEST_METHOD(RoundTrip) {
+			roundTrip(false);
+		}
+
+		TEST_METHOD(RoundTripDeltaTime) {
+			roundTrip(true);
+		}
+
+		TEST_METHOD(Truncated) {
+			std::ostringstream os(std::ios_base::out | std::ios_base::binary);
+			makeColumns(10).write(os);
+			const std::string data = os.str();
+
+			Assert::ExpectException< BinaryBarsException >([&data]() { BinaryBarsReader(data.data(), data.size() - 8); });
+			Assert::ExpectException< BinaryBarsException >([&data]() { BinaryBarsReader(data.data(), 16); });
+		}
+
+		TEST_METHOD(BadMagic) {
+			std::ostringstream os(std::ios_base::out | std::ios_base::binary);
+			makeColumns(10).write(os);
+			std::string data = os.str();
+			data[0] = 'X';
+
+			Assert::ExpectException< BinaryBarsException >([&data]() { BinaryBarsReader(data.data(), data.size()); });
+		}
+	};
+}
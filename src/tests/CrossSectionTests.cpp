@@ -0,0 +1,79 @@
+/*
+	 Copyright (C) 2018-2020 Adrian Michel
+
+	 Licensed under the Apache License, Version 2.0 (the "License");
+	 you may not use this file except in compliance with the License.
+	 You may obtain a copy of the License at
+
+			 http://www.apache.org/licenses/LICENSE-2.0
+
+	 Unless required by applicable law or agreed to in writing, software
+	 distributed under the License is distributed on an "AS IS" BASIS,
+	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	 See the License for the specific language governing permissions and
+	 limitations under the License.
+*/
+
+
+#include "pch.h"
+#include <CppUnitTest.h>
+#include <panel.h>
+#include <cmath>
+#include <limits>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace tradery;
+
+namespace CrossSectionTests {
+	const double NaN = std::numeric_limits< double >::quiet_NaN();
+
+	TEST_CLASS(CrossSectionTests) {
+		TEST_METHOD(RankAveragesTiesAndSkipsInvalid) {
+			const double values[] = { 3, 1, 3, 7, NaN };
+			const unsigned char valid[] = { 1, 1, 1, 0, 1 };
+			double out[5];
+			crossSection::rank(values, valid, 5, out);
+			Assert::AreEqual(1.5, out[0]);
+			Assert::AreEqual(0.0, out[1]);
+			Assert::AreEqual(1.5, out[2]);
+			Assert::IsTrue(std::isnan(out[3]));
+			Assert::IsTrue(std::isnan(out[4]));
+		}
+
+		TEST_METHOD(Percentile) {
+			const double values[] = { 10, 30, 20 };
+			const unsigned char valid[] = { 1, 1, 1 };
+			double out[3];
+			crossSection::percentile(values, valid, 3, out);
+			Assert::AreEqual(0.0, out[0]);
+			Assert::AreEqual(1.0, out[1]);
+			Assert::AreEqual(0.5, out[2]);
+
+			const unsigned char one[] = { 0, 1, 0 };
+			crossSection::percentile(values, one, 3, out);
+			Assert::AreEqual(0.5, out[1]);
+		}
+
+		TEST_METHOD(ZScore) {
+			const double values[] = { 2, 4, 4, 4, 5, 5, 7, 9 };
+			const unsigned char valid[] = { 1, 1, 1, 1, 1, 1, 1, 1 };
+			double out[8];
+			crossSection::zScore(values, valid, 8, out);
+			// mean 5, population standard deviation 2
+			Assert::AreEqual(-1.5, out[0]);
+			Assert::AreEqual(0.0, out[4]);
+			Assert::AreEqual(2.0, out[7]);
+		}
+
+		TEST_METHOD(TopKIsHighestFirstInIndexOrder) {
+			const double values[] = { 5, 9, 1, 9, 7 };
+			const unsigned char valid[] = { 1, 1, 1, 1, 0 };
+			const std::vector< size_t > top = crossSection::topK(values, valid, 5, 3);
+			Assert::AreEqual(size_t(3), top.size());
+			Assert::AreEqual(size_t(1), top[0]);
+			Assert::AreEqual(size_t(3), top[1]);
+			Assert::AreEqual(size_t(0), top[2]);
+			Assert::AreEqual(size_t(4), crossSection::topK(values, valid, 5, 10).size());
+		}
+	};
+}
@@ -0,0 +1,165 @@
+/*
+	 Copyright (C) 2018-2020 Adrian Michel
+
+	 Licensed under the Apache License, Version 2.0 (the "License");
+	 you may not use this file except in compliance with the License.
+	 You may obtain a copy of the License at
+
+			 http://www.apache.org/licenses/LICENSE-2.0
+
+	 Unless required by applicable law or agreed to in writing, software
+	 distributed under the License is distributed on an "AS IS" BASIS,
+	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	 See the License for the specific language governing permissions and
+	 limitations under the License.
+*/
+
+#include "pch.h"
+#include <CppUnitTest.h>
+#include <datetime.h>
+#include <boost/date_time/gregorian/gregorian.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace tradery;
+
+namespace DateTimeTests {
+	namespace bg = boost::gregorian;
+	namespace bpt = boost::posix_time;
+
+	bg::date toBoost(const Date& date) {
+		if (date.isNegInfinity()) {
+			return bg::date(boost::date_time::neg_infin);
+		}
+		if (date.isPosInfinity()) {
+			return bg::date(boost::date_time::pos_infin);
+		}
+		if (date.isNotADate()) {
+			return bg::date(boost::date_time::not_a_date_time);
+		}
+		return bg::date(date.year(), date.month(), date.day());
+	}
+
+	bpt::ptime toBoost(const DateTime& time) {
+		if (time.isNegInfinity()) {
+			return bpt::ptime(boost::date_time::neg_infin);
+		}
+		if (time.isPosInfinity()) {
+			return bpt::ptime(boost::date_time::pos_infin);
+		}
+		if (time.isNotADateTime()) {
+			return bpt::ptime(boost::date_time::not_a_date_time);
+		}
+		return bpt::ptime(bg::date(1970, 1, 1)) + bpt::microseconds(time.ticks());
+	}
+
+	TEST_CLASS(DateTimeTests) {
+		// every day from before 1900 to after 2100 has the same days as the
+		// boost date, and the same year, month and day when made from its days
+		TEST_METHOD(CivilRoundTrip) {
+			const bg::date epoch(1970, 1, 1);
+			for (bg::day_iterator i(bg::date(1895, 1, 1)); *i <= bg::date(2105, 12, 31); ++i) {
+				const Date date(i->year(), i->month(), i->day());
+				Assert::AreEqual((int)(*i - epoch).days(), date.days());
+
+				const Date fromDays(Date::fromDays(date.days()));
+				Assert::AreEqual((int)i->year(), (int)fromDays.year());
+				Assert::AreEqual((int)i->month(), (int)fromDays.month());
+				Assert::AreEqual((int)i->day(), (int)fromDays.day());
+			}
+
+			Assert::AreEqual(-1, Date(1969, 12, 31).days());
+			Assert::AreEqual(0, Date(1970, 1, 1).days());
+			// 1900 is not a leap year, 2000 is
+			Assert::ExpectException<std::out_of_range>([]() { Date(1900, 2, 29); });
+			Assert::AreEqual(1, Date(1900, 3, 1).days() - Date(1900, 2, 28).days());
+			Assert::AreEqual(2, Date(2000, 3, 1).days() - Date(2000, 2, 28).days());
+			Assert::AreEqual(29, (int)Date::fromDays(Date(2000, 3, 1).days() - 1).day());
+			Assert::AreEqual(28, (int)Date::fromDays(Date(1900, 3, 1).days() - 1).day());
+			Assert::AreEqual(29, (int)Date::fromDays(Date(1904, 3, 1).days() - 1).day());
+		}
+
+		// the special values compare as the boost ones do
+		TEST_METHOD(CompareSpecialValues) {
+			const Date dates[] = { NegInfinityDate(), Date(1900, 1, 1), Date(1969, 12, 31), Date(2000, 2, 29), PosInfinityDate(), NotADate() };
+			for (const Date& a : dates) {
+				for (const Date& b : dates) {
+					const bg::date ba(toBoost(a));
+					const bg::date bb(toBoost(b));
+					Assert::AreEqual(ba < bb, a < b);
+					Assert::AreEqual(ba > bb, a > b);
+					Assert::AreEqual(ba <= bb, a <= b);
+					Assert::AreEqual(ba >= bb, a >= b);
+					Assert::AreEqual(ba == bb, a == b);
+					Assert::AreEqual(ba != bb, a != b);
+				}
+			}
+
+			const DateTime times[] = { NegInfinityDateTime(), DateTime::fromTicks(-1), DateTime::fromTicks(0), DateTime(Date(2000, 2, 29), TimeDuration(12, 30, 0)), PosInfinityDateTime(), NotADateTime() };
+			for (const DateTime& a : times) {
+				for (const DateTime& b : times) {
+					const bpt::ptime ba(toBoost(a));
+					const bpt::ptime bb(toBoost(b));
+					Assert::AreEqual(ba < bb, a < b);
+					Assert::AreEqual(ba > bb, a > b);
+					Assert::AreEqual(ba <= bb, a <= b);
+					Assert::AreEqual(ba >= bb, a >= b);
+					Assert::AreEqual(ba == bb, a == b);
+					Assert::AreEqual(ba != bb, a != b);
+				}
+			}
+
+			// a date and its time keep the special values
+			for (const Date& date : dates) {
+				Assert::IsTrue(DateTime(date).date() == date);
+			}
+		}
+
+		// times before the epoch are on the previous day, with a positive time of
+		// day
+		TEST_METHOD(TimeOfDayBeforeEpoch) {
+			const __int64 ticks[] = { -1, -DateTime::TICKS_PER_SECOND, -DateTime::TICKS_PER_DAY, -DateTime::TICKS_PER_DAY - 1, -DateTime::TICKS_PER_DAY + 1, -2208988800LL * DateTime::TICKS_PER_SECOND + 123456, 0, 1 };
+			for (__int64 t : ticks) {
+				const DateTime time(DateTime::fromTicks(t));
+				const bpt::ptime ptime(toBoost(time));
+
+				Assert::IsTrue(time.date() == Date(ptime.date().year(), ptime.date().month(), ptime.date().day()));
+				const TimeDuration timeOfDay(time.time_of_day());
+				const bpt::time_duration boostTimeOfDay(ptime.time_of_day());
+				Assert::IsFalse(timeOfDay.is_negative());
+				Assert::AreEqual((long)boostTimeOfDay.hours(), timeOfDay.hours());
+				Assert::AreEqual((long)boostTimeOfDay.minutes(), timeOfDay.minutes());
+				Assert::AreEqual((long)boostTimeOfDay.seconds(), timeOfDay.seconds());
+				Assert::AreEqual((long)boostTimeOfDay.fractional_seconds(), timeOfDay.fractional_seconds());
+			}
+
+			const TimeDuration lastMicrosecond(DateTime::fromTicks(-1).time_of_day());
+			Assert::IsTrue(DateTime::fromTicks(-1).date() == Date(1969, 12, 31));
+			Assert::AreEqual(23L, lastMicrosecond.hours());
+			Assert::AreEqual(59L, lastMicrosecond.minutes());
+			Assert::AreEqual(59L, lastMicrosecond.seconds());
+		}
+
+		// differences of dates and times are the boost ones
+		TEST_METHOD(Differences) {
+			const Date dates[] = { Date(1899, 12, 31), Date(1900, 2, 28), Date(1900, 3, 1), Date(1969, 12, 31), Date(1970, 1, 1), Date(2000, 2, 29), Date(2020, 12, 31) };
+			for (const Date& a : dates) {
+				for (const Date& b : dates) {
+					Assert::AreEqual((long)(toBoost(a) - toBoost(b)).days(), (a - b).days());
+				}
+			}
+
+			// within 68 years of each other, so the total seconds fit in a long
+			const DateTime times[] = { DateTime(Date(1950, 6, 15), TimeDuration(0, 0, 0, 1)), DateTime::fromTicks(-1), DateTime::fromTicks(-DateTime::TICKS_PER_SECOND / 2), DateTime::fromTicks(0), DateTime(Date(2000, 2, 29), TimeDuration(23, 59, 59, 999999)), DateTime(Date(2000, 3, 1)) };
+			for (const DateTime& a : times) {
+				for (const DateTime& b : times) {
+					const TimeDuration duration(a - b);
+					const bpt::time_duration boostDuration(toBoost(a) - toBoost(b));
+					Assert::AreEqual(boostDuration.is_negative(), duration.is_negative());
+					Assert::AreEqual((long)boostDuration.total_seconds(), duration.total_seconds());
+					Assert::AreEqual((long)boostDuration.fractional_seconds(), duration.fractional_seconds());
+				}
+			}
+		}
+	};
+}
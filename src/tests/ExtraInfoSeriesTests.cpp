@@ -0,0 +1,81 @@
+/*
+	 Copyright (C) 2018-2020 Adrian Michel
+
+	 Licensed under the Apache License, Version 2.0 (the "License");
+	 you may not use this file except in compliance with the License.
+	 You may obtain a copy of the License at
+
+			 http://www.apache.org/licenses/LICENSE-2.0
+
+	 Unless required by applicable law or agreed to in writing, software
+	 distributed under the License is distributed on an "AS IS" BASIS,
+	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	 See the License for the specific language governing permissions and
+	 limitations under the License.
+*/
+
+#include "pch.h"
+#include <CppUnitTest.h>
+#include <datasource.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace tradery;
+
+namespace ExtraInfoSeriesTests {
+	class TestExtraInfo : public BarExtraInfo {
+	public:
+		const int value;
+
+		TestExtraInfo(int value) : value(value) {}
+
+		BarExtraInfoPtr clone() const override { return std::make_shared< TestExtraInfo >(value); }
+		std::wostream& dump(std::wostream& os) const override { return os << value; }
+	};
+
+	int value(const BarExtraInfoPtr& info) { return dynamic_cast<const TestExtraInfo&>(*info).value; }
+
+	TEST_CLASS(ExtraInfoSeriesTests) {
+		TEST_METHOD(OnlyBarsWithInfoAreStored) {
+			ExtraInfoSeries series;
+			series.push_back(BarExtraInfoPtr{});
+			series.push_back(std::make_shared< TestExtraInfo >(1));
+			series.resize(1000);
+			series.push_back(std::make_shared< TestExtraInfo >(2));
+
+			Assert::AreEqual((size_t)1001, series.size());
+			Assert::AreEqual((size_t)2, series.count());
+			Assert::IsFalse((bool)series[0]);
+			Assert::AreEqual(1, value(series[1]));
+			Assert::IsFalse((bool)series[999]);
+			Assert::AreEqual(2, value(series[1000]));
+		}
+
+		TEST_METHOD(ResizeRemovesLastBars) {
+			ExtraInfoSeries series;
+			series.resize(10);
+			series.push_back(std::make_shared< TestExtraInfo >(1));
+			series.resize(5);
+
+			Assert::AreEqual((size_t)5, series.size());
+			Assert::AreEqual((size_t)0, series.count());
+		}
+
+		TEST_METHOD(AppendRange) {
+			ExtraInfoSeries source;
+			for (int n = 0; n < 10; ++n) {
+				source.push_back(n % 3 == 0 ? std::make_shared< TestExtraInfo >(n) : BarExtraInfoPtr{});
+			}
+
+			ExtraInfoSeries series;
+			series.push_back(std::make_shared< TestExtraInfo >(-1));
+			series.append(source, 2, 5);
+
+			Assert::AreEqual((size_t)6, series.size());
+			Assert::AreEqual((size_t)3, series.count());
+			Assert::AreEqual(-1, value(series[0]));
+			Assert::AreEqual(3, value(series[2]));
+			Assert::AreEqual(6, value(series[5]));
+			Assert::IsFalse((bool)series[1]);
+		}
+	};
+}
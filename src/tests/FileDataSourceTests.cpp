@@ -0,0 +1,163 @@
+/*
+	 Copyright (C) 2018-2020 Adrian Michel
+
+	 Licensed under the Apache License, Version 2.0 (the "License");
+	 you may not use this file except in compliance with the License.
+	 You may obtain a copy of the License at
+
+			 http://www.apache.org/licenses/LICENSE-2.0
+
+	 Unless required by applicable law or agreed to in writing, software
+	 distributed under the License is distributed on an "AS IS" BASIS,
+	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	 See the License for the specific language governing permissions and
+	 limitations under the License.
+*/
+
+#include "pch.h"
+#include <CppUnitTest.h>
+#include <fstream>
+#include "TestDataPath.h"
+#include "..\fileplugins\DataSource.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace tradery;
+
+namespace FileDataSourceTests {
+	// the index files are kept out of the test data
+	const std::string indexPath() {
+		return (std::filesystem::temp_directory_path() / "FileDataSourceTests").string();
+	}
+
+	BarsPtr load(FileDataSource::ParserMode parserMode, const std::string& symbol, DateTimeRangePtr range) {
+		std::unique_ptr<FileDataSource> dataSource(FileDataSource::make(Info("test", ""), TestDataPath{}.makePath("data"), ".csv", format3, false, fatal));
+		dataSource->setParserMode(parserMode);
+		dataSource->setIndexPath(indexPath());
+		const DataInfo dataInfo(dataSource.get(), std::make_shared<Symbol>(symbol));
+		return dataSource->getData(&dataInfo, range)->getDataCollection();
+	}
+
+	const BarsAbstr& abstr(const BarsPtr& bars) {
+		const BarsAbstr* abstr = dynamic_cast<const BarsAbstr*>(bars.get());
+		Assert::IsNotNull(abstr);
+		return *abstr;
+	}
+
+	// parses a data file with the mapped parser, which appends the bars in
+	// chunks if they are a BarsAppender
+	class ChunkParser : public FileDataSourceFormat3 {
+	public:
+		using FileDataSource::APPEND_CHUNK;
+
+		ChunkParser()
+			: FileDataSourceFormat3(Info("test", ""), TestDataPath{}.makePath("data"), ".csv", false, fatal) {}
+
+		void parse(Addable<Bar>* bars, const std::string& fileName) const {
+			MappedFile file(fileName);
+			Assert::IsTrue((bool)file);
+			parseBars(bars, file, DateTimeRangePtr());
+		}
+	};
+
+	// adds the bars one at a time, as it is not a BarsAppender
+	class PerBar : public Addable<Bar> {
+	private:
+		BarsBase& _bars;
+
+	public:
+		PerBar(BarsBase& bars)
+			: _bars(bars) {}
+
+		void add(const Bar& bar) override {
+			_bars.add(bar);
+		}
+	};
+
+	const std::string aaFileName() {
+		return (std::filesystem::path(TestDataPath{}.makePath("data")) / "A" / "A" / "AA.csv").string();
+	}
+
+	void assertSameBars(const BarsAbstr& expected, const BarsAbstr& actual) {
+		Assert::AreEqual(expected.size(), actual.size());
+		for (size_t n = 0; n < expected.size(); ++n) {
+			Assert::IsTrue(expected.time(n) == actual.time(n));
+			Assert::AreEqual(expected.open(n), actual.open(n));
+			Assert::AreEqual(expected.high(n), actual.high(n));
+			Assert::AreEqual(expected.low(n), actual.low(n));
+			Assert::AreEqual(expected.close(n), actual.close(n));
+			Assert::AreEqual(expected.volume(n), actual.volume(n));
+			Assert::AreEqual(expected.openInterest(n), actual.openInterest(n));
+		}
+	}
+
+	TEST_CLASS(FileDataSourceTests) {
+		TEST_METHOD_INITIALIZE(Init) {
+			tradery::init(100);
+		}
+
+		TEST_METHOD_CLEANUP(Uninit) {
+			tradery::uninit();
+			std::error_code error;
+			std::filesystem::remove_all(indexPath(), error);
+		}
+
+		// the mapped parser makes the same bars as the stream parser, for all the
+		// data and for ranges, which the mapped parser reads through the index
+		TEST_METHOD(MappedAndStreamParseTheSameBars) {
+			const DateTimeRangePtr ranges[] = {
+				DateTimeRangePtr(),
+				std::make_shared<DateTimeRange>(DateTime(Date(1990, 1, 1)), DateTime(Date(2000, 12, 31))),
+				std::make_shared<DateTimeRange>(DateTime(Date(2017, 1, 1)), PosInfinityDateTime())
+			};
+
+			for (const std::string symbol : { "AA", "AAPL", "ABC" }) {
+				for (const DateTimeRangePtr& range : ranges) {
+					const BarsPtr stream = load(FileDataSource::ParserMode::stream, symbol, range);
+					const BarsPtr mapped = load(FileDataSource::ParserMode::mapped, symbol, range);
+					if (!range) {
+						Assert::IsTrue(abstr(stream).size() > 0);
+					}
+					assertSameBars(abstr(stream), abstr(mapped));
+
+					// again, with the index built by the first load
+					assertSameBars(abstr(stream), abstr(load(FileDataSource::ParserMode::mapped, symbol, range)));
+				}
+			}
+		}
+
+		// appending the bars in chunks adds the same bars as appending them one
+		// at a time, also when a bar past the first chunk is not valid and the
+		// mode is fatal
+		TEST_METHOD(ChunkedAndPerBarAppendTheSameBars) {
+			const ChunkParser parser;
+			const BarsPtr chunked = createBars("test", "AA", BarsAbstr::Type::stock, 24 * 3600, DateTimeRangePtr(), fatal);
+			const BarsPtr perBar = createBars("test", "AA", BarsAbstr::Type::stock, 24 * 3600, DateTimeRangePtr(), fatal);
+			parser.parse(chunked.get(), aaFileName());
+			PerBar perBarAdder(*perBar);
+			parser.parse(&perBarAdder, aaFileName());
+			Assert::IsTrue(abstr(chunked).size() > 2 * ChunkParser::APPEND_CHUNK);
+			assertSameBars(abstr(perBar), abstr(chunked));
+
+			// a copy of AA with the high below the low in a bar of the second chunk
+			const size_t invalid = ChunkParser::APPEND_CHUNK + 1000;
+			std::filesystem::create_directories(indexPath());
+			const std::string fileName = (std::filesystem::path(indexPath()) / "AA.csv").string();
+			{
+				std::ifstream in(aaFileName(), std::ios_base::binary);
+				std::ofstream out(fileName, std::ios_base::binary);
+				std::string line;
+				for (size_t n = 0; std::getline(in, line); ++n) {
+					out << (n == invalid ? line.substr(0, line.find(',')) + ",10,5,20,10,1000\r" : line) << "\n";
+				}
+			}
+
+			const BarsPtr chunkedInvalid = createBars("test", "AA", BarsAbstr::Type::stock, 24 * 3600, DateTimeRangePtr(), fatal);
+			const BarsPtr perBarInvalid = createBars("test", "AA", BarsAbstr::Type::stock, 24 * 3600, DateTimeRangePtr(), fatal);
+			Assert::ExpectException<BarException>([&]() { parser.parse(chunkedInvalid.get(), fileName); });
+			PerBar perBarInvalidAdder(*perBarInvalid);
+			Assert::ExpectException<BarException>([&]() { parser.parse(&perBarInvalidAdder, fileName); });
+			Assert::AreEqual(invalid, abstr(chunkedInvalid).size());
+			assertSameBars(abstr(perBarInvalid), abstr(chunkedInvalid));
+		}
+	};
+}
@@ -0,0 +1,170 @@
+/*
+	 Copyright (C) 2018-2020 Adrian Michel
+
+	 Licensed under the Apache License, Version 2.0 (the "License");
+	 you may not use this file except in compliance with the License.
+	 You may obtain a copy of the License at
+
+			 http://www.apache.org/licenses/LICENSE-2.0
+
+	 Unless required by applicable law or agreed to in writing, software
+	 distributed under the License is distributed on an "AS IS" BASIS,
+	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	 See the License for the specific language governing permissions and
+	 limitations under the License.
+*/
+
+#include "pch.h"
+#include <CppUnitTest.h>
+#include <datasource.h>
+#include <cstring>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace tradery;
+
+namespace IndicatorExtensionTests {
+	const unsigned int PERIOD = 20;
+	const size_t OLD_SIZE = 400;
+	const size_t NEW_SIZE = 500;
+
+	std::vector<double> makeCloses(size_t size) {
+		std::vector<double> closes;
+		unsigned int seed = 1;
+		for (size_t n = 0; n < size; ++n) {
+			seed = seed * 1103515245 + 12345;
+			closes.push_back(50 + (double)(seed >> 16 & 0xfff) / 100);
+		}
+		return closes;
+	}
+
+	// daily bars with the first count closes. Bars made with the same data
+	// source name and symbol are loaded from the same source, so they extend the
+	// previous ones if their first bars are the same
+	BarsPtr makeBars(const std::string& dataSourceName, const std::string& symbol, const std::vector<double>& closes, size_t count) {
+		BarsPtr bars = createBars(dataSourceName, symbol, BarsAbstr::Type::stock, 24 * 3600, DateTimeRangePtr(), fatal);
+		for (size_t n = 0; n < count; ++n) {
+			bars->add(Bar(DateTime(Date::fromDays((int)n)), closes[n], closes[n] + 1, closes[n] - 1, closes[n], (unsigned long)(1000 + n)));
+		}
+		return bars;
+	}
+
+	Bars bars(const BarsPtr& bars) {
+		const BarsAbstr* abstr = dynamic_cast<const BarsAbstr*>(bars.get());
+		Assert::IsNotNull(abstr);
+		return Bars(abstr);
+	}
+
+	bool same(double a, double b) {
+		return std::memcmp(&a, &b, sizeof(double)) == 0 || (a != a && b != b);
+	}
+
+	// the first count values of actual are those of expected
+	void assertSame(const Series& expected, const Series& actual, size_t count) {
+		Assert::IsTrue(expected.size() >= count);
+		Assert::IsTrue(actual.size() >= count);
+		for (size_t n = 0; n < count; ++n) {
+			Assert::IsTrue(same(expected.getSeries()[n], actual.getSeries()[n]));
+		}
+	}
+
+	void assertSame(const Series& expected, const Series& actual) {
+		Assert::AreEqual(expected.size(), actual.size());
+		assertSame(expected, actual, expected.size());
+	}
+
+	// the indicators calculated on the old bars, kept in the series cache while
+	// the new bars are made
+	class Indicators {
+	public:
+		Series sma;
+		Series ema;
+		Series stdDev;
+		Series atr;
+
+		Indicators(Bars bars)
+			: sma(bars.closeSeries().SMA(PERIOD)), ema(bars.closeSeries().EMA(PERIOD)), stdDev(bars.closeSeries().StdDev(PERIOD, 2)), atr(bars.ATR(PERIOD)) {}
+	};
+
+	void assertSame(const Indicators& expected, const Indicators& actual) {
+		assertSame(expected.sma, actual.sma);
+		assertSame(expected.ema, actual.ema);
+		assertSame(expected.stdDev, actual.stdDev);
+		assertSame(expected.atr, actual.atr);
+	}
+
+	TEST_CLASS(IndicatorExtensionTests) {
+		TEST_METHOD_INITIALIZE(Init) {
+			tradery::init(100);
+			// the indicators to extend are found in the series cache
+			enableSeriesCache(true);
+		}
+
+		TEST_METHOD_CLEANUP(Uninit) {
+			tradery::uninit();
+		}
+
+		// the indicators on bars that gained bars, which extend those on the
+		// previous bars, are those calculated from scratch on bars from another
+		// source
+		TEST_METHOD(ExtendedEqualsFromScratch) {
+			const std::vector<double> closes = makeCloses(NEW_SIZE);
+
+			BarsPtr oldBars = makeBars("IndicatorExtensionTests", "GROWN", closes, OLD_SIZE);
+			const Indicators old(bars(oldBars));
+			// the history is recorded when the bars are released
+			oldBars.reset();
+
+			const BarsPtr grownBars = makeBars("IndicatorExtensionTests", "GROWN", closes, NEW_SIZE);
+			const Indicators grown(bars(grownBars));
+			const BarsPtr scratchBars = makeBars("Scratch", "GROWN", closes, NEW_SIZE);
+			const Indicators scratch(bars(scratchBars));
+
+			assertSame(scratch, grown);
+			assertSame(old.sma, grown.sma, OLD_SIZE);
+			assertSame(old.ema, grown.ema, OLD_SIZE);
+			assertSame(old.stdDev, grown.stdDev, OLD_SIZE);
+			// the bars indicators are calculated again, on the new bars id
+			Assert::IsFalse(&old.atr.getSeries() == &grown.atr.getSeries());
+			assertSame(old.atr, grown.atr, OLD_SIZE);
+
+			// the same bars loaded again have the same bars id, so they get the
+			// cached bars indicators
+			oldBars = makeBars("IndicatorExtensionTests", "GROWN", closes, NEW_SIZE);
+			const Indicators again(bars(oldBars));
+			Assert::IsTrue(&grown.atr.getSeries() == &again.atr.getSeries());
+			assertSame(scratch, again);
+		}
+
+		// bars with a changed bar don't extend the previous bars, so none of the
+		// indicators calculated on those are reused
+		TEST_METHOD(ChangedHistoryIsNotExtended) {
+			const std::vector<double> closes = makeCloses(NEW_SIZE);
+			std::vector<double> changed = closes;
+			changed[OLD_SIZE / 2] += 10;
+
+			BarsPtr oldBars = makeBars("IndicatorExtensionTests", "CHANGED", closes, OLD_SIZE);
+			const Indicators old(bars(oldBars));
+			oldBars.reset();
+
+			const BarsPtr changedBars = makeBars("IndicatorExtensionTests", "CHANGED", changed, NEW_SIZE);
+			const Indicators extended(bars(changedBars));
+			const BarsPtr scratchBars = makeBars("Scratch", "CHANGED", changed, NEW_SIZE);
+			const Indicators scratch(bars(scratchBars));
+
+			assertSame(scratch, extended);
+			Assert::IsFalse(same(old.sma.getSeries()[OLD_SIZE / 2], extended.sma.getSeries()[OLD_SIZE / 2]));
+			Assert::IsFalse(same(old.ema.getSeries()[OLD_SIZE / 2], extended.ema.getSeries()[OLD_SIZE / 2]));
+
+			// the same size, with the last bar changed
+			changed = closes;
+			changed[OLD_SIZE - 1] += 10;
+			oldBars = makeBars("IndicatorExtensionTests", "LAST", closes, OLD_SIZE);
+			const Indicators cached(bars(oldBars));
+			oldBars.reset();
+
+			const BarsPtr lastBars = makeBars("IndicatorExtensionTests", "LAST", changed, OLD_SIZE);
+			const BarsPtr lastScratchBars = makeBars("Scratch", "LAST", changed, OLD_SIZE);
+			assertSame(Indicators(bars(lastScratchBars)), Indicators(bars(lastBars)));
+		}
+	};
+}
@@ -0,0 +1,128 @@
+/*
+	 Copyright (C) 2018-2020 Adrian Michel
+
+	 Licensed under the Apache License, Version 2.0 (the "License");
+	 you may not use this file except in compliance with the License.
+	 You may obtain a copy of the License at
+
+			 http://www.apache.org/licenses/LICENSE-2.0
+
+	 Unless required by applicable law or agreed to in writing, software
+	 distributed under the License is distributed on an "AS IS" BASIS,
+	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	 See the License for the specific language governing permissions and
+	 limitations under the License.
+*/
+
+#include "pch.h"
+#include <CppUnitTest.h>
+#include <panel.h>
+#include <datasource.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace tradery;
+
+namespace PanelTests {
+	// daily bars on days since 1970-01-01, with the close the day + base and the
+	// volume the day * 100
+	BarsPtr makeBars(const std::string& symbol, const std::vector<int>& days, double base) {
+		BarsPtr bars = createBars("PanelTests", symbol, BarsAbstr::Type::stock, 24 * 3600, DateTimeRangePtr(), fatal);
+		for (int day : days) {
+			bars->add(Bar(DateTime(Date::fromDays(day)), base + day, base + day, base + day, base + day, day * 100));
+		}
+		return bars;
+	}
+
+	Bars bars(const BarsPtr& bars) {
+		const BarsAbstr* abstr = dynamic_cast<const BarsAbstr*>(bars.get());
+		Assert::IsNotNull(abstr);
+		return Bars(abstr);
+	}
+
+	bool contains(const std::vector<int>& days, int day) {
+		return std::find(days.begin(), days.end(), day) != days.end();
+	}
+
+	TEST_CLASS(PanelTests) {
+		TEST_METHOD_INITIALIZE(Init) {
+			tradery::init(100);
+		}
+
+		TEST_METHOD_CLEANUP(Uninit) {
+			tradery::uninit();
+		}
+
+		// a symbol is valid only at the master dates it has a bar for: missing
+		// dates are invalid, extra dates are dropped, and a symbol without bars is
+		// never valid
+		TEST_METHOD(AlignsToMasterCalendar) {
+			const std::vector<int> masterDays{ 10, 11, 12, 14, 15, 17, 18, 19 };
+			const std::vector<int> missingDays{ 10, 11, 14, 17, 19 };
+			const std::vector<int> extraDays{ 5, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21 };
+
+			const BarsPtr master = makeBars("MASTER", masterDays, 0);
+			const BarsPtr missing = makeBars("MISSING", missingDays, 1000);
+			const BarsPtr extra = makeBars("EXTRA", extraDays, 2000);
+			const BarsPtr empty = makeBars("EMPTY", {}, 0);
+			const std::vector<std::string> symbols{ "MISSING", "EXTRA", "EMPTY" };
+
+			const Panel::PanelPtr panel = Panel::create(bars(master), symbols, { bars(missing), bars(extra), bars(empty) });
+
+			Assert::AreEqual(masterDays.size(), panel->dates());
+			Assert::AreEqual(symbols.size(), panel->symbols());
+			for (size_t n = 0; n < symbols.size(); ++n) {
+				Assert::IsTrue(symbols[n] == panel->symbol(n));
+			}
+
+			const TimeSeries timeSeries = panel->timeSeries();
+			for (size_t date = 0; date < panel->dates(); ++date) {
+				const int day = masterDays[date];
+				Assert::IsTrue(timeSeries[date] == DateTime(Date::fromDays(day)));
+
+				const bool missingValid = contains(missingDays, day);
+				Assert::AreEqual(missingValid, panel->isValid(date, 0));
+				if (missingValid) {
+					Assert::AreEqual(1000.0 + day, panel->close(date, 0));
+					Assert::AreEqual(day * 100.0, panel->volume(date, 0));
+				}
+				else {
+					Assert::IsTrue(std::isnan(panel->close(date, 0)));
+					Assert::IsTrue(std::isnan(panel->volume(date, 0)));
+				}
+
+				Assert::IsTrue(panel->isValid(date, 1));
+				Assert::AreEqual(2000.0 + day, panel->close(date, 1));
+
+				Assert::IsFalse(panel->isValid(date, 2));
+				Assert::IsTrue(std::isnan(panel->close(date, 2)));
+
+				const unsigned char* valid = panel->valid(date);
+				Assert::AreEqual((size_t)std::count_if(valid, valid + panel->symbols(), [](unsigned char v) { return v != 0; }), panel->validCount(date));
+				Assert::AreEqual((size_t)(missingValid ? 2 : 1), panel->validCount(date));
+			}
+		}
+
+		// the same master and symbol bars get the cached panel, different ones a
+		// new panel
+		TEST_METHOD(ReusesCachedPanel) {
+			const BarsPtr master = makeBars("MASTER", { 1, 2, 3, 4 }, 0);
+			const BarsPtr a = makeBars("A", { 1, 2, 4 }, 100);
+			const BarsPtr b = makeBars("B", { 2, 3 }, 200);
+
+			const Panel::PanelPtr panel = Panel::create(bars(master), { "A", "B" }, { bars(a), bars(b) });
+			Assert::IsTrue(panel == Panel::create(bars(master), { "A", "B" }, { bars(a), bars(b) }));
+
+			const Panel::PanelPtr swapped = Panel::create(bars(master), { "B", "A" }, { bars(b), bars(a) });
+			Assert::IsFalse(panel == swapped);
+			Assert::AreEqual(200.0 + 2, swapped->close(1, 0));
+
+			const BarsPtr c = makeBars("A", { 1, 2, 3, 4 }, 300);
+			const Panel::PanelPtr other = Panel::create(bars(master), { "A", "B" }, { bars(c), bars(b) });
+			Assert::IsFalse(panel == other);
+			Assert::AreEqual((size_t)2, other->validCount(2));
+			Assert::AreEqual((size_t)1, panel->validCount(2));
+		}
+	};
+}
@@ -0,0 +1,196 @@
+/*
+	 Copyright (C) 2018-2020 Adrian Michel
+
+	 Licensed under the Apache License, Version 2.0 (the "License");
+	 you may not use this file except in compliance with the License.
+	 You may obtain a copy of the License at
+
+			 http://www.apache.org/licenses/LICENSE-2.0
+
+	 Unless required by applicable law or agreed to in writing, software
+	 distributed under the License is distributed on an "AS IS" BASIS,
+	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	 See the License for the specific language governing permissions and
+	 limitations under the License.
+*/
+
+#include "pch.h"
+#include <CppUnitTest.h>
+#include <cstring>
+#include "TestDataPath.h"
+#include "..\fileplugins\DataSource.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace tradery;
+using BinaryOp = tradery::kernels::BinaryOp;
+
+namespace SeriesExpressionTests {
+	// the eager operators of SeriesImpl calculate each operation into its own
+	// series, the expressions calculate a whole expression in one pass
+	SeriesAbstrPtr lazy(BinaryOp op, SeriesAbstrPtr series1, SeriesAbstrPtr series2) {
+		return makeSeriesExpression(op, series1, series2);
+	}
+
+	SeriesAbstrPtr lazy(BinaryOp op, SeriesAbstrPtr series, double value) {
+		return makeSeriesExpression(op, series, value);
+	}
+
+	SeriesAbstrPtr lazy(BinaryOp op, double value, SeriesAbstrPtr series) {
+		return makeSeriesExpression(op, value, series);
+	}
+
+	SeriesAbstrPtr eager(BinaryOp op, SeriesAbstrPtr series1, SeriesAbstrPtr series2) {
+		switch (op) {
+			case BinaryOp::add:
+				return series1->add(series2);
+			case BinaryOp::subtract:
+				return series1->subtract(series2);
+			case BinaryOp::multiply:
+				return series1->multiply(series2);
+			default:
+				return series1->divide(series2);
+		}
+	}
+
+	SeriesAbstrPtr eager(BinaryOp op, SeriesAbstrPtr series, double value) {
+		switch (op) {
+			case BinaryOp::add:
+				return series->add(value);
+			case BinaryOp::subtract:
+				return series->subtract(value);
+			case BinaryOp::multiply:
+				return series->multiply(value);
+			default:
+				return series->divide(value);
+		}
+	}
+
+	SeriesAbstrPtr eager(BinaryOp op, double value, SeriesAbstrPtr series) {
+		switch (op) {
+			case BinaryOp::add:
+				return series->add(value);
+			case BinaryOp::subtract:
+				return series->subtractFrom(value);
+			case BinaryOp::multiply:
+				return series->multiply(value);
+			default:
+				return series->divideBy(value);
+		}
+	}
+
+	const BinaryOp ops[] = { BinaryOp::add, BinaryOp::subtract, BinaryOp::multiply, BinaryOp::divide };
+
+	// odd size, so the expressions also go through a partial block. Some values
+	// are 0, NaN or infinite
+	SeriesAbstrPtr makeSeries(size_t size, unsigned int seed, Synchronizer::SynchronizerPtr synchronizer = Synchronizer::SynchronizerPtr()) {
+		const double special[] = { 0.0, -0.0, std::numeric_limits< double >::quiet_NaN(), std::numeric_limits< double >::infinity() };
+
+		SeriesAbstrPtr series = SeriesAbstr::create(size);
+		for (size_t n = 0; n < size; ++n) {
+			seed = seed * 1103515245 + 12345;
+			series->setValue(n, seed % 7 == 0 ? special[(seed >> 8) % 4] : (double)(seed >> 8) / 1000.0 - 5000.0);
+		}
+		if (synchronizer) {
+			series->synchronize(synchronizer);
+		}
+		return series;
+	}
+
+	bool same(double a, double b) {
+		return std::memcmp(&a, &b, sizeof(double)) == 0 || (a != a && b != b);
+	}
+
+	void assertSame(const SeriesAbstrPtr& expected, const SeriesAbstrPtr& actual) {
+		Assert::AreEqual(expected->isSynchronized(), actual->isSynchronized());
+		Assert::AreEqual(expected->size(), actual->size());
+		Assert::AreEqual(expected->unsyncSize(), actual->unsyncSize());
+		for (size_t n = 0; n < expected->size(); ++n) {
+			Assert::IsTrue(same((*expected)[n], (*actual)[n]));
+		}
+	}
+
+	TEST_CLASS(SeriesExpressionTests) {
+		TEST_METHOD_INITIALIZE(Init) {
+			tradery::init(100);
+		}
+
+		TEST_METHOD_CLEANUP(Uninit) {
+			tradery::uninit();
+		}
+
+		// each operation, on two series, a series and a value and a value and a
+		// series, and a nested expression, evaluated in one pass
+		TEST_METHOD(MixedOperands) {
+			const size_t size = 1037;
+			const SeriesAbstrPtr a = makeSeries(size, 1);
+			const SeriesAbstrPtr b = makeSeries(size, 2);
+			const SeriesAbstrPtr c = makeSeries(size, 3);
+
+			for (BinaryOp op : ops) {
+				assertSame(eager(op, a, b), lazy(op, a, b));
+				assertSame(eager(op, a, 2.5), lazy(op, a, 2.5));
+				assertSame(eager(op, -3.0, a), lazy(op, -3.0, a));
+			}
+
+			// ((a + b) * (c - 2.5)) / (4 - a)
+			const SeriesAbstrPtr expected = eager(BinaryOp::divide, eager(BinaryOp::multiply, eager(BinaryOp::add, a, b), eager(BinaryOp::subtract, c, 2.5)), eager(BinaryOp::subtract, 4.0, a));
+			const SeriesAbstrPtr fused = lazy(BinaryOp::divide, lazy(BinaryOp::multiply, lazy(BinaryOp::add, a, b), lazy(BinaryOp::subtract, c, 2.5)), lazy(BinaryOp::subtract, 4.0, a));
+			assertSame(expected, fused);
+
+			// an expression used as an operand after it has been calculated
+			assertSame(eager(BinaryOp::add, expected, c), lazy(BinaryOp::add, fused, c));
+		}
+
+		// operands synchronized to the same bars make a synchronized series, a
+		// synchronized and an unsynchronized operand an unsynchronized one
+		TEST_METHOD(SynchronizedOperands) {
+			std::unique_ptr<FileDataSource> dataSource(FileDataSource::make(Info("test", ""), TestDataPath{}.makePath("data"), ".csv", format3, false, fatal));
+			const DataInfo symbol(dataSource.get(), std::make_shared<Symbol>("AA"));
+			const DataInfo ref(dataSource.get(), std::make_shared<Symbol>("AAPL"));
+
+			const BarsPtr refData = getDataRequester()->getData(&ref, 0);
+			const BarsPtr data = getDataRequester()->getData(&symbol, 0);
+			BarsAbstr* bars = dynamic_cast<BarsAbstr*>(data.get());
+			Assert::IsNotNull(bars);
+			bars->synchronize(Bars(dynamic_cast<const BarsAbstr*>(refData.get())));
+
+			const Synchronizer::SynchronizerPtr synchronizer = bars->closeSeries().getSeries().synchronizer();
+			Assert::IsTrue((bool)synchronizer);
+			const size_t unsyncSize = bars->closeSeries().getSeries().unsyncSize();
+
+			const SeriesAbstrPtr a = makeSeries(unsyncSize, 4, synchronizer);
+			const SeriesAbstrPtr b = makeSeries(unsyncSize, 5, synchronizer);
+			// unsynchronized, with the synchronized size
+			const SeriesAbstrPtr u = makeSeries(a->size(), 6);
+
+			for (BinaryOp op : ops) {
+				const SeriesAbstrPtr synchronized = lazy(op, a, b);
+				Assert::IsTrue(synchronized->isSynchronized());
+				assertSame(eager(op, a, b), synchronized);
+				assertSame(eager(op, a, 1.5), lazy(op, a, 1.5));
+				assertSame(eager(op, 1.5, a), lazy(op, 1.5, a));
+
+				const SeriesAbstrPtr mixed = lazy(op, a, u);
+				Assert::IsFalse(mixed->isSynchronized());
+				assertSame(eager(op, a, u), mixed);
+				assertSame(eager(op, u, a), lazy(op, u, a));
+			}
+
+			// (a - b) * 0.5 + u
+			assertSame(eager(BinaryOp::add, eager(BinaryOp::multiply, eager(BinaryOp::subtract, a, b), 0.5), u),
+				lazy(BinaryOp::add, lazy(BinaryOp::multiply, lazy(BinaryOp::subtract, a, b), 0.5), u));
+		}
+
+		// operands of different lengths are rejected by both
+		TEST_METHOD(DifferentLengths) {
+			const SeriesAbstrPtr a = makeSeries(100, 7);
+			const SeriesAbstrPtr b = makeSeries(101, 8);
+
+			for (BinaryOp op : ops) {
+				Assert::ExpectException<OperationOnUnequalSizeSeriesException>([&]() { eager(op, a, b); });
+				Assert::ExpectException<OperationOnUnequalSizeSeriesException>([&]() { lazy(op, a, b); });
+				Assert::ExpectException<OperationOnUnequalSizeSeriesException>([&]() { lazy(op, lazy(op, a, 2.0), b); });
+			}
+		}
+	};
+}
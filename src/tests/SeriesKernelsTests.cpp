@@ -0,0 +1,113 @@
+/*
+	 Copyright (C) 2018-2020 Adrian Michel
+
+	 Licensed under the Apache License, Version 2.0 (the "License");
+	 you may not use this file except in compliance with the License.
+	 You may obtain a copy of the License at
+
+			 http://www.apache.org/licenses/LICENSE-2.0
+
+	 Unless required by applicable law or agreed to in writing, software
+	 distributed under the License is distributed on an "AS IS" BASIS,
+	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	 See the License for the specific language governing permissions and
+	 limitations under the License.
+*/
+
+#include "pch.h"
+#include <CppUnitTest.h>
+#include <serieskernels.h>
+#include <cstring>
+#include <limits>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace tradery::kernels;
+
+namespace SeriesKernelsTests {
+	const BinaryOp ops[] = { BinaryOp::add, BinaryOp::subtract, BinaryOp::multiply, BinaryOp::divide,
+		BinaryOp::min, BinaryOp::max, BinaryOp::less, BinaryOp::greater, BinaryOp::lessEqual,
+		BinaryOp::greaterEqual, BinaryOp::equal, BinaryOp::notEqual };
+
+	const Isa isas[] = { Isa::scalar, Isa::sse2, Isa::avx2, Isa::avx512 };
+
+	// odd size, so all kernels also go through the remainder loop
+	std::vector< double > values(size_t size, unsigned int seed) {
+		const double special[] = { 0.0, -0.0, 1.0, -1.0, std::numeric_limits< double >::quiet_NaN(),
+			std::numeric_limits< double >::infinity(), -std::numeric_limits< double >::infinity(), 1e-310 };
+
+		std::vector< double > v(size);
+		for (size_t n = 0; n < size; ++n) {
+			seed = seed * 1103515245 + 12345;
+			v[n] = seed % 5 == 0 ? special[(seed >> 8) % 8] : (double)(seed >> 8) / 1000.0 - 5000.0;
+		}
+		return v;
+	}
+
+	bool same(double a, double b) {
+		return std::memcmp(&a, &b, sizeof(double)) == 0 || (a != a && b != b);
+	}
+
+	TEST_CLASS(SeriesKernelsTests) {
+		TEST_METHOD_CLEANUP(Cleanup) {
+			setIsa(supportedIsa());
+		}
+
+		TEST_METHOD(BinaryMatchesScalar) {
+			const size_t size = 1037;
+			std::vector< double > a = values(size, 1);
+			std::vector< double > b = values(size, 2);
+			std::vector< double > out(size);
+
+			for (Isa i : isas) {
+				if (setIsa(i) != i) {
+					continue;
+				}
+				for (BinaryOp op : ops) {
+					binary(op, a.data(), b.data(), out.data(), size);
+					for (size_t n = 0; n < size; ++n) {
+						Assert::IsTrue(same(apply(op, a[n], b[n]), out[n]), isaName(i));
+					}
+
+					binary(op, a.data(), 3.5, out.data(), size);
+					for (size_t n = 0; n < size; ++n) {
+						Assert::IsTrue(same(apply(op, a[n], 3.5), out[n]), isaName(i));
+					}
+
+					binary(op, -2.0, a.data(), out.data(), size);
+					for (size_t n = 0; n < size; ++n) {
+						Assert::IsTrue(same(apply(op, -2.0, a[n]), out[n]), isaName(i));
+					}
+				}
+			}
+		}
+
+		TEST_METHOD(InPlace) {
+			const size_t size = 101;
+			std::vector< double > a = values(size, 3);
+			std::vector< double > b = values(size, 4);
+
+			for (Isa i : isas) {
+				if (setIsa(i) != i) {
+					continue;
+				}
+				std::vector< double > out(a);
+				binary(BinaryOp::subtract, out.data(), b.data(), out.data(), size);
+				for (size_t n = 0; n < size; ++n) {
+					Assert::IsTrue(same(a[n] - b[n], out[n]), isaName(i));
+				}
+
+				out = a;
+				abs(out.data(), out.data(), size);
+				for (size_t n = 0; n < size; ++n) {
+					Assert::IsTrue(same(std::fabs(a[n]), out[n]), isaName(i));
+				}
+			}
+		}
+
+		TEST_METHOD(SetIsaFallsBack) {
+			Assert::IsTrue(setIsa(Isa::avx512) <= supportedIsa());
+			Assert::IsTrue(setIsa(Isa::scalar) == Isa::scalar);
+			Assert::IsTrue(isa() == Isa::scalar);
+		}
+	};
+}
@@ -0,0 +1,107 @@
+/*
+	 Copyright (C) 2018-2020 Adrian Michel
+
+	 Licensed under the Apache License, Version 2.0 (the "License");
+	 you may not use this file except in compliance with the License.
+	 You may obtain a copy of the License at
+
+			 http://www.apache.org/licenses/LICENSE-2.0
+
+	 Unless required by applicable law or agreed to in writing, software
+	 distributed under the License is distributed on an "AS IS" BASIS,
+	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	 See the License for the specific language governing permissions and
+	 limitations under the License.
+*/
+
+#include "pch.h"
+#include <CppUnitTest.h>
+#include <datasource.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace tradery;
+
+namespace SeriesViewTests {
+	// daily bars on days since 1970-01-01, with the close 100 + the day
+	BarsPtr makeBars(const std::string& symbol, const std::vector<int>& days) {
+		BarsPtr bars = createBars("SeriesViewTests", symbol, BarsAbstr::Type::stock, 24 * 3600, DateTimeRangePtr(), fatal);
+		for (int day : days) {
+			bars->add(Bar(DateTime(Date::fromDays(day)), 100.0 + day, 100.0 + day, 100.0 + day, 100.0 + day, 1000));
+		}
+		return bars;
+	}
+
+	TEST_CLASS(SeriesViewTests) {
+		TEST_METHOD_INITIALIZE(Init) {
+			tradery::init(100);
+		}
+
+		TEST_METHOD_CLEANUP(Uninit) {
+			tradery::uninit();
+		}
+
+		TEST_METHOD(SameValuesAsSeries) {
+			Series series(100);
+			for (size_t n = 0; n < series.size(); ++n) {
+				series.setValue(n, n * 1.5 - 20);
+			}
+
+			const SeriesView view = series.view();
+			Assert::AreEqual(series.size(), view.size());
+			Assert::IsFalse(view.isSynchronized());
+			for (size_t n = 0; n < view.size(); ++n) {
+				Assert::AreEqual(series[n], view[n]);
+				Assert::AreEqual(series[n], view.at(n));
+			}
+		}
+
+		// the values of a view of a synchronized series are those of the bars the
+		// synchronizer maps each reference bar to: the bar with the same date, or
+		// the last one before it, or the first one if there is none before it
+		TEST_METHOD(SynchronizedValuesAsSeries) {
+			const BarsPtr ref = makeBars("REF", { 0, 2, 3, 4, 6, 7, 9, 10 });
+			const BarsPtr synced = makeBars("SYNCED", { 1, 3, 4, 5, 7, 8, 11 });
+			const std::vector<double> expected{ 101, 101, 103, 104, 105, 107, 108, 108 };
+
+			BarsAbstr* bars = dynamic_cast<BarsAbstr*>(synced.get());
+			Assert::IsNotNull(bars);
+			bars->synchronize(Bars(dynamic_cast<const BarsAbstr*>(ref.get())));
+
+			const Series close = bars->closeSeries();
+			Assert::IsTrue(close.isSynchronized());
+			const SeriesView view = close.view();
+			Assert::IsTrue(view.isSynchronized());
+			Assert::IsNotNull(view.indexes());
+			Assert::AreEqual(expected.size(), view.size());
+			Assert::AreEqual(close.size(), view.size());
+			for (size_t n = 0; n < view.size(); ++n) {
+				Assert::AreEqual(expected[n], view[n]);
+				Assert::AreEqual(expected[n], view.at(n));
+				Assert::AreEqual(close[n], view[n]);
+				Assert::AreEqual(view.data()[view.indexes()[n]], view[n]);
+			}
+			Assert::ExpectException< SeriesIndexOutOfRangeException >([&view]() { view.at(view.size()); });
+
+			// the indicators on a synchronized series are synchronized too
+			const Series sma = close.SMA(2);
+			const SeriesView smaView = sma.view();
+			Assert::IsTrue(smaView.isSynchronized());
+			Assert::AreEqual(sma.size(), smaView.size());
+			for (size_t n = 0; n < smaView.size(); ++n) {
+				Assert::AreEqual(sma[n], smaView[n]);
+			}
+		}
+
+		TEST_METHOD(AtChecksIndex) {
+			Series series(10);
+			const SeriesView view = series.view();
+			Assert::ExpectException< SeriesIndexOutOfRangeException >([&view]() { view.at(10); });
+		}
+
+		TEST_METHOD(Empty) {
+			const SeriesView view;
+			Assert::AreEqual((size_t)0, view.size());
+			Assert::ExpectException< SeriesIndexOutOfRangeException >([&view]() { view.at(0); });
+		}
+	};
+}
@@ -0,0 +1,167 @@
+/*
+	 Copyright (C) 2018-2020 Adrian Michel
+
+	 Licensed under the Apache License, Version 2.0 (the "License");
+	 you may not use this file except in compliance with the License.
+	 You may obtain a copy of the License at
+
+			 http://www.apache.org/licenses/LICENSE-2.0
+
+	 Unless required by applicable law or agreed to in writing, software
+	 distributed under the License is distributed on an "AS IS" BASIS,
+	 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+	 See the License for the specific language governing permissions and
+	 limitations under the License.
+*/
+
+#include "pch.h"
+#include <CppUnitTest.h>
+#include <deque>
+#include <mutex>
+#include <system.h>
+#include "TestDataPath.h"
+#include "..\fileplugins\DataSource.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace tradery;
+
+namespace SymbolMajorTests {
+	class Symbols : public DataInfoIterator {
+	private:
+		std::mutex _mutex;
+		std::deque<DataInfoConstPtr> _symbols;
+
+	public:
+		Symbols(DataSource* dataSource, const std::vector<std::string>& symbols) {
+			for (const std::string& symbol : symbols) {
+				_symbols.push_back(std::make_shared<DataInfo>(dataSource, std::make_shared<Symbol>(symbol)));
+			}
+		}
+
+		DataInfoConstPtr getNext() override {
+			std::scoped_lock lock(_mutex);
+			if (_symbols.empty()) {
+				return DataInfoConstPtr();
+			}
+			DataInfoConstPtr next = _symbols.front();
+			_symbols.pop_front();
+			return next;
+		}
+	};
+
+	class Errors : public ErrorEventSink {
+	private:
+		mutable std::mutex _mutex;
+		std::deque<ErrorEventPtr> _events;
+
+	public:
+		void push(const ErrorEventPtr event) override {
+			std::scoped_lock lock(_mutex);
+			_events.push_front(event);
+		}
+		void pop() override {
+			std::scoped_lock lock(_mutex);
+			_events.pop_front();
+		}
+		ErrorEventPtr front() const override {
+			std::scoped_lock lock(_mutex);
+			return _events.empty() ? ErrorEventPtr() : _events.front();
+		}
+		bool empty() const override {
+			std::scoped_lock lock(_mutex);
+			return _events.empty();
+		}
+		size_t size() const override {
+			std::scoped_lock lock(_mutex);
+			return _events.size();
+		}
+	};
+
+	// synchronizes its default bars to the reference bars
+	class SyncSystem : public BarSystem<SyncSystem> {
+	private:
+		DataInfo _ref;
+		BarsPtr _refBars;
+
+	public:
+		SyncSystem(const DataInfo& ref) : BarSystem<SyncSystem>(Info("sync", "")), _ref(ref) {}
+
+		bool init(const std::string& symbol) override { return true; }
+
+		void run() override {
+			_refBars = getDataRequester()->getData(&_ref, 0);
+			synchronize(Bars(dynamic_cast<const BarsAbstr*>(_refBars.get())));
+		}
+	};
+
+	// what CheckSystem saw on its default bars, shared by its instances
+	struct Seen {
+		std::mutex mutex;
+		bool synchronized = false;
+		std::vector<double> closes;
+	};
+
+	class CheckSystem : public BarSystem<CheckSystem> {
+	private:
+		std::shared_ptr<Seen> _seen;
+
+	public:
+		CheckSystem(std::shared_ptr<Seen> seen) : BarSystem<CheckSystem>(Info("check", "")), _seen(seen) {}
+
+		bool init(const std::string& symbol) override { return true; }
+
+		void run() override {
+			std::scoped_lock lock(_seen->mutex);
+			_seen->synchronized = bars().isSynchronized();
+			for (size_t n = 0; n < bars().size(); ++n) {
+				_seen->closes.push_back(bars().close(n));
+			}
+		}
+	};
+
+	TEST_CLASS(SymbolMajorTests) {
+		TEST_METHOD_INITIALIZE(Init) {
+			tradery::init(100);
+		}
+
+		TEST_METHOD_CLEANUP(Uninit) {
+			tradery::uninit();
+		}
+
+		// a system that synchronizes its bars doesn't change the bars of the
+		// systems run after it on the same symbol
+		TEST_METHOD(SystemsGetTheirOwnBars) {
+			std::unique_ptr<FileDataSource> dataSource(FileDataSource::make(Info("test", ""), TestDataPath{}.makePath("data"), ".csv", format3, false, fatal));
+			const DataInfo symbol(dataSource.get(), std::make_shared<Symbol>("AA"));
+			const DataInfo ref(dataSource.get(), std::make_shared<Symbol>("AAPL"));
+
+			Errors errors;
+			chart::ChartManager charts;
+			PositionsVector syncPositions;
+			PositionsVector checkPositions;
+			SyncSystem sync(ref);
+			std::shared_ptr<Seen> seen = std::make_shared<Seen>();
+			CheckSystem check(seen);
+
+			{
+				Session session;
+				session.setSymbolMajor(true);
+				// the systems run on a symbol in the order they are added
+				session.addRunnable(&sync, syncPositions, &errors, std::make_shared<Symbols>(dataSource.get(), std::vector<std::string>{ "AA" }), static_cast<SignalHandler*>(0), 0, 0, 0, &charts);
+				session.addRunnable(&check, checkPositions, &errors, std::make_shared<Symbols>(dataSource.get(), std::vector<std::string>{ "AA" }), static_cast<SignalHandler*>(0), 0, 0, 0, &charts);
+				session.run(false, 1, false, DateTimeRangePtr(), NegInfinityDateTime());
+			}
+			Assert::IsTrue(errors.empty());
+
+			const BarsPtr data = getDataRequester()->getData(&symbol, 0);
+			const BarsAbstr* bars = dynamic_cast<const BarsAbstr*>(data.get());
+			Assert::IsNotNull(bars);
+
+			Assert::IsFalse(seen->synchronized);
+			Assert::AreEqual(bars->size(), seen->closes.size());
+			for (size_t n = 0; n < bars->size(); ++n) {
+				Assert::AreEqual(bars->close(n), seen->closes[n]);
+			}
+		}
+	};
+}
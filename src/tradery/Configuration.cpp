@@ -85,7 +85,8 @@ constexpr char* TO_DATETIME[] = { "todatetime,T", "time range ending date/time i
 constexpr char* REVERSEHEARTBEATFILE[] = { "reverseheartbeatfile,V", "file generated with a certain period, that indicates that the process is still running. If the file is not generated for a speicified amount of time, the client can assume that the server process is not running any more" };
 constexpr char* DEFSLIPPAGEID[] = { "defslippageid,W", "the default slippage plugin config id" };
 constexpr char* DEFCOMMISSIONID[] = { "defcommissionid,X", "the default commission plugin config id" };
-constexpr char* CACHESIZE[] = { "cachesize,Y", "the internal simlib cache max number of items, currently used only because symbol info is needed to calculate stats" };
+constexpr char* CACHESIZE[] = { "cachesize,Y", "the memory budget in MB of each of the internal data and series caches. Cached items are evicted based on size, cost to calculate and frequency of use" };
+constexpr char* SERIES_CACHE[] = { "seriescache", "cache the indicator series, so the systems running on the same data share them. The batch indicator calculations and the extension of the indicators of shorter data work through this cache" };
 constexpr char* RAW_TRADES_CSV_FILE[] = { "rawtradescsvfile,Z", "the list of raw trades before applying position sizing" };
 //Z
 
@@ -112,11 +113,16 @@ constexpr char* CLASS_NAME_KEYWORD[] = { "classnamekword", "The class name keywo
 constexpr char* CPU_COUNT[] = { "cpucount", "number of cpus" };
 constexpr char* THREADS[] = { "threads", "number of threads" };
 constexpr char* THREAD_ALG[] = { "threadalg", "threading algorithm" };
+constexpr char* PREFETCH_DEPTH[] = { "prefetch", "number of symbols whose data is loaded ahead of the systems, 0 to load the data in the system threads" };
+constexpr char* PREFETCH_THREADS[] = { "prefetchthreads", "number of threads loading data ahead of the systems" };
+constexpr char* SYMBOL_MAJOR[] = { "symbolmajor", "run all the systems on each symbol before moving to the next symbol" };
+constexpr char* RUN_PROFILE[] = { "runprofile", "file keeping how long each system took on each symbol, used to run the longest symbols first" };
 
 constexpr char* EXT_TRIGGERS_FILE[] = { "exttriggersfile", "if this option is present, this will be interpreted as a file containing a list of triggers that the simulator will use to generate trades" };
 
 constexpr char* EXPLICIT_TRADES_EXT[] = { "explicittradesext", "Explicit trades files extension" };
 constexpr char* DATA_ERROR_HANDLING_MODE[] = { "dataerrorhandling", "Data error handling mode - 0: fatal, 1: warning, 2: ignore" };
+constexpr char* DATA_PARSER_MODE[] = { "dataparser", "Data file parser - mapped: the files are mapped in memory and parsed in place, stream: the files are read line by line" };
 
 constexpr char* START_TRADES_DATE[] = { "starttradesdate", "cutoff date for trades (no trades before this date, used for automated trading)" };
 
@@ -246,6 +252,7 @@ po::options_description makeOptionsDescription(){
     PO_STR(DEFSLIPPAGEID)
     PO_STR(DEFCOMMISSIONID)
     PO_DEF(CACHESIZE, DEFAULT_CACHE_SIZE, unsigned __int64)
+    PO_DEF(SERIES_CACHE, DEFAULT_SERIES_CACHE, bool)
     PO_DEF(MAX_LINES, DEFAULT_MAX_LINES_PER_FILE, unsigned __int64)
     PO_DEF(MAX_TOTAL_BAR_COUNT, DEFAULT_MAX_BARS_PER_SESSION, unsigned __int64)
     PO_DEF(FLAT_DATA, DEFAULT_FLAT_DATA, bool)
@@ -265,9 +272,14 @@ po::options_description makeOptionsDescription(){
     PO_DEF(CPU_COUNT, DEFAULT_CPU_COUNT, unsigned long)
     PO_DEF(THREADS, DEFAULT_THREAD_COUNT, unsigned long)
     PO_DEF(THREAD_ALG, DEFAULT_THREADING_ALGORITHM, unsigned long)
+    PO_DEF(PREFETCH_DEPTH, DEFAULT_PREFETCH_DEPTH, unsigned int)
+    PO_DEF(PREFETCH_THREADS, DEFAULT_PREFETCH_THREADS, unsigned int)
+    PO_DEF(SYMBOL_MAJOR, DEFAULT_SYMBOL_MAJOR, bool)
+    PO_STR(RUN_PROFILE)
     PO_STR(EXT_TRIGGERS_FILE)
     PO_DEF(EXPLICIT_TRADES_EXT, DEFAULT_EXPLICIT_TRADES_EXT, std::string)
     PO_DEF(DATA_ERROR_HANDLING_MODE, DEFAULT_DATA_ERROR_HANDLING_MODE, unsigned int)
+    PO_DEF(DATA_PARSER_MODE, DEFAULT_DATA_PARSER_MODE, std::string)
     PO_DEF(START_TRADES_DATE, DEFAULT_START_TRADES_DATE, std::string)
     PO_STR(ENV_PATH)
     PO_STR(ENV_INCLUDE)
@@ -525,6 +537,8 @@ void Configuration::init(const std::string& cmdLine, bool validate) {
     m_runtimeStatsFile = vm[longName( RUNTIME_STATS_FILE)].as<std::string>();
     LOG(log_debug, "reading cache size");
     m_cacheSize = vm[longName( CACHESIZE )].as<unsigned __int64>();
+    LOG(log_debug, "reading series cache");
+    m_seriesCache = vm[longName( SERIES_CACHE )].as<bool>();
     LOG(log_debug, "reading default slippage value");
     m_defSlippageValue = vm[longName(DEFSLIPPAGEVALUE)].as<double>();
     LOG(log_debug, "reading default commission value");
@@ -559,10 +573,19 @@ void Configuration::init(const std::string& cmdLine, bool validate) {
     m_threads = vm[longName( THREADS )].as<unsigned long>();
     LOG(log_debug, "reading threading algorithm");
     m_threadAlg = ThreadAlgorithm(vm[longName( THREAD_ALG )].as<unsigned long>());
+    LOG(log_debug, "reading prefetch depth and threads");
+    m_prefetchDepth = vm[longName( PREFETCH_DEPTH )].as<unsigned int>();
+    m_prefetchThreads = vm[longName( PREFETCH_THREADS )].as<unsigned int>();
+    LOG(log_debug, "reading symbol major");
+    m_symbolMajor = vm[longName( SYMBOL_MAJOR )].as<bool>();
+    LOG(log_debug, "reading run profile");
+    if (vm.contains(longName( RUN_PROFILE ))) m_runProfileFile = vm[longName( RUN_PROFILE )].as<std::string>();
     LOG(log_debug, "reading explicit trades file extension");
     m_explicitTradesExt = vm[longName( EXPLICIT_TRADES_EXT )].as<std::string>();
     LOG(log_debug, "reading data error handling mode");
     m_dataErrorHandlingMode = (ErrorHandlingMode)vm[longName( DATA_ERROR_HANDLING_MODE )].as<unsigned int>();
+    LOG(log_debug, "reading data parser mode");
+    m_dataParserMode = vm[longName( DATA_PARSER_MODE )].as<std::string>();
     LOG(log_debug, "reading os path");
     if (vm.contains(longName( OS_PATH ))) m_osPath = vm[longName( OS_PATH )].as<std::string>();
     LOG(log_debug, "reading environment path");
@@ -123,6 +123,7 @@ class Configuration : private ConfigurationData {
   size_t reverseHeartBeatPeriod() const { return m_reverseHeartBeatPeriod; }
   size_t heartBeatTimeout() const { return m_heartBeatTimeout; }
   size_t cacheSize() const { return m_cacheSize; }
+  bool seriesCache() const { return m_seriesCache; }
   double defCommissionValue() const { return m_defCommissionValue; }
   double defSlippageValue() const { return m_defSlippageValue; }
   const std::string& defSlippageId() const { return m_defSlippageId; }
@@ -144,6 +145,10 @@ class Configuration : private ConfigurationData {
   unsigned long getCPUCount() const { return m_cpuCount; }
   unsigned long getThreads() const { return m_threads; }
   ThreadAlgorithm getThreadAlg() const { return m_threadAlg; }
+  unsigned int getPrefetchDepth() const { return m_prefetchDepth; }
+  unsigned int getPrefetchThreads() const { return m_prefetchThreads; }
+  bool getSymbolMajor() const { return m_symbolMajor; }
+  const std::string& getRunProfileFile() const { return m_runProfileFile; }
   virtual void setThreads(unsigned long threads) { m_threads = threads; }
   virtual void setRunSimulator(bool run = true) { m_runSimulator = true; }
   void setSessionPath(const std::string& sessionPath) { m_sessionParentPath = sessionPath; }
@@ -153,6 +158,7 @@ class Configuration : private ConfigurationData {
   ErrorHandlingMode dataErrorHandlingMode() const {
     return m_dataErrorHandlingMode;
   }
+  const std::string& dataParserMode() const { return m_dataParserMode; }
 
   const std::string& startTradesDateTime() const {
     return m_startTradesDateTime;
@@ -72,6 +72,7 @@ class ConfigurationData {
   PositionSizingParams m_posSizingParams;
 
   size_t m_cacheSize;
+  bool m_seriesCache;
 
   double m_defSlippageValue;
   double m_defCommissionValue;
@@ -101,8 +102,13 @@ class ConfigurationData {
   unsigned long m_cpuCount;
   unsigned long m_threads;
   ThreadAlgorithm m_threadAlg;
+  unsigned int m_prefetchDepth;
+  unsigned int m_prefetchThreads;
+  bool m_symbolMajor;
+  std::string m_runProfileFile;
   std::string m_explicitTradesExt;
   ErrorHandlingMode m_dataErrorHandlingMode;
+  std::string m_dataParserMode;
 
   std::string m_envPath;
   std::string m_envInclude;
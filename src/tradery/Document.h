@@ -86,6 +86,9 @@ public:
       _runtimeParams.setTradesEnabled(config.generateTrades());
       _runtimeParams.setThreads(config.getThreads());
       _runtimeParams.setThreadAlgorithm(config.getThreadAlg());
+      _runtimeParams.setPrefetch(config.getPrefetchDepth(), config.getPrefetchThreads());
+      _runtimeParams.setSymbolMajor(config.getSymbolMajor());
+      _runtimeParams.setRunProfile(config.getRunProfileFile());
 
       try {
         _runtimeParams.setRange(std::make_shared<DateTimeRange>(_from, _to));
@@ -111,6 +114,7 @@ public:
       _symbolsSourceStrings.push_back( config.symbolsSourceFile());
       _dataSourceStrings.push_back(config.dataSourcePath());
       _dataSourceStrings.push_back(errorHandlingModeAsString( (tradery::ErrorHandlingMode)config.dataErrorHandlingMode()));
+      _dataSourceStrings.push_back(config.dataParserMode());
       _slippageStrings.push_back(std::to_string(config.defSlippageValue()));
       _commissionStrings.push_back(std::to_string(config.defCommissionValue()));
 
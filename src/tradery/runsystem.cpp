@@ -89,7 +89,8 @@ class XRunnableRunInfoHandler : public RunnableRunInfoHandler {
       _runsCounter.incErrorRuns();
     }
     _count++;
-    LOG(log_debug, (status.errors() ? "!" : "+"), "[", status.threadName(), ":", status.cpuNumber(), "] ", status.status(), " on \"", status.symbol(), "\"");
+    LOG(log_debug, (status.errors() ? "!" : "+"), "[", status.threadName(), ":", status.cpuNumber(), "] ", status.status(), " on \"", status.symbol(), "\", data: ",
+        status.dataDuration(), "s (prefetch: ", status.prefetchDuration(), "s), run: ", status.runnableDuration(), "s");
     _runTimer.restart();
     _runsCounter.incTotalBarCount(status.dataUnitCount());
     _runsCounter.setMessage("Running \""s + status.status() + "\" on \"" + status.symbol() + "\"");
@@ -331,6 +332,7 @@ void RunSystem::run() {
       // save new stats every 1 seconds
       if (runtimeStatsTimer.elapsed() > 1) {
         runtimeStats.setRawTrades(session.runTradesCount());
+        runtimeStats.updateCacheStats();
         runtimeStats.outputStats();
         runtimeStatsTimer.restart();
       }
@@ -352,9 +354,11 @@ void RunSystem::run() {
     runtimeStats.setProcessedSignals(sh->processedSignalsCount());
     runtimeStats.setMessage("Session complete");
     runtimeStats.setStatus(RuntimeStatus::ENDED);
+    runtimeStats.updateCacheStats();
     runtimeStats.outputStats();
 
     LOG(log_info, m_config.getSessionId(), runtimeStats.to_json());
+    LOG(log_info, m_config.getSessionId(), "cache stats for the session:\n", runtimeStats.cacheStatsReport());
 
     saveTradesDescriptionFile(pos);
     saveTradesCSVFile(pos);
@@ -34,11 +34,40 @@ constexpr auto CURRENT_SYMBOL = "currentSymbol";
 constexpr auto PERCENTAGE_DONE = "percentageDone";
 constexpr auto SYSTEM_COUNT = "systemCount";
 constexpr auto MESSAGE = "message";
+constexpr auto SERIES_CACHE = "seriesCache";
+constexpr auto DATA_CACHE = "dataCache";
+
+constexpr auto CACHE_HITS = "hits";
+constexpr auto CACHE_MISSES = "misses";
+constexpr auto CACHE_INCONSISTENT = "inconsistent";
+constexpr auto CACHE_EVICTIONS = "evictions";
+constexpr auto CACHE_BYTES = "bytes";
+constexpr auto CACHE_MAKE_TIME = "makeTime";
 
 inline void to_json(nlohmann::json& j, const ::RuntimeStats& rs) {
   rs.to_json(j);
 }
 
+namespace tradery {
+inline void to_json(nlohmann::json& j, const CacheTypeStats& stats) {
+  j = nlohmann::json{{CACHE_HITS, stats.hits},
+                     {CACHE_MISSES, stats.misses},
+                     {CACHE_INCONSISTENT, stats.inconsistent},
+                     {CACHE_EVICTIONS, stats.evictions},
+                     {CACHE_BYTES, stats.bytes},
+                     {CACHE_MAKE_TIME, stats.makeTime}};
+}
+
+inline void from_json(const nlohmann::json& j, CacheTypeStats& stats) {
+  stats.hits = j[CACHE_HITS].get<unsigned __int64>();
+  stats.misses = j[CACHE_MISSES].get<unsigned __int64>();
+  stats.inconsistent = j[CACHE_INCONSISTENT].get<unsigned __int64>();
+  stats.evictions = j[CACHE_EVICTIONS].get<unsigned __int64>();
+  stats.bytes = j[CACHE_BYTES].get<unsigned __int64>();
+  stats.makeTime = j[CACHE_MAKE_TIME].get<unsigned __int64>();
+}
+}  // namespace tradery
+
 class RuntimeStatsImpl : public RuntimeStats,
                          public tradery_x::RuntimeStats {
  private:
@@ -51,6 +80,10 @@ class RuntimeStatsImpl : public RuntimeStats,
 
   double _extraPct;
 
+  // cache usage counters, by type of cached object
+  tradery::CacheStats _seriesCacheStats;
+  tradery::CacheStats _dataCacheStats;
+
  public:
   RuntimeStatsImpl() : _extraPct(0) { setStatus(RuntimeStatus::READY); }
 
@@ -74,6 +107,12 @@ class RuntimeStatsImpl : public RuntimeStats,
     __super::status =
         (tradery_x::RuntimeStatus::type)j[STATUS].get<unsigned int>();
     __super::message = j[MESSAGE].get<std::string>();
+    if (j.contains(SERIES_CACHE)) {
+      _seriesCacheStats = j[SERIES_CACHE].get<tradery::CacheStats>();
+    }
+    if (j.contains(DATA_CACHE)) {
+      _dataCacheStats = j[DATA_CACHE].get<tradery::CacheStats>();
+    }
   }
 
   void setTotalSymbols(unsigned int totalSymbols) {
@@ -170,6 +209,44 @@ class RuntimeStatsImpl : public RuntimeStats,
     __super::message = message;
   }
 
+  /**
+   * Retrieves the current counters from the series and data caches
+   */
+  void updateCacheStats() {
+    tradery::CacheStats seriesCacheStats;
+    tradery::CacheStats dataCacheStats;
+    tradery::getCacheStats(seriesCacheStats, dataCacheStats);
+
+    std::scoped_lock lock(_mutex);
+    _seriesCacheStats = std::move(seriesCacheStats);
+    _dataCacheStats = std::move(dataCacheStats);
+  }
+
+  /**
+   * Formats the cache counters as a table, one line per type of cached object,
+   * in decreasing order of the time spent making the objects
+   */
+  std::string cacheStatsReport() const {
+    std::scoped_lock lock(_mutex);
+    std::ostringstream os;
+    for (const auto& [name, cacheStats] : {std::make_pair("series cache", &_seriesCacheStats), std::make_pair("data cache", &_dataCacheStats)}) {
+      std::vector<tradery::CacheStats::const_iterator> types;
+      for (tradery::CacheStats::const_iterator i = cacheStats->begin(); i != cacheStats->end(); ++i) {
+        types.push_back(i);
+      }
+      std::sort(types.begin(), types.end(), [](const auto& a, const auto& b) { return a->second.makeTime > b->second.makeTime; });
+
+      os << name << ":" << std::endl;
+      for (const auto& i : types) {
+        const tradery::CacheTypeStats& stats = i->second;
+        os << "  " << i->first << " - hits: " << stats.hits << ", misses: " << stats.misses
+           << ", inconsistent: " << stats.inconsistent << ", evictions: " << stats.evictions
+           << ", bytes: " << stats.bytes << ", make time: " << stats.makeTime / 1000.0 << " ms" << std::endl;
+      }
+    }
+    return os.str();
+  }
+
   void to_json(nlohmann::json& j) const {
     j = nlohmann::json{{DURATION, __super::duration},
                        {PROCESSED_SYMBOL_COUNT, __super::processedSymbolCount},
@@ -186,7 +263,9 @@ class RuntimeStatsImpl : public RuntimeStats,
                        {PERCENTAGE_DONE, __super::percentageDone},
                        {CURRENT_SYMBOL, __super::currentSymbol},
                        {STATUS, __super::status},
-                       {MESSAGE, __super::message}};
+                       {MESSAGE, __super::message},
+                       {SERIES_CACHE, _seriesCacheStats},
+                       {DATA_CACHE, _dataCacheStats}};
   }
 
   std::string to_json() const {
@@ -522,7 +522,9 @@ class SessionInfoImpl : public SessionInfo {
     DataInfo di(_defDataSource, SymbolConstPtr(new Symbol(symbol)));
 
     try {
-      return _defDataSource->getData(&di, _range)->getDataCollection();
+      // shared with the runs and the other statistics, so each symbol is only
+      // loaded once per session
+      return tradery::getDataRequester()->getData(&di, _range);
     }
     catch (const exception& e) {
       LOG(log_error, _sessionId.str(), "exception getting data for symbol \"", symbol , "\": " , e.what());
@@ -939,26 +941,14 @@ class TASession : public Running,
   }
 
   // this creates the runnables and their associated commissions, slippage etc
+  // each system gets one instance per thread, all sharing the system's symbols
+  // iterator, so the scheduler can run the same system on as many symbols at a
+  // time as there are threads
   void createRunnables() {
-    size_t threads = _document.getRuntimeParams().getThreads();
-    ThreadAlgorithm ta = _document.getRuntimeParams().getThreadAlgorithm();
+    unsigned long threads = (std::max)(_document.getRuntimeParams().getThreads(), 1ul);
 
-    if (ta.oneSystemInMultipleThreds()) {
-      if (_document.runnablesCount() >= threads) {
-        for (const UniqueId* p = _document.getFirstRunnableId(); p != 0; p = _document.getNextRunnableId()) {
-          createRunnable(p);
-        }
-      }
-      else {
-        const UniqueId* p = 0;
-        for (unsigned long instances = 0; instances < threads; ++instances, p = _document.getNextRunnableId()) {
-          if (p == 0) p = _document.getFirstRunnableId();
-          createRunnable(p);
-        }
-      }
-    }
-    else {
-      for (const UniqueId* p = _document.getFirstRunnableId(); p != 0; p = _document.getNextRunnableId()) {
+    for (const UniqueId* p = _document.getFirstRunnableId(); p != 0; p = _document.getNextRunnableId()) {
+      for (unsigned long instances = 0; instances < threads; ++instances) {
         createRunnable(p);
       }
     }
@@ -1055,6 +1045,9 @@ class TASession : public Running,
       DateTimeRangePtr range = _document.getRuntimeParams().getRange();
       setStatusRunning();
       notifySessionStarted(range);
+      _session.setPrefetch(_document.getRuntimeParams().getPrefetchDepth(), _document.getRuntimeParams().getPrefetchThreads());
+      _session.setSymbolMajor(_document.getRuntimeParams().getSymbolMajor());
+      _session.setRunProfile(_document.getRuntimeParams().getRunProfile());
       _session.run(true, _document.getRuntimeParams().getThreads(), _document.getRuntimeParams().getThreadAlgorithm().processorAffinity(),
           range, _document.getRuntimeParams().startTradesDateTime());
       LOG(log_info, getSessionId().str(), "session ended");
@@ -60,6 +60,7 @@ class InitUninit {
 public:
   InitUninit() {
     tradery::init(getConfig().cacheSize());
+    tradery::enableSeriesCache(getConfig().seriesCache());
   }
 
   ~InitUninit() {